@@ -0,0 +1,182 @@
+#include <random>
+#include <chrono>
+#include "types/world_map.h"
+#include "relocalization/relocalizer.h"
+using namespace proslam;
+
+
+
+//ds exposes the candidate aggregation of the relocalizer (no local maps required)
+class RelocalizerBenchmark: public Relocalizer {
+public:
+
+  RelocalizerBenchmark(RelocalizerParameters* parameters_): Relocalizer(parameters_) {}
+
+  //ds groups the matches and selects the best reference per query landmark: <query identifier, reference identifier, count>
+  void selectCorrespondences(const HBSTTree::MatchVector& matches_, std::vector<std::tuple<Identifier, Identifier, Count>>& selection_) {
+    selection_.clear();
+    _groupMatches(matches_);
+    ++_mask_stamp;
+    for (const Index& index_group: _match_group_order) {
+      Count count_best = 0;
+      const HBSTTree::Match* match_best = _getBestMatch(_match_groups[index_group], count_best);
+      if (match_best && count_best > parameters()->minimum_matches_per_correspondence) {
+        const Identifier& identifier_reference = match_best->object_references[0]->identifier();
+        *_masked_references.insert(identifier_reference, _mask_stamp).first = _mask_stamp;
+        selection_.push_back(std::make_tuple(match_best->object_query->identifier(), identifier_reference, count_best));
+      }
+    }
+  }
+};
+
+//ds previous implementation: ordered map with exception based insertion, multiset counting and ordered mask
+void selectCorrespondencesLegacy(const HBSTTree::MatchVector& matches_,
+                                 const Count& minimum_matches_per_correspondence_,
+                                 std::vector<std::tuple<Identifier, Identifier, Count>>& selection_) {
+  selection_.clear();
+  std::map<const Identifier, std::vector<std::pair<Landmark*, Landmark*>>> multiple_matches_per_landmark;
+  for (const HBSTTree::Match& match: matches_) {
+    if (!match.object_query || !match.object_references[0]) {
+      continue;
+    }
+    bool has_multiple_landmarks = false;
+    for (Landmark* landmark_reference: match.object_references) {
+      if (landmark_reference != match.object_references[0]) {
+        has_multiple_landmarks = true;
+        break;
+      }
+    }
+    if (has_multiple_landmarks) {
+      continue;
+    }
+    try {
+      multiple_matches_per_landmark.at(match.object_query->identifier()).push_back(std::make_pair(match.object_query, match.object_references[0]));
+    } catch(const std::out_of_range& /*exception*/) {
+      multiple_matches_per_landmark.insert(std::make_pair(match.object_query->identifier(),
+                                           std::vector<std::pair<Landmark*, Landmark*>>(1, std::make_pair(match.object_query, match.object_references[0]))));
+    }
+  }
+  std::set<Identifier> mask;
+  for (const std::pair<const Identifier, std::vector<std::pair<Landmark*, Landmark*>>>& multiple_matches: multiple_matches_per_landmark) {
+    std::multiset<Count> counts;
+    const std::pair<Landmark*, Landmark*>* match_best = nullptr;
+    Count count_best = 0;
+    for (const std::pair<Landmark*, Landmark*>& match: multiple_matches.second) {
+      if (0 == mask.count(match.second->identifier())) {
+        counts.insert(match.second->identifier());
+        const Count count_current = counts.count(match.second->identifier());
+        if (count_best < count_current) {
+          count_best = count_current;
+          match_best = &match;
+        }
+      }
+    }
+    if (match_best && count_best > minimum_matches_per_correspondence_) {
+      mask.insert(match_best->second->identifier());
+      selection_.push_back(std::make_tuple(match_best->first->identifier(), match_best->second->identifier(), count_best));
+    }
+  }
+}
+
+inline double getSecondsSince(const std::chrono::time_point<std::chrono::high_resolution_clock>& time_begin_) {
+  return std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-time_begin_).count();
+}
+
+int32_t main(int32_t argc_, char** argv_) {
+
+  //ds configuration: number of matchables per local map (query), descriptors per landmark
+  Count number_of_matchables = 10000;
+  if (argc_ > 1) {
+    number_of_matchables = std::stoul(argv_[1]);
+  }
+  const Count number_of_descriptors_per_landmark = 4;
+  const Count number_of_query_landmarks          = number_of_matchables/number_of_descriptors_per_landmark;
+  const Count number_of_reference_landmarks      = number_of_query_landmarks;
+  const Count number_of_queries                  = 100;
+  std::cerr << BAR << std::endl;
+  std::cerr << "benchmark_closure_candidates|number of matchables per local map: " << number_of_matchables << std::endl;
+  std::cerr << "benchmark_closure_candidates|number of query landmarks: " << number_of_query_landmarks << std::endl;
+
+  //ds set up a minimal world map (no local maps) providing landmarks
+  WorldMapParameters parameters(LoggingLevel::Info);
+  WorldMap world_map(&parameters);
+  CameraMatrix camera_matrix(CameraMatrix::Identity());
+  camera_matrix << 500, 0, 320, 0, 500, 240, 0, 0, 1;
+  Camera camera(480, 640, camera_matrix);
+  const cv::Mat descriptor(1, DESCRIPTOR_SIZE_BYTES, CV_8UC1, cv::Scalar(0));
+  const cv::KeyPoint keypoint(320, 240, 7);
+  std::vector<Landmark*> landmarks(0);
+  landmarks.reserve(number_of_query_landmarks+number_of_reference_landmarks);
+  Frame* frame = 0;
+  for (Index index = 0; index < number_of_query_landmarks+number_of_reference_landmarks; ++index) {
+    if (index%500 == 0) {
+      frame = world_map.createFrame(TransformMatrix3D::Identity());
+      frame->setCameraLeft(&camera);
+    }
+    FramePoint* framepoint = frame->createFramepoint(keypoint, descriptor, keypoint, descriptor, PointCoordinates(0, 0, 1));
+    landmarks.push_back(world_map.createLandmark(framepoint));
+  }
+
+  //ds synthetic matches of a query local map against a reference: each query descriptor matches a nearby reference landmark
+  //ds with a dominant candidate, occasional ambiguous matches (different landmarks at the same distance) and culled landmarks
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<Index> distribution_offset(0, 3);
+  std::uniform_real_distribution<real> distribution_event(0, 1);
+  std::vector<HBSTTree::MatchVector> matches_per_query(number_of_queries);
+  for (HBSTTree::MatchVector& matches: matches_per_query) {
+    matches.resize(number_of_matchables);
+    for (Index index = 0; index < number_of_matchables; ++index) {
+      const Index index_query = generator()%number_of_query_landmarks;
+      const Index offset      = (distribution_event(generator) < 0.6)? 0: distribution_offset(generator);
+      HBSTTree::Match& match  = matches[index];
+      match.object_query      = landmarks[index_query];
+      match.object_references = std::vector<Landmark*>(1, landmarks[number_of_query_landmarks+(index_query+offset)%number_of_reference_landmarks]);
+      match.distance          = 10;
+      const real event = distribution_event(generator);
+      if (event < 0.05) {
+        match.object_references.push_back(landmarks[number_of_query_landmarks+(index_query+1)%number_of_reference_landmarks]);
+      } else if (event < 0.07) {
+        match.object_references[0] = nullptr;
+      }
+    }
+  }
+
+  //ds flat aggregation (buffers are reused between queries)
+  RelocalizerParameters relocalizer_parameters(LoggingLevel::Info);
+  RelocalizerBenchmark relocalizer(&relocalizer_parameters);
+  std::vector<std::tuple<Identifier, Identifier, Count>> selection;
+  std::vector<std::tuple<Identifier, Identifier, Count>> selection_legacy;
+  Count number_of_correspondences = 0;
+  std::chrono::time_point<std::chrono::high_resolution_clock> time_begin = std::chrono::high_resolution_clock::now();
+  for (const HBSTTree::MatchVector& matches: matches_per_query) {
+    relocalizer.selectCorrespondences(matches, selection);
+    number_of_correspondences += selection.size();
+  }
+  const double duration_flat = getSecondsSince(time_begin);
+
+  //ds legacy aggregation
+  Count number_of_correspondences_legacy = 0;
+  time_begin = std::chrono::high_resolution_clock::now();
+  for (const HBSTTree::MatchVector& matches: matches_per_query) {
+    selectCorrespondencesLegacy(matches, relocalizer_parameters.minimum_matches_per_correspondence, selection_legacy);
+    number_of_correspondences_legacy += selection_legacy.size();
+  }
+  const double duration_legacy = getSecondsSince(time_begin);
+
+  //ds both implementations must select identical correspondences
+  Count number_of_mismatches = 0;
+  for (const HBSTTree::MatchVector& matches: matches_per_query) {
+    relocalizer.selectCorrespondences(matches, selection);
+    selectCorrespondencesLegacy(matches, relocalizer_parameters.minimum_matches_per_correspondence, selection_legacy);
+    if (selection != selection_legacy) {
+      ++number_of_mismatches;
+    }
+  }
+  std::cerr << "benchmark_closure_candidates|queries: " << number_of_queries
+            << " correspondences flat/legacy: " << number_of_correspondences << "/" << number_of_correspondences_legacy
+            << " mismatching queries: " << number_of_mismatches << std::endl;
+  std::cerr << "benchmark_closure_candidates|duration per query flat/legacy (ms): " << 1000*duration_flat/number_of_queries
+            << "/" << 1000*duration_legacy/number_of_queries << " speedup: " << duration_legacy/duration_flat << std::endl;
+  std::cerr << BAR << std::endl;
+  return 0;
+}
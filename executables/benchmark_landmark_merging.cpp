@@ -0,0 +1,213 @@
+#include <random>
+#include <chrono>
+#include "types/world_map.h"
+using namespace proslam;
+
+
+
+inline double getSecondsSince(const std::chrono::time_point<std::chrono::high_resolution_clock>& time_begin_) {
+  return std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-time_begin_).count();
+}
+
+//ds synthetic landmarks with a single measurement each, created in frames of fixed size
+std::vector<Landmark*> createLandmarks(WorldMap& world_map_, Camera& camera_, const Count& number_of_landmarks_) {
+  const Count number_of_landmarks_per_frame = 500;
+  std::mt19937 generator(0);
+  std::uniform_real_distribution<real> distribution_coordinates(-10, 10);
+  const cv::Mat descriptor(1, DESCRIPTOR_SIZE_BYTES, CV_8UC1, cv::Scalar(0));
+  const cv::KeyPoint keypoint(320, 240, 7);
+  std::vector<Landmark*> landmarks(0);
+  landmarks.reserve(number_of_landmarks_);
+  Frame* frame = 0;
+  for (Index index = 0; index < number_of_landmarks_; ++index) {
+    if (index%number_of_landmarks_per_frame == 0) {
+      frame = world_map_.createFrame(TransformMatrix3D::Identity());
+      frame->setCameraLeft(&camera_);
+    }
+    const PointCoordinates coordinates(distribution_coordinates(generator),
+                                       distribution_coordinates(generator),
+                                       1+std::fabs(distribution_coordinates(generator)));
+    FramePoint* framepoint = frame->createFramepoint(keypoint, descriptor, keypoint, descriptor, coordinates);
+    Landmark* landmark     = world_map_.createLandmark(framepoint);
+    landmark->update(framepoint);
+    landmarks.push_back(landmark);
+  }
+  return landmarks;
+}
+
+//ds synthetic closures: direct pairs, conflicting candidates and merge chains over multiple closures
+LocalMap::ClosureConstraintVector createClosures(const std::vector<Landmark*>& landmarks_, const Count& number_of_pairs_) {
+  std::mt19937 generator(1);
+  std::uniform_int_distribution<Count> distribution_count(1, 100);
+  std::uniform_int_distribution<Index> distribution_landmark(0, landmarks_.size()-1);
+  Closure::CorrespondencePointerVector correspondences_direct;
+  Closure::CorrespondencePointerVector correspondences_chained;
+  for (Index index = 0; index < number_of_pairs_; ++index) {
+
+    //ds direct pair: 2i+1 into 2i
+    correspondences_direct.push_back(new Closure::Correspondence(landmarks_[2*index+1], landmarks_[2*index], distribution_count(generator), 1, PointCoordinates::Zero(), PointCoordinates::Zero()));
+
+    //ds conflicting candidate for the same query
+    if (index%4 == 0) {
+      correspondences_direct.push_back(new Closure::Correspondence(landmarks_[2*index+1], landmarks_[distribution_landmark(generator)], distribution_count(generator), 1, PointCoordinates::Zero(), PointCoordinates::Zero()));
+    }
+
+    //ds chain: 2i+2 into 2i+1 (which is itself merged into 2i)
+    correspondences_chained.push_back(new Closure::Correspondence(landmarks_[2*index+2], landmarks_[2*index+1], distribution_count(generator), 1, PointCoordinates::Zero(), PointCoordinates::Zero()));
+  }
+  for (Closure::Correspondence* correspondence: correspondences_direct) {correspondence->is_inlier = true;}
+  for (Closure::Correspondence* correspondence: correspondences_chained) {correspondence->is_inlier = true;}
+  LocalMap::ClosureConstraintVector closures;
+  closures.push_back(LocalMap::ClosureConstraint(0, TransformMatrix3D::Identity(), correspondences_direct));
+  closures.push_back(LocalMap::ClosureConstraint(0, TransformMatrix3D::Identity(), correspondences_chained));
+  return closures;
+}
+
+//ds baseline: previous WorldMap::mergeLandmarks bookkeeping (ordered maps, scan of all tracked landmarks per merge)
+//ds the shared local map check is omitted (the synthetic landmarks are not part of any local map), absorbed landmarks are freed by the world map
+Count mergeLandmarksBaseline(const LocalMap::ClosureConstraintVector& closures_,
+                             std::map<Identifier, Landmark*>& landmarks_,
+                             LandmarkPointerVector& tracked_landmarks_) {
+  std::map<Identifier, std::pair<Identifier, Count>> landmark_queries_to_references_filtered;
+  std::map<Identifier, std::pair<Identifier, Count>> landmark_references_to_queries_filtered;
+  for (const LocalMap::ClosureConstraint& closure: closures_) {
+    for (const Closure::Correspondence* correspondence: closure.landmark_correspondences) {
+      Identifier identifier_query     = correspondence->identifier_query;
+      Identifier identifier_reference = correspondence->identifier_reference;
+      if (identifier_query < identifier_reference) {
+        std::swap(identifier_query, identifier_reference);
+      }
+      if (correspondence->is_inlier && identifier_query != identifier_reference) {
+        const Count& matching_count = correspondence->matching_count;
+        const std::pair<Identifier, Count> candidate_query(identifier_query, matching_count);
+        const std::pair<Identifier, Count> candidate_reference(identifier_reference, matching_count);
+        std::map<Identifier, std::pair<Identifier, Count>>::iterator iterator_query     = landmark_queries_to_references_filtered.find(identifier_query);
+        std::map<Identifier, std::pair<Identifier, Count>>::iterator iterator_reference = landmark_references_to_queries_filtered.find(identifier_reference);
+        if (iterator_query == landmark_queries_to_references_filtered.end() &&
+            iterator_reference == landmark_references_to_queries_filtered.end()) {
+          landmark_queries_to_references_filtered.insert(std::make_pair(identifier_query, candidate_reference));
+          landmark_references_to_queries_filtered.insert(std::make_pair(identifier_reference, candidate_query));
+        } else if (iterator_query != landmark_queries_to_references_filtered.end() &&
+                   iterator_reference == landmark_references_to_queries_filtered.end()) {
+          if (matching_count > iterator_query->second.second) {
+            landmark_references_to_queries_filtered.erase(iterator_query->second.first);
+            iterator_query->second = candidate_reference;
+            landmark_references_to_queries_filtered.insert(std::make_pair(identifier_reference, candidate_query));
+          }
+        } else if (iterator_query == landmark_queries_to_references_filtered.end() &&
+                   iterator_reference != landmark_references_to_queries_filtered.end()) {
+          if (matching_count > iterator_reference->second.second) {
+            landmark_queries_to_references_filtered.erase(iterator_reference->second.first);
+            iterator_reference->second = candidate_query;
+            landmark_queries_to_references_filtered.insert(std::make_pair(identifier_query, candidate_reference));
+          }
+        }
+      }
+    }
+  }
+
+  //ds merge in increasing query order, following merge chains through an ordered map
+  std::map<Identifier, Identifier> merged_landmark_identifiers;
+  Count number_of_merged_landmarks = 0;
+  for (const std::pair<const Identifier, std::pair<Identifier, Count>>& pair: landmark_queries_to_references_filtered) {
+    std::map<Identifier, Landmark*>::iterator iterator_query = landmarks_.find(pair.first);
+    if (iterator_query == landmarks_.end()) {
+      continue;
+    }
+    Identifier identifier_reference = pair.second.first;
+    std::map<Identifier, Identifier>::const_iterator iterator_merged = merged_landmark_identifiers.find(identifier_reference);
+    while (iterator_merged != merged_landmark_identifiers.end()) {
+      identifier_reference = iterator_merged->second;
+      iterator_merged      = merged_landmark_identifiers.find(identifier_reference);
+    }
+    std::map<Identifier, Landmark*>::iterator iterator_reference = landmarks_.find(identifier_reference);
+    if (iterator_reference == landmarks_.end() || iterator_query == iterator_reference) {
+      continue;
+    }
+    Landmark* landmark_query     = iterator_query->second;
+    Landmark* landmark_reference = iterator_reference->second;
+    for (Index index = 0; index < tracked_landmarks_.size(); ++index) {
+      if (tracked_landmarks_[index] == landmark_query || tracked_landmarks_[index] == landmark_reference) {
+        tracked_landmarks_[index] = landmark_reference;
+      }
+    }
+    landmark_reference->merge(landmark_query);
+    merged_landmark_identifiers.insert(std::make_pair(landmark_query->identifier(), landmark_reference->identifier()));
+    landmarks_.erase(iterator_query);
+    ++number_of_merged_landmarks;
+  }
+  return number_of_merged_landmarks;
+}
+
+int32_t main(int32_t argc_, char** argv_) {
+
+  //ds configuration: number of synthetic landmark merge candidates and currently tracked landmarks (spread over all landmarks)
+  Count number_of_pairs = 10000;
+  if (argc_ > 1) {
+    number_of_pairs = std::stoul(argv_[1]);
+  }
+  const Count number_of_landmarks         = 2*number_of_pairs+1;
+  const Count number_of_tracked_landmarks = std::min(number_of_landmarks, static_cast<Count>(1000));
+  std::cerr << BAR << std::endl;
+  std::cerr << "benchmark_landmark_merging|number of correspondence pairs: " << number_of_pairs << std::endl;
+  std::cerr << "benchmark_landmark_merging|number of landmarks: " << number_of_landmarks << " tracked: " << number_of_tracked_landmarks << std::endl;
+
+  //ds set up two identical minimal world maps (no local maps)
+  WorldMapParameters parameters(LoggingLevel::Info);
+  CameraMatrix camera_matrix(CameraMatrix::Identity());
+  camera_matrix << 500, 0, 320, 0, 500, 240, 0, 0, 1;
+  Camera camera(480, 640, camera_matrix);
+  WorldMap world_map_baseline(&parameters);
+  WorldMap world_map(&parameters);
+  const std::vector<Landmark*> landmarks_baseline = createLandmarks(world_map_baseline, camera, number_of_landmarks);
+  const std::vector<Landmark*> landmarks          = createLandmarks(world_map, camera, number_of_landmarks);
+  const LocalMap::ClosureConstraintVector closures_baseline = createClosures(landmarks_baseline, number_of_pairs);
+  const LocalMap::ClosureConstraintVector closures          = createClosures(landmarks, number_of_pairs);
+  LandmarkPointerVector tracked_landmarks_baseline(number_of_tracked_landmarks);
+  for (Index index = 0; index < number_of_tracked_landmarks; ++index) {
+    const Index index_landmark = index*number_of_landmarks/number_of_tracked_landmarks;
+    tracked_landmarks_baseline[index] = landmarks_baseline[index_landmark];
+    world_map.currentlyTrackedLandmarks().push_back(landmarks[index_landmark]);
+  }
+  std::cerr << "benchmark_landmark_merging|number of correspondences: "
+            << closures[0].landmark_correspondences.size()+closures[1].landmark_correspondences.size() << std::endl;
+
+  //ds benchmark baseline merging
+  std::map<Identifier, Landmark*> landmarks_alive_baseline;
+  for (Landmark* landmark: landmarks_baseline) {
+    landmarks_alive_baseline.insert(std::make_pair(landmark->identifier(), landmark));
+  }
+  std::chrono::time_point<std::chrono::high_resolution_clock> time_begin = std::chrono::high_resolution_clock::now();
+  const Count number_of_merged_landmarks_baseline = mergeLandmarksBaseline(closures_baseline, landmarks_alive_baseline, tracked_landmarks_baseline);
+  const double duration_seconds_baseline = getSecondsSince(time_begin);
+
+  //ds benchmark merging
+  time_begin = std::chrono::high_resolution_clock::now();
+  world_map.mergeLandmarks(closures);
+  const double duration_seconds = getSecondsSince(time_begin);
+
+  //ds both implementations have to route the tracked landmarks identically
+  Count number_of_tracked_mismatches = 0;
+  for (Index index = 0; index < number_of_tracked_landmarks; ++index) {
+    if (tracked_landmarks_baseline[index]->identifier()-landmarks_baseline.front()->identifier() !=
+        world_map.currentlyTrackedLandmarks()[index]->identifier()-landmarks.front()->identifier()) {
+      ++number_of_tracked_mismatches;
+    }
+  }
+  std::cerr << "benchmark_landmark_merging|BASELINE merged landmarks: " << number_of_merged_landmarks_baseline
+            << " remaining landmarks: " << landmarks_alive_baseline.size() << " duration (s): " << duration_seconds_baseline << std::endl;
+  std::cerr << "benchmark_landmark_merging|HASHED   merged landmarks: " << world_map.numberOfMergedLandmarks()
+            << " remaining landmarks: " << world_map.landmarks().size() << " duration (s): " << duration_seconds << std::endl;
+  std::cerr << "benchmark_landmark_merging|tracked landmark mismatches: " << number_of_tracked_mismatches << std::endl;
+  std::cerr << "benchmark_landmark_merging|speedup: " << duration_seconds_baseline/duration_seconds << std::endl;
+  std::cerr << BAR << std::endl;
+
+  //ds clean up
+  for (const LocalMap::ClosureConstraint& closure: closures_baseline) {
+    for (const Closure::Correspondence* correspondence: closure.landmark_correspondences) {delete correspondence;}
+  }
+  for (const LocalMap::ClosureConstraint& closure: closures) {
+    for (const Closure::Correspondence* correspondence: closure.landmark_correspondences) {delete correspondence;}
+  }
+  return 0;
+}
@@ -0,0 +1,149 @@
+#include <random>
+#include <chrono>
+#include "types/voxel_hash.h"
+using namespace proslam;
+
+
+
+//ds lightweight landmark stand-in (identifier and world coordinates only)
+struct Point {
+  Point(const Identifier& identifier_, const PointCoordinates& coordinates_): _identifier(identifier_), _coordinates(coordinates_) {}
+  inline const Identifier& identifier() const {return _identifier;}
+  inline const PointCoordinates& coordinates() const {return _coordinates;}
+  Identifier _identifier;
+  PointCoordinates _coordinates;
+};
+
+typedef VoxelHash<Point> PointVoxelHash;
+
+inline double getSecondsSince(const std::chrono::time_point<std::chrono::high_resolution_clock>& time_begin_) {
+  return std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-time_begin_).count();
+}
+
+int32_t main(int32_t argc_, char** argv_) {
+
+  //ds configuration: number of synthetic landmarks along a 1km trajectory, voxel size
+  std::vector<Count> numbers_of_points = {100000, 1000000};
+  real voxel_size_meters = 4.0;
+  if (argc_ > 1) {
+    numbers_of_points = {std::stoul(argv_[1])};
+  }
+  if (argc_ > 2) {
+    voxel_size_meters = std::stod(argv_[2]);
+  }
+  const Count number_of_queries = 100;
+  const real trajectory_length_meters = 1000;
+  const real radius_meters = 10;
+  const real minimum_depth_meters = 0.1;
+  const real maximum_depth_meters = 50;
+  CameraMatrix camera_matrix(CameraMatrix::Identity());
+  camera_matrix << 500, 0, 320, 0, 500, 240, 0, 0, 1;
+  const Count number_of_image_rows = 480;
+  const Count number_of_image_cols = 640;
+
+  for (const Count& number_of_points: numbers_of_points) {
+    std::cerr << BAR << std::endl;
+    std::cerr << "benchmark_landmark_voxel_hash|number of points: " << number_of_points << " voxel size (m): " << voxel_size_meters << std::endl;
+
+    //ds sample points in a corridor along the trajectory (x forward)
+    std::mt19937 generator(0);
+    std::uniform_real_distribution<real> distribution_along(0, trajectory_length_meters);
+    std::uniform_real_distribution<real> distribution_across(-30, 30);
+    std::uniform_real_distribution<real> distribution_height(-2, 10);
+    std::vector<Point> points;
+    points.reserve(number_of_points);
+    for (Identifier identifier = 0; identifier < number_of_points; ++identifier) {
+      points.push_back(Point(identifier, PointCoordinates(distribution_along(generator), distribution_across(generator), distribution_height(generator))));
+    }
+
+    //ds build the hash
+    std::chrono::time_point<std::chrono::high_resolution_clock> time_begin = std::chrono::high_resolution_clock::now();
+    PointVoxelHash voxel_hash(voxel_size_meters);
+    for (Point& point: points) {
+      voxel_hash.insert(&point);
+    }
+    std::cerr << "benchmark_landmark_voxel_hash|insertion (s): " << getSecondsSince(time_begin)
+              << " voxels: " << voxel_hash.numberOfVoxels() << std::endl;
+
+    //ds incremental updates: move a tenth of the points slightly
+    std::normal_distribution<real> distribution_noise(0, 0.1);
+    time_begin = std::chrono::high_resolution_clock::now();
+    for (Index index = 0; index < points.size(); index += 10) {
+      points[index]._coordinates += PointCoordinates(distribution_noise(generator), distribution_noise(generator), distribution_noise(generator));
+      voxel_hash.update(&points[index]);
+    }
+    std::cerr << "benchmark_landmark_voxel_hash|updates (s): " << getSecondsSince(time_begin) << std::endl;
+
+    //ds query poses along the trajectory: camera looking forward (z along world x)
+    std::vector<TransformMatrix3D, Eigen::aligned_allocator<TransformMatrix3D>> world_to_cameras(number_of_queries);
+    Matrix3 camera_to_world_rotation;
+    camera_to_world_rotation << 0, 0, 1, -1, 0, 0, 0, -1, 0;
+    for (Index index = 0; index < number_of_queries; ++index) {
+      TransformMatrix3D camera_to_world(TransformMatrix3D::Identity());
+      camera_to_world.linear()      = camera_to_world_rotation;
+      camera_to_world.translation() = PointCoordinates(distribution_along(generator), 0, 1.5);
+      world_to_cameras[index] = camera_to_world.inverse();
+    }
+
+    //ds radius queries
+    PointVoxelHash::ObjectPointerVector objects;
+    Count number_of_results_hash = 0;
+    time_begin = std::chrono::high_resolution_clock::now();
+    for (const TransformMatrix3D& world_to_camera: world_to_cameras) {
+      voxel_hash.getObjectsInRadius(world_to_camera.inverse().translation(), radius_meters, objects);
+      number_of_results_hash += objects.size();
+    }
+    const double duration_radius_hash = getSecondsSince(time_begin);
+    Count number_of_results_scan = 0;
+    time_begin = std::chrono::high_resolution_clock::now();
+    for (const TransformMatrix3D& world_to_camera: world_to_cameras) {
+      const PointCoordinates center = world_to_camera.inverse().translation();
+      objects.clear();
+      for (Point& point: points) {
+        if ((point.coordinates()-center).squaredNorm() <= radius_meters*radius_meters) {
+          objects.push_back(&point);
+        }
+      }
+      number_of_results_scan += objects.size();
+    }
+    const double duration_radius_scan = getSecondsSince(time_begin);
+    std::cerr << "benchmark_landmark_voxel_hash|radius queries: " << number_of_queries
+              << " results hash/scan: " << number_of_results_hash << "/" << number_of_results_scan
+              << " duration hash/scan (s): " << duration_radius_hash << "/" << duration_radius_scan
+              << " speedup: " << duration_radius_scan/duration_radius_hash << std::endl;
+
+    //ds frustum queries
+    number_of_results_hash = 0;
+    time_begin = std::chrono::high_resolution_clock::now();
+    for (const TransformMatrix3D& world_to_camera: world_to_cameras) {
+      voxel_hash.getObjectsInFrustum(world_to_camera, camera_matrix, number_of_image_rows, number_of_image_cols,
+                                     minimum_depth_meters, maximum_depth_meters, objects);
+      number_of_results_hash += objects.size();
+    }
+    const double duration_frustum_hash = getSecondsSince(time_begin);
+    number_of_results_scan = 0;
+    time_begin = std::chrono::high_resolution_clock::now();
+    for (const TransformMatrix3D& world_to_camera: world_to_cameras) {
+      objects.clear();
+      for (Point& point: points) {
+        const PointCoordinates point_in_camera = world_to_camera*point.coordinates();
+        if (point_in_camera.z() < minimum_depth_meters || point_in_camera.z() > maximum_depth_meters) {
+          continue;
+        }
+        const PointCoordinates point_in_image = camera_matrix*point_in_camera/point_in_camera.z();
+        if (point_in_image.x() >= 0 && point_in_image.x() <= number_of_image_cols &&
+            point_in_image.y() >= 0 && point_in_image.y() <= number_of_image_rows) {
+          objects.push_back(&point);
+        }
+      }
+      number_of_results_scan += objects.size();
+    }
+    const double duration_frustum_scan = getSecondsSince(time_begin);
+    std::cerr << "benchmark_landmark_voxel_hash|frustum queries: " << number_of_queries
+              << " results hash/scan: " << number_of_results_hash << "/" << number_of_results_scan
+              << " duration hash/scan (s): " << duration_frustum_hash << "/" << duration_frustum_scan
+              << " speedup: " << duration_frustum_scan/duration_frustum_hash << std::endl;
+  }
+  std::cerr << BAR << std::endl;
+  return 0;
+}
@@ -0,0 +1,191 @@
+#include <random>
+#include <set>
+#include <chrono>
+#include "relocalization/hbst_place_database.h"
+#include "relocalization/brute_force_place_database.h"
+#include "relocalization/bag_of_words_place_database.h"
+#include "types/landmark.h"
+using namespace proslam;
+
+
+
+typedef std::vector<uint8_t> DescriptorBytes;
+
+inline double getSecondsSince(const std::chrono::time_point<std::chrono::high_resolution_clock>& time_begin_) {
+  return std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-time_begin_).count();
+}
+
+int32_t main(int32_t argc_, char** argv_) {
+
+  //ds configuration: number of places (the second half revisits the first half), descriptors per place, bit noise per observation
+  Count number_of_places = 200;
+  if (argc_ > 1) {
+    number_of_places = std::stoul(argv_[1]);
+  }
+  const Count number_of_descriptors_per_place = 500;
+  const Count number_of_flipped_bits          = 10;
+  const Count number_of_landmarks             = number_of_places/2*number_of_descriptors_per_place;
+  std::cerr << BAR << std::endl;
+  std::cerr << "benchmark_place_databases|places: " << number_of_places << " descriptors per place: " << number_of_descriptors_per_place
+            << " flipped bits per observation: " << number_of_flipped_bits << std::endl;
+
+  //ds synthetic landmark appearances
+  std::mt19937 generator(0);
+  std::uniform_int_distribution<uint32_t> distribution_byte(0, 255);
+  std::uniform_int_distribution<uint32_t> distribution_bit(0, SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS-1);
+  std::vector<DescriptorBytes> landmarks(number_of_landmarks, DescriptorBytes(DESCRIPTOR_SIZE_BYTES));
+  for (DescriptorBytes& landmark: landmarks) {
+    for (uint8_t& byte: landmark) {
+      byte = distribution_byte(generator);
+    }
+  }
+
+  //ds noisy observations for each place: place p and p+number_of_places/2 observe the same landmarks
+  std::vector<std::vector<cv::Mat>> descriptors_per_place(number_of_places);
+  for (Index index_place = 0; index_place < number_of_places; ++index_place) {
+    const Index index_landmark_begin = (index_place%(number_of_places/2))*number_of_descriptors_per_place;
+    for (Index index_landmark = index_landmark_begin; index_landmark < index_landmark_begin+number_of_descriptors_per_place; ++index_landmark) {
+      cv::Mat descriptor(1, DESCRIPTOR_SIZE_BYTES, CV_8UC1, cv::Scalar(0));
+      uint8_t* bytes = descriptor.ptr<uint8_t>(0);
+      std::copy(landmarks[index_landmark].begin(), landmarks[index_landmark].end(), bytes);
+      for (Count u = 0; u < number_of_flipped_bits; ++u) {
+        const uint32_t bit = distribution_bit(generator);
+        bytes[bit/8] ^= (1 << (bit%8));
+      }
+      descriptors_per_place[index_place].push_back(descriptor);
+    }
+  }
+
+  //ds evaluate all backends with identical input
+  RelocalizerParameters parameters(LoggingLevel::Info);
+  const std::vector<std::string> place_database_types = {"HBST", "BRUTE_FORCE", "BAG_OF_WORDS"};
+  for (const std::string& place_database_type: place_database_types) {
+    BasePlaceDatabasePtr place_database;
+    if (place_database_type == "HBST") {
+      place_database = BasePlaceDatabasePtr(new HBSTPlaceDatabase(&parameters));
+    } else if (place_database_type == "BRUTE_FORCE") {
+      place_database = BasePlaceDatabasePtr(new BruteForcePlaceDatabase(&parameters));
+    } else {
+      place_database = BasePlaceDatabasePtr(new BagOfWordsPlaceDatabase(&parameters));
+    }
+
+    //ds landmark index of each matchable (ground truth)
+    std::map<const HBSTMatchable*, Index> landmark_per_matchable;
+    Count number_of_queries = 0;
+    Count number_of_correct_matches = 0;
+    double duration_seconds = 0;
+    for (Index index_place = 0; index_place < number_of_places; ++index_place) {
+      const Index index_landmark_begin = (index_place%(number_of_places/2))*number_of_descriptors_per_place;
+      HBSTTree::MatchableVector matchables(number_of_descriptors_per_place);
+      for (Index u = 0; u < number_of_descriptors_per_place; ++u) {
+        matchables[u] = new HBSTMatchable(nullptr, descriptors_per_place[index_place][u], index_place);
+        landmark_per_matchable[matchables[u]] = index_landmark_begin+u;
+      }
+
+      //ds add and query as the relocalizer does
+      HBSTTree::MatchVectorMap matches_per_place;
+      const std::chrono::time_point<std::chrono::high_resolution_clock> time_begin = std::chrono::high_resolution_clock::now();
+      place_database->matchAndAdd(matchables, matches_per_place, parameters.maximum_descriptor_distance);
+      duration_seconds += getSecondsSince(time_begin);
+
+      //ds recall: matches of revisiting places to the same landmark in the originally visited place
+      if (index_place >= number_of_places/2) {
+        number_of_queries += number_of_descriptors_per_place;
+        for (const HBSTTree::Match& match: matches_per_place[index_place-number_of_places/2]) {
+          if (landmark_per_matchable.at(match.matchable_query) == landmark_per_matchable.at(match.matchable_references[0])) {
+            ++number_of_correct_matches;
+          }
+        }
+      }
+    }
+    std::cerr << "benchmark_place_databases|" << place_database_type
+              << " places: " << place_database->numberOfPlaces()
+              << " duration per place (ms): " << 1000*duration_seconds/number_of_places
+              << " recall: " << static_cast<real>(number_of_correct_matches)/number_of_queries;
+    BagOfWordsPlaceDatabase* bag_of_words_place_database = dynamic_cast<BagOfWordsPlaceDatabase*>(place_database.get());
+    if (bag_of_words_place_database) {
+      std::cerr << " words: " << bag_of_words_place_database->numberOfWords();
+    }
+    std::cerr << std::endl;
+    place_database->clear(true);
+  }
+
+  //ds landmark appearance modes (HBST): each landmark is observed several times per place, a place adds either all observations
+  //ds or a single representative descriptor per landmark (as LocalMap does for landmark_appearance_mode)
+  const Count number_of_observations_per_landmark = 5;
+  const Count number_of_landmarks_per_place       = number_of_descriptors_per_place/number_of_observations_per_landmark;
+  std::cerr << "benchmark_place_databases|appearance modes - landmarks per place: " << number_of_landmarks_per_place
+            << " observations per landmark: " << number_of_observations_per_landmark << std::endl;
+  std::vector<std::vector<std::vector<cv::Mat>>> observations_per_place(number_of_places);
+  for (Index index_place = 0; index_place < number_of_places; ++index_place) {
+    const Index index_landmark_begin = (index_place%(number_of_places/2))*number_of_landmarks_per_place;
+    observations_per_place[index_place].resize(number_of_landmarks_per_place);
+    for (Index u = 0; u < number_of_landmarks_per_place; ++u) {
+      for (Count v = 0; v < number_of_observations_per_landmark; ++v) {
+        cv::Mat descriptor(1, DESCRIPTOR_SIZE_BYTES, CV_8UC1, cv::Scalar(0));
+        uint8_t* bytes = descriptor.ptr<uint8_t>(0);
+        std::copy(landmarks[index_landmark_begin+u].begin(), landmarks[index_landmark_begin+u].end(), bytes);
+        for (Count w = 0; w < number_of_flipped_bits; ++w) {
+          const uint32_t bit = distribution_bit(generator);
+          bytes[bit/8] ^= (1 << (bit%8));
+        }
+        observations_per_place[index_place][u].push_back(descriptor);
+      }
+    }
+  }
+  const std::vector<std::string> appearance_modes = {"ALL", "MAJORITY", "MEDOID"};
+  for (const std::string& appearance_mode: appearance_modes) {
+    HBSTPlaceDatabase place_database(&parameters);
+
+    //ds landmark index of each matchable (ground truth)
+    std::map<const HBSTMatchable*, Index> landmark_per_matchable;
+    Count number_of_matchables = 0;
+    Count number_of_queries = 0;
+    Count number_of_recalled_landmarks = 0;
+    double duration_seconds = 0;
+    for (Index index_place = 0; index_place < number_of_places; ++index_place) {
+      const Index index_landmark_begin = (index_place%(number_of_places/2))*number_of_landmarks_per_place;
+      HBSTTree::MatchableVector matchables;
+      for (Index u = 0; u < number_of_landmarks_per_place; ++u) {
+        const std::vector<cv::Mat>& observations = observations_per_place[index_place][u];
+        if (appearance_mode == "ALL") {
+          for (const cv::Mat& descriptor: observations) {
+            matchables.push_back(new HBSTMatchable(nullptr, descriptor, index_place));
+            landmark_per_matchable[matchables.back()] = index_landmark_begin+u;
+          }
+        } else {
+          matchables.push_back(new HBSTMatchable(nullptr, appearance_mode == "MAJORITY"? Landmark::majorityDescriptor(observations):
+                                                                                          Landmark::medoidDescriptor(observations), index_place));
+          landmark_per_matchable[matchables.back()] = index_landmark_begin+u;
+        }
+      }
+      number_of_matchables += matchables.size();
+
+      //ds add and query as the relocalizer does
+      HBSTTree::MatchVectorMap matches_per_place;
+      const std::chrono::time_point<std::chrono::high_resolution_clock> time_begin = std::chrono::high_resolution_clock::now();
+      place_database.matchAndAdd(matchables, matches_per_place, parameters.maximum_descriptor_distance);
+      duration_seconds += getSecondsSince(time_begin);
+
+      //ds recall: revisited landmarks with at least one match to the same landmark in the originally visited place
+      if (index_place >= number_of_places/2) {
+        number_of_queries += number_of_landmarks_per_place;
+        std::set<Index> recalled_landmarks;
+        for (const HBSTTree::Match& match: matches_per_place[index_place-number_of_places/2]) {
+          const Index index_landmark = landmark_per_matchable.at(match.matchable_query);
+          if (index_landmark == landmark_per_matchable.at(match.matchable_references[0])) {
+            recalled_landmarks.insert(index_landmark);
+          }
+        }
+        number_of_recalled_landmarks += recalled_landmarks.size();
+      }
+    }
+    std::cerr << "benchmark_place_databases|HBST " << appearance_mode
+              << " descriptors: " << number_of_matchables
+              << " duration per place (ms): " << 1000*duration_seconds/number_of_places
+              << " landmark recall: " << static_cast<real>(number_of_recalled_landmarks)/number_of_queries << std::endl;
+    place_database.clear(true);
+  }
+  std::cerr << BAR << std::endl;
+  return 0;
+}
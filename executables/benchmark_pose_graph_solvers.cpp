@@ -0,0 +1,185 @@
+#include <random>
+#include <chrono>
+#include "map_optimization/graph_optimizer.h"
+#include "g2o/core/robust_kernel_impl.h"
+using namespace proslam;
+
+
+
+typedef std::vector<TransformMatrix3D, Eigen::aligned_allocator<TransformMatrix3D>> PoseVector;
+
+inline double getSecondsSince(const std::chrono::time_point<std::chrono::high_resolution_clock>& time_begin_) {
+  return std::chrono::duration<double>(std::chrono::high_resolution_clock::now()-time_begin_).count();
+}
+
+inline TransformMatrix3D getNoise(std::mt19937& generator_, const real& sigma_translation_, const real& sigma_rotation_) {
+  std::normal_distribution<real> distribution(0, 1);
+  const Vector3 rotation_vector(sigma_rotation_*distribution(generator_), sigma_rotation_*distribution(generator_), sigma_rotation_*distribution(generator_));
+  TransformMatrix3D noise(TransformMatrix3D::Identity());
+  if (rotation_vector.norm() > 0) {
+    noise.linear() = Eigen::AngleAxis<real>(rotation_vector.norm(), rotation_vector.normalized()).toRotationMatrix();
+  }
+  noise.translation() = Vector3(sigma_translation_*distribution(generator_), sigma_translation_*distribution(generator_), sigma_translation_*distribution(generator_));
+  return noise;
+}
+
+//ds mean translational error of the estimates
+template<typename PoseGetter_>
+real getMeanTranslationError(const PoseVector& poses_ground_truth_, PoseGetter_ get_pose_) {
+  real error = 0;
+  for (Index index = 0; index < poses_ground_truth_.size(); ++index) {
+    error += (get_pose_(index).translation()-poses_ground_truth_[index].translation()).norm();
+  }
+  return error/poses_ground_truth_.size();
+}
+
+int32_t main(int32_t argc_, char** argv_) {
+
+  //ds configuration: graph sizes, poses per lap (each lap revisits the previous one), closure interval and iterations
+  std::vector<Count> numbers_of_vertices = {1000, 10000, 100000};
+  if (argc_ > 1) {
+    numbers_of_vertices = {std::stoul(argv_[1])};
+  }
+  const Count number_of_poses_per_lap     = 200;
+  const Count number_of_poses_per_closure = 5;
+  const Count number_of_iterations        = 5;
+  const real information_factor           = 100;
+  const Count number_of_poses_per_optimization        = 50;
+  const Count maximum_number_of_vertices_incremental  = 10000;
+  std::cerr << BAR << std::endl;
+  std::cerr << "benchmark_pose_graph_solvers|poses per lap: " << number_of_poses_per_lap << " poses per closure: " << number_of_poses_per_closure
+            << " iterations: " << number_of_iterations << std::endl;
+
+  for (const Count& number_of_vertices: numbers_of_vertices) {
+
+    //ds synthetic laps on a rising circle with noisy odometry and closures to the previous lap
+    std::mt19937 generator(0);
+    PoseVector poses_ground_truth(number_of_vertices);
+    PoseVector poses_initial(number_of_vertices);
+    for (Index index = 0; index < number_of_vertices; ++index) {
+      const real angle = 2*M_PI*(index%number_of_poses_per_lap)/number_of_poses_per_lap;
+      poses_ground_truth[index].setIdentity();
+      poses_ground_truth[index].linear()      = Eigen::AngleAxis<real>(angle, Vector3::UnitZ()).toRotationMatrix();
+      poses_ground_truth[index].translation() = Vector3(50*std::cos(angle), 50*std::sin(angle), 0.01*index);
+    }
+    std::vector<std::pair<Index, Index>> edges;
+    PoseVector measurements;
+    poses_initial[0] = poses_ground_truth[0];
+    for (Index index = 1; index < number_of_vertices; ++index) {
+      edges.push_back(std::make_pair(index, index-1));
+      measurements.push_back(poses_ground_truth[index-1].inverse()*poses_ground_truth[index]*getNoise(generator, 0.005, 0.0005));
+      poses_initial[index] = poses_initial[index-1]*measurements.back();
+    }
+    const Count number_of_odometry_edges = edges.size();
+    for (Index index = number_of_poses_per_lap; index < number_of_vertices; index += number_of_poses_per_closure) {
+      edges.push_back(std::make_pair(index, index-number_of_poses_per_lap));
+      measurements.push_back(poses_ground_truth[index-number_of_poses_per_lap].inverse()*poses_ground_truth[index]*getNoise(generator, 0.005, 0.0005));
+    }
+    const PoseGraphSolver::Matrix6 information(information_factor*PoseGraphSolver::Matrix6::Identity());
+
+    //ds g2o: gauss newton with cholmod on 6x3 blocks (as configured by the GraphOptimizer)
+    g2o::SparseOptimizer optimizer;
+    g2o::OptimizationAlgorithm* solver = nullptr;
+#ifdef SRRG_PROSLAM_G2O_HAS_NEW_OWNERSHIP_MODEL
+    std::unique_ptr<GraphOptimizer::LinearSolverCholmod6x3> linear_solver = g2o::make_unique<GraphOptimizer::LinearSolverCholmod6x3>();
+    linear_solver->setBlockOrdering(true);
+    std::unique_ptr<GraphOptimizer::BlockSolver6x3> block_solver = g2o::make_unique<GraphOptimizer::BlockSolver6x3>(std::move(linear_solver));
+    solver = new GraphOptimizer::OptimizerGaussNewton(std::move(block_solver));
+#else
+    GraphOptimizer::LinearSolverCholmod6x3* linear_solver = new GraphOptimizer::LinearSolverCholmod6x3();
+    linear_solver->setBlockOrdering(true);
+    GraphOptimizer::BlockSolver6x3* block_solver = new GraphOptimizer::BlockSolver6x3(linear_solver);
+    solver = new GraphOptimizer::OptimizerGaussNewton(block_solver);
+#endif
+    optimizer.setAlgorithm(solver);
+    optimizer.setVerbose(false);
+    for (Index index = 0; index < number_of_vertices; ++index) {
+      g2o::VertexSE3* vertex = new g2o::VertexSE3();
+      vertex->setId(index);
+      vertex->setEstimate(poses_initial[index]);
+      vertex->setFixed(index == 0);
+      optimizer.addVertex(vertex);
+    }
+    for (Index index = 0; index < edges.size(); ++index) {
+      g2o::EdgeSE3* edge = new g2o::EdgeSE3();
+      edge->setVertex(1, optimizer.vertex(edges[index].first));
+      edge->setVertex(0, optimizer.vertex(edges[index].second));
+      edge->setMeasurement(measurements[index]);
+      edge->setInformation(information);
+      if (index >= number_of_odometry_edges) {edge->setRobustKernel(new g2o::RobustKernelCauchy());}
+      optimizer.addEdge(edge);
+    }
+    std::chrono::time_point<std::chrono::high_resolution_clock> time_begin = std::chrono::high_resolution_clock::now();
+    optimizer.initializeOptimization();
+    optimizer.optimize(number_of_iterations);
+    const double duration_seconds_g2o = getSecondsSince(time_begin);
+    const real error_g2o = getMeanTranslationError(poses_ground_truth, [&optimizer](const Index& index_) {
+      return static_cast<g2o::VertexSE3*>(optimizer.vertex(index_))->estimate();
+    });
+
+    //ds specialized pose graph solver with identical input
+    PoseGraphSolver pose_graph_solver;
+    for (Index index = 0; index < number_of_vertices; ++index) {
+      pose_graph_solver.addVertex(poses_initial[index], index == 0);
+    }
+    for (Index index = 0; index < edges.size(); ++index) {
+      pose_graph_solver.addEdge(edges[index].first, edges[index].second, measurements[index], information, index >= number_of_odometry_edges);
+    }
+    time_begin = std::chrono::high_resolution_clock::now();
+    const Count number_of_iterations_native = pose_graph_solver.optimize(number_of_iterations);
+    const double duration_seconds_native = getSecondsSince(time_begin);
+    const real error_native = getMeanTranslationError(poses_ground_truth, [&pose_graph_solver](const Index& index_) {
+      return pose_graph_solver.estimate(index_);
+    });
+    const real error_initial = getMeanTranslationError(poses_ground_truth, [&poses_initial](const Index& index_) {
+      return poses_initial[index_];
+    });
+
+    std::cerr << "benchmark_pose_graph_solvers|vertices: " << number_of_vertices << " edges: " << edges.size()
+              << " initial error (m): " << error_initial << std::endl;
+    std::cerr << "benchmark_pose_graph_solvers|G2O    duration (s): " << duration_seconds_g2o
+              << " error (m): " << error_g2o << " chi2: " << optimizer.activeRobustChi2() << std::endl;
+    std::cerr << "benchmark_pose_graph_solvers|NATIVE duration (s): " << duration_seconds_native
+              << " error (m): " << error_native << " chi2: " << pose_graph_solver.chi2()
+              << " iterations: " << number_of_iterations_native << std::endl;
+    std::cerr << "benchmark_pose_graph_solvers|speedup: " << duration_seconds_g2o/duration_seconds_native << std::endl;
+
+    //ds specialized pose graph solver used incrementally (as by the GraphOptimizer in incremental mode): the vertices are appended with their
+    //ds odometry and a closure triggers a warm started optimization once enough poses have been appended (quadratic cost, small graphs only)
+    if (number_of_vertices > maximum_number_of_vertices_incremental) {
+      continue;
+    }
+    PoseGraphSolver pose_graph_solver_incremental;
+    pose_graph_solver_incremental.addVertex(poses_initial[0], true);
+    Index index_edge_closure = number_of_odometry_edges;
+    Count number_of_poses_since_optimization = 0;
+    Count number_of_optimizations_incremental = 0;
+    double duration_seconds_incremental = 0;
+    for (Index index = 1; index < number_of_vertices; ++index) {
+      pose_graph_solver_incremental.addVertex(pose_graph_solver_incremental.estimate(index-1)*measurements[index-1]);
+      pose_graph_solver_incremental.addEdge(index, index-1, measurements[index-1], information);
+      ++number_of_poses_since_optimization;
+      if (index_edge_closure < edges.size() && edges[index_edge_closure].first == index) {
+        pose_graph_solver_incremental.addEdge(index, edges[index_edge_closure].second, measurements[index_edge_closure], information, true);
+        ++index_edge_closure;
+        if (number_of_poses_since_optimization >= number_of_poses_per_optimization) {
+          pose_graph_solver_incremental.setNumberOfReservedVertices(2*number_of_poses_since_optimization);
+          time_begin = std::chrono::high_resolution_clock::now();
+          pose_graph_solver_incremental.optimize(number_of_iterations, 1e-5);
+          duration_seconds_incremental += getSecondsSince(time_begin);
+          ++number_of_optimizations_incremental;
+          number_of_poses_since_optimization = 0;
+        }
+      }
+    }
+    const real error_incremental = getMeanTranslationError(poses_ground_truth, [&pose_graph_solver_incremental](const Index& index_) {
+      return pose_graph_solver_incremental.estimate(index_);
+    });
+    std::cerr << "benchmark_pose_graph_solvers|NATIVE incremental optimizations: " << number_of_optimizations_incremental
+              << " duration (s): " << duration_seconds_incremental << " error (m): " << error_incremental
+              << " symbolic factorizations: " << pose_graph_solver_incremental.numberOfSymbolicFactorizations()
+              << " pattern extensions: " << pose_graph_solver_incremental.numberOfPatternExtensions() << std::endl;
+  }
+  std::cerr << BAR << std::endl;
+  return 0;
+}
@@ -0,0 +1,23 @@
+#!/bin/bash
+#ds RGB-D regression check: runs the app on a TUM RGB-D sequence (converted to txt_io) and fails if the aligned trajectory error exceeds a maximum RMSE
+#ds usage: ./regression_tum.sh <binary folder> <configuration_tum.yaml> <dataset.txt> <groundtruth.txt> [maximum RMSE in meters, default: 0.05]
+#ds the app is run in the dataset folder (txt_io image paths are relative to it) and writes trajectory_tum.txt there
+if [ "$#" -lt 4 ]; then
+  echo "usage: ./regression_tum.sh <binary folder> <configuration_tum.yaml> <dataset.txt> <groundtruth.txt> [maximum RMSE in meters, default: 0.05]" >&2
+  exit 2
+fi
+BINARY_FOLDER=$(cd "$1" && pwd) || exit 2
+CONFIGURATION=$(cd "$(dirname "$2")" && pwd)/$(basename "$2")
+DATASET_FOLDER=$(cd "$(dirname "$3")" && pwd) || exit 2
+DATASET=$(basename "$3")
+GROUND_TRUTH=$(cd "$(dirname "$4")" && pwd)/$(basename "$4")
+MAXIMUM_RMSE=${5:-0.05}
+
+#ds process the sequence (a crash fails the check)
+cd "$DATASET_FOLDER" || exit 2
+rm -f trajectory_tum.txt
+"$BINARY_FOLDER/app" -c "$CONFIGURATION" "$DATASET" || { echo "regression_tum|app failed" >&2; exit 1; }
+
+#ds the analyzer returns a non-zero status if the trajectory is missing or its aligned RMSE exceeds the maximum
+"$BINARY_FOLDER/trajectory_analyzer" -tum trajectory_tum.txt -tum-gt "$GROUND_TRUTH" -max-rmse "$MAXIMUM_RMSE" || { echo "regression_tum|FAILED (maximum RMSE: $MAXIMUM_RMSE m)" >&2; exit 1; }
+echo "regression_tum|PASSED (maximum RMSE: $MAXIMUM_RMSE m)" >&2
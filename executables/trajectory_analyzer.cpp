@@ -23,7 +23,7 @@ const Eigen::Vector3d getInterpolatedPositionLinear(const PositionMeasurement& g
 
 int32_t main (int32_t argc_, char** argv_) {
   if (argc_ < 5) {
-    std::cerr << "usage: ./trajectory_analyzer -tum <trajectory.txt> -asl <ground_truth.txt> [-skip <integer>]" << std::endl;
+    std::cerr << "usage: ./trajectory_analyzer -tum <trajectory.txt> -asl|-tum-gt <ground_truth.txt> [-skip <integer>] [-max-rmse <meters>]" << std::endl;
     return 0;
   }
 
@@ -31,6 +31,10 @@ int32_t main (int32_t argc_, char** argv_) {
   std::string file_name_trajectory_slam = argv_[1];
   std::string file_name_trajectory_ground_truth = argv_[2];
   uint32_t number_of_poses_to_skip = 0;
+  bool is_ground_truth_tum = false;
+
+  //ds regression check: the analyzer fails if the optimal RMSE exceeds this value (disabled if not positive)
+  double maximum_rmse_meters = 0;
 
   //ds parse configuration
   int32_t number_of_checked_parameters = 1;
@@ -43,6 +47,15 @@ int32_t main (int32_t argc_, char** argv_) {
       ++number_of_checked_parameters;
       if (number_of_checked_parameters == argc_) {break;}
       file_name_trajectory_ground_truth = argv_[number_of_checked_parameters];
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-tum-gt")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      file_name_trajectory_ground_truth = argv_[number_of_checked_parameters];
+      is_ground_truth_tum = true;
+    } else if (!std::strcmp(argv_[number_of_checked_parameters], "-max-rmse")) {
+      ++number_of_checked_parameters;
+      if (number_of_checked_parameters == argc_) {break;}
+      maximum_rmse_meters = std::stod(argv_[number_of_checked_parameters]);
     } else if (!std::strcmp(argv_[number_of_checked_parameters], "-skip")) {
       ++number_of_checked_parameters;
       if (number_of_checked_parameters == argc_) {break;}
@@ -55,12 +68,14 @@ int32_t main (int32_t argc_, char** argv_) {
   std::cerr << "file_name_trajectory_slam: " << file_name_trajectory_slam << std::endl;
   std::cerr << "file_name_trajectory_ground_truth: " << file_name_trajectory_ground_truth << std::endl;
   std::cerr << "number_of_poses_to_skip: " << number_of_poses_to_skip << std::endl;
+  std::cerr << "is_ground_truth_tum: " << is_ground_truth_tum << std::endl;
+  std::cerr << "maximum_rmse_meters: " << maximum_rmse_meters << std::endl;
 
   //ds parse SLAM trajectory
   std::ifstream input_stream_trajectory_slam(file_name_trajectory_slam);
   if (!input_stream_trajectory_slam.good() || !input_stream_trajectory_slam.is_open()) {
     std::cerr << "ERROR: unable to open: '" << file_name_trajectory_slam << "'" << std::endl;
-    return 0;
+    return -1;
   }
 
   //ds load SLAM trajectory poses
@@ -87,7 +102,7 @@ int32_t main (int32_t argc_, char** argv_) {
                                             >> quaternion_x >> quaternion_y >> quaternion_z >> quaternion_w)) {
       std::cerr << "ERROR: unable to parse pose lines" << std::endl;
       input_stream_trajectory_slam.close();
-      return 0;
+      return -1;
     }
 
     //ds set pose value
@@ -106,7 +121,7 @@ int32_t main (int32_t argc_, char** argv_) {
   //ds check skip
   if (number_of_poses_to_skip >= positions_slam.size()) {
     std::cerr << "ERROR: insufficient number of measurements for number_of_poses_to_skip: " << number_of_poses_to_skip << std::endl;
-    return 0;
+    return -1;
   }
 
   //ds also cut skipped poses from the end
@@ -117,19 +132,33 @@ int32_t main (int32_t argc_, char** argv_) {
   std::ifstream input_stream_trajectory_ground_truth(file_name_trajectory_ground_truth);
   if (!input_stream_trajectory_ground_truth.good() || !input_stream_trajectory_ground_truth.is_open()) {
     std::cerr << "ERROR: unable to open: '" << file_name_trajectory_ground_truth << "'" << std::endl;
-    return 0;
+    return -1;
   }
 
   //ds load ground truth poses
   std::vector<PositionMeasurement> positions_ground_truth;
   while (std::getline(input_stream_trajectory_ground_truth, buffer_line)) {
 
-    //ds skip comment lines
-    if (buffer_line[0] == '#') {
+    //ds skip comment and empty lines
+    if (buffer_line.empty() || buffer_line[0] == '#') {
       continue;
     }
 
-    //ds parse control
+    //ds TUM format: timestamp (seconds) tx ty tz qx qy qz qw
+    if (is_ground_truth_tum) {
+      std::istringstream stringstream(buffer_line);
+      double timestamp_seconds = 0;
+      Eigen::Vector3d position(Eigen::Vector3d::Zero());
+      if (!(stringstream >> timestamp_seconds >> position.x() >> position.y() >> position.z())) {
+        std::cerr << "ERROR: unable to parse ground truth pose lines" << std::endl;
+        input_stream_trajectory_ground_truth.close();
+        return -1;
+      }
+      positions_ground_truth.push_back(PositionMeasurement(timestamp_seconds, position));
+      continue;
+    }
+
+    //ds ASL format: parse control
     std::string::size_type index_begin_item = 0;
     std::string::size_type index_end_item   = 0;
 
@@ -172,8 +201,8 @@ int32_t main (int32_t argc_, char** argv_) {
       }
     }
 
-    //ds skip until we arrive at the ground truth timestamp
-    if (index_best == 0) {
+    //ds skip until we arrive at the ground truth timestamp (and after we left it)
+    if (index_best == 0 || index_best+1 == positions_ground_truth.size()) {
       continue;
     }
 
@@ -281,7 +310,17 @@ int32_t main (int32_t argc_, char** argv_) {
   std::cerr << "done" << std::endl;
 
   //ds done
-  std::cerr << "\noptimal RMSE: " << getAbsoluteTranslationRootMeanSquaredError(position_correspondences) << std::endl;
+  const double root_mean_squared_error = getAbsoluteTranslationRootMeanSquaredError(position_correspondences);
+  std::cerr << "\noptimal RMSE: " << root_mean_squared_error << std::endl;
+
+  //ds regression check
+  if (maximum_rmse_meters > 0) {
+    if (position_correspondences.empty() || !(root_mean_squared_error <= maximum_rmse_meters)) {
+      std::cerr << "FAILED: optimal RMSE exceeds the maximum: " << maximum_rmse_meters << std::endl;
+      return 1;
+    }
+    std::cerr << "PASSED: optimal RMSE below the maximum: " << maximum_rmse_meters << std::endl;
+  }
   return 0;
 }
 
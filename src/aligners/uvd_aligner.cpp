@@ -17,18 +17,65 @@ namespace proslam {
   void UVDAligner::initialize(const Frame* frame_previous_,
                               const Frame* frame_current_,
                               const TransformMatrix3D& previous_to_current_) {
-    _frame_current = frame_current_;
-    _errors.resize(_frame_current->points().size());
-    _inliers.resize(_frame_current->points().size());
-//  TODO _robot_to_world = previous_to_current_;
-//    _world_to_robot = _robot_to_world.inverse();
+    _frame_previous      = frame_previous_;
+    _frame_current       = frame_current_;
+    _previous_to_current = previous_to_current_;
 
     //ds wrappers for optimization
-//    _camera_to_world = _robot_to_world*_frame_current->cameraLeft()->cameraToRobot();
-//    _world_to_camera = _camera_to_world.inverse();
-    _camera_matrix  = _frame_current->cameraLeft()->cameraMatrix();
+    _camera_matrix        = _frame_current->cameraLeft()->cameraMatrix();
     _number_of_rows_image = _frame_current->cameraLeft()->numberOfImageRows();
     _number_of_cols_image = _frame_current->cameraLeft()->numberOfImageCols();
+
+    //ds prepare buffers
+    _number_of_measurements = _frame_current->points().size();
+    _errors.resize(_number_of_measurements);
+    _inliers.resize(_number_of_measurements);
+    _information_vector.resize(_number_of_measurements);
+    _weights_translation.resize(_number_of_measurements, 1);
+    _moving.resize(_number_of_measurements);
+    _fixed.resize(_number_of_measurements);
+
+    //ds squared focal length: scales the metric depth error to the magnitude of the pixel errors
+    const real focal_length_squared = _camera_matrix(0,0)*_camera_matrix(1,1);
+
+    //ds fill buffers
+    for (Index u = 0; u < _number_of_measurements; ++u) {
+      const FramePoint* frame_point = _frame_current->points()[u];
+      assert(_frame_current->cameraLeft()->isInFieldOfView(frame_point->imageCoordinatesLeft()));
+      assert(frame_point->previous());
+
+      //ds set fixed part (image coordinates and measured depth)
+      _fixed[u](0) = frame_point->imageCoordinatesLeft().x();
+      _fixed[u](1) = frame_point->imageCoordinatesLeft().y();
+      _fixed[u](2) = frame_point->cameraCoordinatesLeft().z();
+
+      //ds the depth measurement uncertainty grows with the distance to the sensor
+      _information_vector[u].setIdentity();
+      _information_vector[u](2,2) = focal_length_squared/(_fixed[u](2)*_fixed[u](2));
+
+      //ds if we have a landmark
+      if (frame_point->landmark()) {
+
+        //ds prefer landmark estimate
+        _moving[u] = frame_point->previous()->cameraCoordinatesLeftLandmark();
+
+        //ds increase weight linear in the number of updates
+        _information_vector[u] *= (1+frame_point->landmark()->numberOfUpdates());
+      } else {
+
+        //ds set moving part (3D point coordinates)
+        _moving[u] = frame_point->previous()->cameraCoordinatesLeft();
+      }
+    }
+
+    //ds if individual weighting is desired
+    if (_enable_weights_translation) {
+      for (Index u = 0; u < _number_of_measurements; ++u) {
+        _weights_translation[u] = std::min(_maximum_depth_near_meters/_moving[u].z(), 1.0);
+      }
+    } else {
+      std::fill(_weights_translation.begin(), _weights_translation.end(), 1);
+    }
   }
 
   //ds linearize the system: to be called inside oneRound
@@ -37,126 +84,116 @@ namespace proslam {
     //ds initialize setup
     _H.setZero();
     _b.setZero();
-    _number_of_inliers  = 0;
-    _number_of_outliers = 0;
-    _total_error        = 0;
-
-    //ds loop over all points (assumed to have previous points)
-    for (Index index_point = 0; index_point < _frame_current->points().size(); index_point++) {
-      _errors[index_point]  = -1;
-      _inliers[index_point] = false;
-      _omega.setIdentity();
-      _omega(2,2)*=10;
-      
-      //ds buffer framepoint
-      FramePoint* frame_point = _frame_current->points()[index_point];
-      assert(_frame_current->cameraLeft()->isInFieldOfView(frame_point->imageCoordinatesLeft()));
-      assert(frame_point->previous());
+    _number_of_inliers = 0;
+    _total_error       = 0;
 
-      //ds buffer landmark
-      const Landmark* landmark = frame_point->landmark();
+    //ds loop over all current framepoints (assuming that each of them has a previous one)
+    for (Index u = 0; u < _number_of_measurements; ++u) {
+      _errors[u]  = -1;
+      _inliers[u] = false;
+      _omega      = _information_vector[u];
 
       //ds compute the point in the camera frame - prefering a landmark estimate if available
-      PointCoordinates predicted_point_in_camera = PointCoordinates::Zero();
-      if (landmark) {
-//        predicted_point_in_camera = _world_to_camera*landmark->coordinates();
-        _omega *= 1.5;
-      } else {
-//        predicted_point_in_camera = _world_to_camera*frame_point->previous()->worldCoordinates();
-      }
-      const real& depth_meters = predicted_point_in_camera.z();
-      if (depth_meters <= 0 || depth_meters > _maximum_depth_far_meters) {
+      const PointCoordinates sampled_point_in_camera = _previous_to_current*_moving[u];
+      const real& depth_meters = sampled_point_in_camera.z();
+      if (depth_meters <= _minimum_depth || depth_meters > _maximum_depth_far_meters) {
         continue;
       }
 
       //ds retrieve homogeneous projections
-      const PointCoordinates predicted_uvd_in_camera  = _camera_matrix*predicted_point_in_camera;
-      
+      const PointCoordinates sampled_abc_in_camera = _camera_matrix*sampled_point_in_camera;
+
       //ds compute the image coordinates
-      PointCoordinates predicted_point_in_image  = predicted_uvd_in_camera/depth_meters;
-      //restore the depth in the third component
-      predicted_point_in_image.z()=depth_meters;
-      
+      const PointCoordinates sampled_point_in_image = sampled_abc_in_camera/depth_meters;
+
       //ds if the point is outside the image, skip
-      if (predicted_point_in_image.x() < 0 || predicted_point_in_image.x() > _number_of_cols_image||
-          predicted_point_in_image.y() < 0 || predicted_point_in_image.y() > _number_of_rows_image) {
+      if (sampled_point_in_image.x() < 0 || sampled_point_in_image.x() > _number_of_cols_image||
+          sampled_point_in_image.y() < 0 || sampled_point_in_image.y() > _number_of_rows_image) {
         continue;
       }
+      assert(_frame_current->cameraLeft()->isInFieldOfView(sampled_point_in_image));
 
-      assert(_frame_current->cameraLeft()->isInFieldOfView(predicted_point_in_image));
-      
-      //ds precompute
-      const real inverse_predicted_d  = 1/depth_meters;
-      const real inverse_predicted_d_squared  = inverse_predicted_d*inverse_predicted_d;
-
-      //ds compute error
-      const Vector3 error(predicted_point_in_image.x()-frame_point->imageCoordinatesLeft().x(),
-                          predicted_point_in_image.y()-frame_point->imageCoordinatesLeft().y(),
-			  predicted_point_in_image.z()-frame_point->cameraCoordinatesLeft().z());
+      //ds compute error (image coordinates and depth)
+      const Vector3 error(sampled_point_in_image.x()-_fixed[u](0),
+                          sampled_point_in_image.y()-_fixed[u](1),
+                          depth_meters-_fixed[u](2));
 
       //ds compute squared error
-      const real chi = error.transpose()*error;
+      const real chi = error.transpose()*_omega*error;
 
       //ds update error stats
-      _errors[index_point] = chi;
+      _errors[u] = chi;
 
-      //ds if outlier
+      //ds check if outlier
       if (chi > _parameters->maximum_error_kernel) {
-        ++_number_of_outliers;
         if (ignore_outliers_) {
           continue;
         }
 
-        //ds include kernel in omega
+        //ds proportionally reduce information value of the measurement
         _omega *= _parameters->maximum_error_kernel/chi;
       } else {
-        _inliers[index_point] = true;
+        _inliers[u] = true;
         ++_number_of_inliers;
       }
 
       //ds update total error
-      _total_error += _errors[index_point];
+      _total_error += _errors[u];
 
       //ds compute the jacobian of the transformation
       Matrix3_6 jacobian_transform;
-      jacobian_transform.setZero();
 
-      //ds if the point is near enough - we consider translation
-      if (depth_meters < _maximum_depth_near_meters) {
-        jacobian_transform.block<3,3>(0,0).setIdentity();
-      }
+      //ds translation contribution (will be scaled with omega)
+      jacobian_transform.block<3,3>(0,0) = _weights_translation[u]*Matrix3::Identity();
 
-      //ds always consider rotation
-      jacobian_transform.block<3,3>(0,3) = -2*skew(predicted_point_in_camera);
+      //ds rotation contribution
+      jacobian_transform.block<3,3>(0,3) = -2*skew(sampled_point_in_camera);
+
+      //ds precompute
+      const real inverse_sampled_c         = 1/depth_meters;
+      const real inverse_sampled_c_squared = inverse_sampled_c*inverse_sampled_c;
 
       //ds jacobian parts of the homogeneous division
-      Matrix3 jacobian_projection;
-      jacobian_projection <<
-      inverse_predicted_d, 0, -predicted_uvd_in_camera.x()*inverse_predicted_d_squared,
-      0, inverse_predicted_d, -predicted_uvd_in_camera.y()*inverse_predicted_d_squared,
-      0, 0, 1;
+      Matrix2_3 jacobian_projection;
+      jacobian_projection << inverse_sampled_c, 0, -sampled_abc_in_camera.x()*inverse_sampled_c_squared,
+                             0, inverse_sampled_c, -sampled_abc_in_camera.y()*inverse_sampled_c_squared;
+
+      //ds assemble final jacobian: image coordinates
+      _jacobian.block<2,6>(0,0) = jacobian_projection*_camera_matrix*jacobian_transform;
 
-      //ds assemble final jacobian
-      _jacobian = jacobian_projection*_camera_matrix*jacobian_transform;
+      //ds assemble final jacobian: depth (directly the z component of the transformed point)
+      _jacobian.block<1,6>(2,0) = jacobian_transform.block<1,6>(2,0);
 
       //ds precompute transposed
       const Matrix6_3 jacobian_transposed(_jacobian.transpose());
 
-      if (depth_meters < _maximum_depth_near_meters) {
-        _omega *= (_maximum_depth_near_meters-depth_meters)/_maximum_depth_near_meters;
-      } else {
-        _omega *= (_maximum_depth_far_meters-depth_meters)/_maximum_depth_far_meters;
-      }
-
       //ds update H and b
       _H += jacobian_transposed*_omega*_jacobian;
       _b += jacobian_transposed*_omega*error;
     }
+
+    //ds update statistics
+    _number_of_outliers = _number_of_measurements-_number_of_inliers;
   }
 
   //ds solve alignment problem for one round
   void UVDAligner::oneRound(const bool& ignore_outliers_) {
-    throw std::runtime_error("UVDAligner::oneRound|TODO: sanitize");
+
+    //ds linearize system once
+    linearize(ignore_outliers_);
+
+    //ds damping
+    _H += _parameters->damping*_number_of_measurements*Matrix6::Identity();
+
+    //ds compute solution transformation after perturbation
+    const Vector6 dx     = _H.fullPivLu().solve(-_b);
+    _previous_to_current = v2t(dx)*_previous_to_current;
+
+    //ds enforce proper rotation matrix
+    const Matrix3 rotation               = _previous_to_current.linear();
+    Matrix3 rotation_squared             = rotation.transpose() * rotation;
+    rotation_squared.diagonal().array() -= 1;
+    _previous_to_current.linear()       -= 0.5*rotation*rotation_squared;
   }
 
   //ds solve alignment problem until convergence is reached
@@ -171,11 +208,22 @@ namespace proslam {
 
       //ds check if converged (no descent required)
       if (_parameters->error_delta_for_convergence > std::fabs(total_error_previous-_total_error)) {
+        total_error_previous = _total_error;
 
-        //ds trigger inlier only runs
-        oneRound(true);
-        oneRound(true);
-        oneRound(true);
+        //ds if we have more inliers than outliers - trigger inlier only runs
+        if (_number_of_inliers > _number_of_outliers) {
+          for (Count iteration_inlier = 0; iteration_inlier < _parameters->maximum_number_of_iterations; ++iteration_inlier) {
+            oneRound(true);
+
+            //ds check for convergence
+            if (std::fabs(total_error_previous-_total_error) < _parameters->error_delta_for_convergence) {
+              total_error_previous = _total_error;
+              break;
+            } else {
+              total_error_previous = _total_error;
+            }
+          }
+        }
 
         //ds compute information matrix
         _information_matrix = _H;
@@ -196,9 +244,12 @@ namespace proslam {
       }
     }
 
-//    //ds update wrapped structures
-//    _camera_to_world = _world_to_camera.inverse();
-//    _robot_to_world = _camera_to_world*_frame_current->cameraLeft()->robotToCamera();
-//    _world_to_robot = _robot_to_world.inverse();
+    //ds VISUALIZATION ONLY
+    for (Index u = 0; u < _number_of_measurements; ++u) {
+      FramePoint* frame_point = _frame_current->points()[u];
+      ImageCoordinates image_coordinates(_camera_matrix*_previous_to_current*_moving[u]);
+      image_coordinates /= image_coordinates.z();
+      frame_point->setProjectionEstimateLeftOptimized(cv::Point2f(image_coordinates.x(), image_coordinates.y()));
+    }
   }
 }
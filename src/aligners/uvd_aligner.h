@@ -3,7 +3,7 @@
 
 namespace proslam {
 
-//ds this class specifies an aligner for pose optimization by minimizing the reprojection errors in the image plane (used to determine the robots odometry)
+//ds this class specifies an aligner for pose optimization by minimizing the reprojection errors in the image plane and the depth errors (used to determine the robots odometry)
 class UVDAligner: public BaseFrameAligner, public AlignerWorkspace<6,3> {
 
 //ds object handling
@@ -31,5 +31,12 @@ protected:
 
   //ds buffers
   CameraMatrix _camera_matrix = CameraMatrix::Zero();
+  real _minimum_depth         = 0.1;
+
+  Count _number_of_measurements = 0;
+  std::vector<DimensionMatrix, Eigen::aligned_allocator<DimensionMatrix> > _information_vector;
+  std::vector<Vector3, Eigen::aligned_allocator<Vector3> > _moving;
+  std::vector<Vector3, Eigen::aligned_allocator<Vector3> > _fixed;
+  std::vector<real> _weights_translation;
 };
 }
@@ -10,12 +10,17 @@ namespace proslam {
     //ds nothing to do
   }
 
+  void XYZAligner::configure() {
+
+    //ds no damping (set once here since the parameters might be shared by several aligners)
+    _parameters->damping = 0;
+  }
+
   void XYZAligner::initialize(Closure* context_, const TransformMatrix3D& current_to_reference_) {
 
     //ds initialize base components
     _context              = context_;
     _current_to_reference = current_to_reference_;
-    _parameters->damping = 0;
     _number_of_measurements = _context->correspondences.size();
     _errors.resize(_number_of_measurements);
     _inliers.resize(_number_of_measurements);
@@ -24,14 +29,12 @@ namespace proslam {
     _information_vector.resize(_number_of_measurements);
     _moving.resize(_number_of_measurements);
     _fixed.resize(_number_of_measurements);
-    const TransformMatrix3D& world_to_reference_local_map(context_->local_map_reference->worldToLocalMap());
-    const TransformMatrix3D& world_to_query_local_map(context_->local_map_query->worldToLocalMap());
     for (Index u = 0; u < _number_of_measurements; ++u) {
       const Closure::Correspondence* correspondence = _context->correspondences[u];
 
-      //ds point coordinates to register
-      _fixed[u]  = world_to_reference_local_map*correspondence->reference->coordinates();
-      _moving[u] = world_to_query_local_map*correspondence->query->coordinates();
+      //ds point coordinates to register (snapshots, the landmarks might be updated concurrently by the tracker)
+      _fixed[u]  = correspondence->coordinates_in_reference;
+      _moving[u] = correspondence->coordinates_in_query;
 
       //ds set information matrix
       _information_vector[u].setIdentity();
@@ -134,13 +137,16 @@ namespace proslam {
 
         //ds if the solution is acceptable
         if (_number_of_inliers > _parameters->minimum_number_of_inliers && inlier_ratio > _parameters->minimum_inlier_ratio) {
-          LOG_INFO(std::printf("XYZAligner::converge|registered local maps [%06lu:{%06lu-%06lu}] > [%06lu:{%06lu-%06lu}] "
-                               "(correspondences: %3lu, iterations: %2lu, inlier ratio: %5.3f, inliers: %2lu)\n",
-          _context->local_map_query->identifier(),
-          _context->local_map_query->frames().front()->identifier(), _context->local_map_query->frames().back()->identifier(),
-          _context->local_map_reference->identifier(),
-          _context->local_map_reference->frames().front()->identifier(), _context->local_map_reference->frames().back()->identifier(),
-          _context->correspondences.size(), iteration, inlier_ratio, _number_of_inliers))
+          //ds frame relocalization closures have no query local map
+          if (_context->local_map_query) {
+            LOG_INFO(std::printf("XYZAligner::converge|registered local maps [%06lu:{%06lu-%06lu}] > [%06lu:{%06lu-%06lu}] "
+                                 "(correspondences: %3lu, iterations: %2lu, inlier ratio: %5.3f, inliers: %2lu)\n",
+            _context->local_map_query->identifier(),
+            _context->local_map_query->frames().front()->identifier(), _context->local_map_query->frames().back()->identifier(),
+            _context->local_map_reference->identifier(),
+            _context->local_map_reference->frames().front()->identifier(), _context->local_map_reference->frames().back()->identifier(),
+            _context->correspondences.size(), iteration, inlier_ratio, _number_of_inliers))
+          }
 
           //ds enable closure
           _context->is_valid = true;
@@ -152,13 +158,15 @@ namespace proslam {
 
           break;
         } else {
-          LOG_DEBUG(std::printf("XYZAligner::converge|dropped registration for local maps [%06lu:{%06lu-%06lu}] > [%06lu:{%06lu-%06lu}] "
-                               "(correspondences: %3lu, iterations: %2lu, inlier ratio: %5.3f, inliers: %2lu)\n",
-          _context->local_map_query->identifier(),
-          _context->local_map_query->frames().front()->identifier(), _context->local_map_query->frames().back()->identifier(),
-          _context->local_map_reference->identifier(),
-          _context->local_map_reference->frames().front()->identifier(), _context->local_map_reference->frames().back()->identifier(),
-          _context->correspondences.size(), iteration, inlier_ratio, _number_of_inliers))
+          if (_context->local_map_query) {
+            LOG_DEBUG(std::printf("XYZAligner::converge|dropped registration for local maps [%06lu:{%06lu-%06lu}] > [%06lu:{%06lu-%06lu}] "
+                                  "(correspondences: %3lu, iterations: %2lu, inlier ratio: %5.3f, inliers: %2lu)\n",
+            _context->local_map_query->identifier(),
+            _context->local_map_query->frames().front()->identifier(), _context->local_map_query->frames().back()->identifier(),
+            _context->local_map_reference->identifier(),
+            _context->local_map_reference->frames().front()->identifier(), _context->local_map_reference->frames().back()->identifier(),
+            _context->correspondences.size(), iteration, inlier_ratio, _number_of_inliers))
+          }
           _context->is_valid = false;
           break;
         }
@@ -171,7 +179,7 @@ namespace proslam {
         _context->is_valid = false;
         _has_system_converged = false;
         LOG_DEBUG(std::cerr << "XYZAligner::converge|system did not converge - inlier ratio: " << static_cast<real>(_number_of_inliers)/_context->correspondences.size()
-                            << " [" << _context->local_map_query->identifier() << "][" << _context->local_map_reference->identifier() << "]" << std::endl)
+                            << " [" << (_context->local_map_query? _context->local_map_query->identifier(): 0) << "][" << _context->local_map_reference->identifier() << "]" << std::endl)
       }
     }
   }
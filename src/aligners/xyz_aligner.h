@@ -12,6 +12,9 @@ PROSLAM_MAKE_PROCESSING_SUBCLASS(XYZAligner, AlignerParameters)
 //ds functionality
 public:
 
+  //! @brief configuration method, called once all construction parameters are set
+  virtual void configure();
+
   //ds initialize aligner with minimal entity
   virtual void initialize(Closure* context_, const TransformMatrix3D& current_to_reference_ = TransformMatrix3D::Identity());
 
@@ -16,135 +16,712 @@ void DepthFramePointGenerator::configure(){
   //ds update base
   BaseFramePointGenerator::configure();
 
+  //ds check registration mode
+  if (_parameters->depth_registration_mode == "FULL") {
+    _enable_sparse_registration = false;
+  } else if (_parameters->depth_registration_mode == "SPARSE") {
+    _enable_sparse_registration = true;
+  } else {
+    throw std::runtime_error("DepthFramePointGenerator::configure|invalid depth registration mode: " + _parameters->depth_registration_mode);
+  }
+
+  //ds allocate depth registration buffers (the left image resolution is constant)
+  _space_map_left_meters.create(_number_of_rows_image, _number_of_cols_image, CV_32FC3);
+  _row_map.create(_number_of_rows_image, _number_of_cols_image, CV_16SC1);
+  _col_map.create(_number_of_rows_image, _number_of_cols_image, CV_16SC1);
+  _space_map_left_meters.setTo(cv::Scalar(0, 0, _maximum_reliable_depth_far_meters));
+  _row_map = -1;
+  _col_map = -1;
+  _registered_pixels.clear();
+  _registered_pixels.reserve(_number_of_rows_image*_number_of_cols_image);
+  _neighborhood_stamps.resize(_number_of_rows_image*_number_of_cols_image, 0);
+  _registration_stamp = 0;
+
+  //ds precompute the viewing rays of the depth camera (constant for all frames)
+  _number_of_rows_depth = _camera_right->numberOfImageRows();
+  _number_of_cols_depth = _camera_right->numberOfImageCols();
+  const Matrix3 inverse_camera_matrix_right = _camera_right->cameraMatrix().inverse();
+  _ray_table_x.resize(_number_of_rows_depth*_number_of_cols_depth);
+  _ray_table_y.resize(_number_of_rows_depth*_number_of_cols_depth);
+  for (int32_t r = 0; r < _number_of_rows_depth; ++r) {
+    for (int32_t c = 0; c < _number_of_cols_depth; ++c) {
+      const Vector3 ray(inverse_camera_matrix_right*Vector3(c, r, 1));
+      _ray_table_x[r*_number_of_cols_depth+c] = ray.x()/ray.z();
+      _ray_table_y[r*_number_of_cols_depth+c] = ray.y()/ray.z();
+    }
+  }
+  _buffer_x.resize(_number_of_rows_depth*_number_of_cols_depth);
+  _buffer_y.resize(_number_of_rows_depth*_number_of_cols_depth);
+  _buffer_z.resize(_number_of_rows_depth*_number_of_cols_depth);
+  _buffer_row.resize(_number_of_rows_depth*_number_of_cols_depth);
+  _buffer_col.resize(_number_of_rows_depth*_number_of_cols_depth);
+  _destination_row_minimum.resize(_number_of_rows_depth);
+  _destination_row_maximum.resize(_number_of_rows_depth);
+
+  //ds flatten the depth to left camera transform and the left projection in single precision
+  const TransformMatrix3D right_to_left_transform = _camera_left->robotToCamera()*_camera_right->cameraToRobot();
+  for (uint32_t r = 0; r < 3; ++r) {
+    for (uint32_t c = 0; c < 3; ++c) {
+      _depth_to_left_rotation[3*r+c] = right_to_left_transform.linear()(r,c);
+    }
+    _depth_to_left_translation[r] = right_to_left_transform.translation()(r);
+  }
+  _camera_matrix_left[0] = _camera_left->cameraMatrix()(0,0);
+  _camera_matrix_left[1] = _camera_left->cameraMatrix()(1,1);
+  _camera_matrix_left[2] = _camera_left->cameraMatrix()(0,2);
+  _camera_matrix_left[3] = _camera_left->cameraMatrix()(1,2);
+
+  //ds check if the depth image is already registered to the left image (e.g. on-device registration)
+  _is_depth_registered = (right_to_left_transform.matrix().isApprox(TransformMatrix3D::Identity().matrix(), 1e-6) &&
+                          _camera_right->cameraMatrix().isApprox(_camera_left->cameraMatrix(), 1e-6)                &&
+                          _number_of_rows_depth == _number_of_rows_image && _number_of_cols_depth == _number_of_cols_image);
+
+  //ds sparse mode: map left pixels into the depth image assuming infinite depth, the neighborhood covers the maximum parallax
+  _left_to_depth_homography = _camera_right->cameraMatrix()*right_to_left_transform.linear().transpose()*_camera_left->cameraMatrix().inverse();
+  const real maximum_parallax_pixels = _camera_right->cameraMatrix()(0,0)*right_to_left_transform.translation().norm()/
+                                       _parameters->sparse_registration_minimum_depth_meters;
+  _sparse_registration_radius_depth_pixels = _parameters->sparse_registration_radius_pixels+std::ceil(maximum_parallax_pixels);
+  const int32_t radius = (_is_depth_registered? _parameters->sparse_registration_radius_pixels: _sparse_registration_radius_depth_pixels);
+  _number_of_depth_pixels_per_neighborhood = (2*radius+1)*(2*radius+1);
+  _is_depth_map_sparse = false;
+
+  //ds launch the registration threads, kept for all frames (the calling thread processes the first band of rows)
+  _stopRegistration();
+  _number_of_bands = std::max(std::min(_parameters->number_of_registration_threads, static_cast<Count>(_number_of_rows_image)), static_cast<Count>(1));
+  _is_registration_running = true;
+  for (Index index_band = 1; index_band < _number_of_bands; ++index_band) {
+    _registration_threads.push_back(std::thread(&DepthFramePointGenerator::_processRegistrations, this, index_band, _registration_round));
+  }
+
   //ds info
+  LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|depth registration mode: " << _parameters->depth_registration_mode
+                     << " (registered depth: " << _is_depth_registered << ")" << std::endl)
+  if (_enable_sparse_registration) {
+    LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|sparse registration radius (depth pixels): " << _sparse_registration_radius_depth_pixels << std::endl)
+  }
+  LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|registration threads: " << _number_of_bands << std::endl)
   LOG_INFO(std::cerr << "DepthFramePointGenerator::configure|configured" << std::endl)
 }
 
 //ds cleanup of dynamic structures
 DepthFramePointGenerator::~DepthFramePointGenerator() {
+  _stopRegistration();
   LOG_INFO(std::cerr << "DepthFramePointGenerator::~DepthFramePointGenerator|destroyed" << std::endl)
 }
 
 void DepthFramePointGenerator::_computeDepthMap(const cv::Mat& right_depth_image) {
-  if (right_depth_image.type()!=CV_16UC1){
-    throw std::runtime_error("depth tracker requires a 16bit mono image to encode depth");
+  if (right_depth_image.type() != CV_16UC1) {
+    throw std::runtime_error("DepthFramePointGenerator::_computeDepthMap|depth tracker requires a 16bit mono image to encode depth");
+  }
+  if (right_depth_image.rows != _number_of_rows_depth || right_depth_image.cols != _number_of_cols_depth) {
+    throw std::runtime_error("DepthFramePointGenerator::_computeDepthMap|depth image dimensions do not match the depth camera");
   }
 
-  //ds allocate new space map and initialize fields
-  _space_map_left_meters.create(_number_of_rows_image,_number_of_cols_image, CV_32FC3);
-  for (int32_t row = 0; row < _number_of_rows_image; ++row) {
-    for (int32_t col = 0; col < _number_of_cols_image; ++col) {
-      _space_map_left_meters.at<cv::Vec3f>(row, col) = cv::Vec3f(0,0,_maximum_reliable_depth_far_meters);
-    }
+  //ds reset space map and index fields
+  _space_map_left_meters.setTo(cv::Scalar(0, 0, _maximum_reliable_depth_far_meters));
+  _row_map = -1;
+  _col_map = -1;
+  _registered_pixels.clear();
+  _is_depth_map_sparse = false;
+
+  //ds transform and project all depth rows, then fill the left image rows (each band of rows is written by a single thread)
+  _depth_image = right_depth_image;
+  _runRegistrationPhase(&DepthFramePointGenerator::_projectDepthRows);
+  if (!_is_depth_registered) {
+    _runRegistrationPhase(&DepthFramePointGenerator::_scatterDepthRows);
   }
+}
+
+void DepthFramePointGenerator::_projectDepthRows(const Index& index_band_) {
+  const int32_t row_begin = index_band_*_number_of_rows_depth/_number_of_bands;
+  const int32_t row_end   = (index_band_+1)*_number_of_rows_depth/_number_of_bands;
+
+  //ds local copies for the inner loops (enables vectorization)
+  const float* rotation    = _depth_to_left_rotation;
+  const float* translation = _depth_to_left_translation;
+  const float& fx = _camera_matrix_left[0];
+  const float& fy = _camera_matrix_left[1];
+  const float& cx = _camera_matrix_left[2];
+  const float& cy = _camera_matrix_left[3];
 
-  _row_map.create(_number_of_rows_image,_number_of_cols_image, CV_16SC1);
-  _row_map=-1;
+  //ds process the depth image row by row
+  for (int32_t r = row_begin; r < row_end; ++r) {
+    const unsigned short* raw_depth = _depth_image.ptr<const unsigned short>(r);
+    const float* rays_x = &_ray_table_x[r*_number_of_cols_depth];
+    const float* rays_y = &_ray_table_y[r*_number_of_cols_depth];
 
-  _col_map.create(_number_of_rows_image,_number_of_cols_image, CV_16SC1);
-  _col_map=-1;
+    //ds if the depth image is already registered we only have to copy the measurements (the bands of both images coincide)
+    if (_is_depth_registered) {
+      cv::Vec3f* space_map_row = _space_map_left_meters.ptr<cv::Vec3f>(r);
+      short* row_map_row       = _row_map.ptr<short>(r);
+      short* col_map_row       = _col_map.ptr<short>(r);
+      for (int32_t c = 0; c < _number_of_cols_depth; ++c) {
+        if (raw_depth[c]) {
+          const float depth_meters = raw_depth[c]*_depth_pixel_to_meters;
+          space_map_row[c] = cv::Vec3f(rays_x[c]*depth_meters, rays_y[c]*depth_meters, depth_meters);
+          row_map_row[c]   = r;
+          col_map_row[c]   = c;
+        }
+      }
+      continue;
+    }
+
+    //ds transform and project the complete row into the left image (branch free, vectorizable)
+    float* buffer_x     = &_buffer_x[r*_number_of_cols_depth];
+    float* buffer_y     = &_buffer_y[r*_number_of_cols_depth];
+    float* buffer_z     = &_buffer_z[r*_number_of_cols_depth];
+    float* buffer_row   = &_buffer_row[r*_number_of_cols_depth];
+    float* buffer_col   = &_buffer_col[r*_number_of_cols_depth];
+    for (int32_t c = 0; c < _number_of_cols_depth; ++c) {
+      const float depth_meters = raw_depth[c]*_depth_pixel_to_meters;
+      const float x = rays_x[c]*depth_meters;
+      const float y = rays_y[c]*depth_meters;
+      const float x_left = rotation[0]*x+rotation[1]*y+rotation[2]*depth_meters+translation[0];
+      const float y_left = rotation[3]*x+rotation[4]*y+rotation[5]*depth_meters+translation[1];
+      const float z_left = rotation[6]*x+rotation[7]*y+rotation[8]*depth_meters+translation[2];
+      const float inverse_z_left = 1/z_left;
+      buffer_x[c]   = x_left;
+      buffer_y[c]   = y_left;
+      buffer_z[c]   = z_left;
+      buffer_col[c] = fx*x_left*inverse_z_left+cx;
+      buffer_row[c] = fy*y_left*inverse_z_left+cy;
+    }
 
-  const Matrix3 inverse_camera_matrix_right=_camera_right->cameraMatrix().inverse();
-  const float _depth_pixel_to_meters=1e-3;
+    //ds round to the left image pixels, invalidate measurements outside of the left image and determine the range of rows hit by this row
+    int32_t& destination_row_minimum = _destination_row_minimum[r];
+    int32_t& destination_row_maximum = _destination_row_maximum[r];
+    destination_row_minimum = _number_of_rows_image;
+    destination_row_maximum = -1;
+    for (int32_t c = 0; c < _number_of_cols_depth; ++c) {
 
-  TransformMatrix3D right_to_left_transform=_camera_left->robotToCamera()*_camera_right->cameraToRobot();
-  for (int32_t r=0; r<_number_of_rows_image; ++r){
-    const unsigned short* raw_depth=right_depth_image.ptr<const unsigned short>(r);
-    for (int32_t c=0; c<_number_of_cols_image; ++c, raw_depth++){
-      if (!*raw_depth)
+      //ds skip invalid measurements and points behind the camera
+      if (!raw_depth[c] || buffer_z[c] <= 0) {
+        buffer_row[c] = -1;
         continue;
-      // retrieve depth
-      const float depth_right_meters=(*raw_depth)*_depth_pixel_to_meters;
-      // retrieve point in right camers, meters
-      Vector3 point_in_right_camera_meters=inverse_camera_matrix_right*Vector3(c*depth_right_meters, r*depth_right_meters,depth_right_meters);
-      // map the point to the left camera
-      Vector3 point_in_left_camera_meters=right_to_left_transform*point_in_right_camera_meters;
-      // if beyond camera, discard
-      const real depth_left_meters=point_in_left_camera_meters.z();
-      if (depth_left_meters<=0)
+      }
+      const int32_t dest_r = std::round(buffer_row[c]);
+      const int32_t dest_c = std::round(buffer_col[c]);
+      if (dest_r < 0 || dest_r >= _number_of_rows_image || dest_c < 0 || dest_c >= _number_of_cols_image) {
+        buffer_row[c] = -1;
         continue;
-      // project to image coordinates
-      Vector3 point_in_left_camera_pixels=_camera_left->cameraMatrix()*point_in_left_camera_meters;
-      point_in_left_camera_pixels *= 1./point_in_left_camera_pixels.z();
-
-      // round to int
-      const int32_t dest_r=round(point_in_left_camera_pixels.y());
-      const int32_t dest_c=round(point_in_left_camera_pixels.x());
-
-      // if outside skip
-      if (dest_r<0 ||
-          dest_r>=_number_of_rows_image ||
-          dest_c<0 ||
-          dest_c>=_number_of_cols_image)
+      }
+      buffer_row[c] = dest_r;
+      buffer_col[c] = dest_c;
+      destination_row_minimum = std::min(destination_row_minimum, dest_r);
+      destination_row_maximum = std::max(destination_row_maximum, dest_r);
+    }
+  }
+}
+
+void DepthFramePointGenerator::_scatterDepthRows(const Index& index_band_) {
+  const int32_t row_begin = index_band_*_number_of_rows_image/_number_of_bands;
+  const int32_t row_end   = (index_band_+1)*_number_of_rows_image/_number_of_bands;
+
+  //ds scatter the valid measurements in depth image order (as in a sequential registration, identical results for any band split)
+  for (int32_t r = 0; r < _number_of_rows_depth; ++r) {
+    if (_destination_row_maximum[r] < row_begin || _destination_row_minimum[r] >= row_end) {
+      continue;
+    }
+    const float* buffer_x     = &_buffer_x[r*_number_of_cols_depth];
+    const float* buffer_y     = &_buffer_y[r*_number_of_cols_depth];
+    const float* buffer_z     = &_buffer_z[r*_number_of_cols_depth];
+    const float* buffer_row   = &_buffer_row[r*_number_of_cols_depth];
+    const float* buffer_col   = &_buffer_col[r*_number_of_cols_depth];
+    for (int32_t c = 0; c < _number_of_cols_depth; ++c) {
+      const int32_t dest_r = buffer_row[c];
+      if (dest_r < row_begin || dest_r >= row_end) {
         continue;
+      }
 
-      // do z buffering and update indices
-      cv::Vec3f& dest_space=_space_map_left_meters.at<cv::Vec3f>(dest_r, dest_c);
+      //ds do z buffering and update indices
+      const int32_t dest_c  = buffer_col[c];
+      cv::Vec3f& dest_space = _space_map_left_meters.at<cv::Vec3f>(dest_r, dest_c);
+      if (dest_space[2] > buffer_z[c]) {
+        dest_space = cv::Vec3f(buffer_x[c], buffer_y[c], buffer_z[c]);
+        _row_map.at<short>(dest_r, dest_c) = r;
+        _col_map.at<short>(dest_r, dest_c) = c;
+      }
+    }
+  }
+}
 
-      if (dest_space[2] > depth_left_meters){
-        dest_space=cv::Vec3f(point_in_left_camera_meters.x(),
-                             point_in_left_camera_meters.y(),
-                             point_in_left_camera_meters.z());
-        _row_map.at<unsigned short>(dest_r, dest_c)=r;
-        _col_map.at<unsigned short>(dest_r, dest_c)=c;
+void DepthFramePointGenerator::_runRegistrationPhase(void (DepthFramePointGenerator::*phase_)(const Index&)) {
+  if (_registration_threads.empty()) {
+    (this->*phase_)(0);
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_mutex_registration);
+    _registration_phase = phase_;
+    ++_registration_round;
+    _number_of_registering_threads = _registration_threads.size();
+  }
+  _condition_registration.notify_all();
+  (this->*phase_)(0);
+  std::unique_lock<std::mutex> lock(_mutex_registration);
+  _condition_registration.wait(lock, [this]{return _number_of_registering_threads == 0;});
+}
+
+void DepthFramePointGenerator::_processRegistrations(const Index index_band_, Count round_) {
+  while (true) {
+
+    //ds wait for the next registration phase
+    void (DepthFramePointGenerator::*phase)(const Index&) = nullptr;
+    {
+      std::unique_lock<std::mutex> lock(_mutex_registration);
+      _condition_registration.wait(lock, [this, &round_]{return !_is_registration_running || _registration_round != round_;});
+      if (!_is_registration_running) {
+        return;
       }
+      round_ = _registration_round;
+      phase  = _registration_phase;
+    }
+    (this->*phase)(index_band_);
+
+    //ds report completion to the calling thread
+    {
+      std::lock_guard<std::mutex> lock(_mutex_registration);
+      --_number_of_registering_threads;
+    }
+    _condition_registration.notify_all();
+  }
+}
+
+void DepthFramePointGenerator::_stopRegistration() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex_registration);
+    _is_registration_running = false;
+  }
+  _condition_registration.notify_all();
+  for (std::thread& thread: _registration_threads) {
+    thread.join();
+  }
+  _registration_threads.clear();
+}
+
+void DepthFramePointGenerator::_computeDepthMapSparse(const cv::Mat& right_depth_image, const std::vector<cv::KeyPoint>& keypoints_left_) {
+  if (right_depth_image.type() != CV_16UC1) {
+    throw std::runtime_error("DepthFramePointGenerator::_computeDepthMapSparse|depth tracker requires a 16bit mono image to encode depth");
+  }
+  if (right_depth_image.rows != _number_of_rows_depth || right_depth_image.cols != _number_of_cols_depth) {
+    throw std::runtime_error("DepthFramePointGenerator::_computeDepthMapSparse|depth image dimensions do not match the depth camera");
+  }
+
+  //ds reset only the pixels registered in the previous call (the complete map if it has been registered fully)
+  if (_is_depth_map_sparse) {
+    for (const Index& index: _registered_pixels) {
+      const int32_t row = index/_number_of_cols_image;
+      const int32_t col = index%_number_of_cols_image;
+      _space_map_left_meters.at<cv::Vec3f>(row, col) = cv::Vec3f(0, 0, _maximum_reliable_depth_far_meters);
+      _row_map.at<short>(row, col) = -1;
+      _col_map.at<short>(row, col) = -1;
     }
+  } else {
+    _space_map_left_meters.setTo(cv::Scalar(0, 0, _maximum_reliable_depth_far_meters));
+    _row_map = -1;
+    _col_map = -1;
+  }
+  _registered_pixels.clear();
+  _is_depth_map_sparse = true;
+
+  //ds invalidate all neighborhoods of the previous depth image
+  _depth_image = right_depth_image;
+  ++_registration_stamp;
+
+  //ds register the depth measurements around each keypoint
+  for (const cv::KeyPoint& keypoint: keypoints_left_) {
+    _registerNeighborhood(keypoint.pt.y, keypoint.pt.x);
+  }
+}
+
+void DepthFramePointGenerator::_registerNeighborhood(const int32_t& row_left_, const int32_t& col_left_) {
+
+  //ds skip neighborhoods that have already been registered for the current depth image
+  const Index index_center = row_left_*_number_of_cols_image+col_left_;
+  if (_neighborhood_stamps[index_center] == _registration_stamp) {
+    return;
+  }
+  _neighborhood_stamps[index_center] = _registration_stamp;
+
+  //ds if the depth image is registered the neighborhood is identical in both images
+  int32_t row_depth = row_left_;
+  int32_t col_depth = col_left_;
+  int32_t radius    = _parameters->sparse_registration_radius_pixels;
+  if (!_is_depth_registered) {
+
+    //ds map the pixel into the depth image (infinite depth), the parallax is covered by the enlarged radius
+    const Vector3 pixel_in_depth(_left_to_depth_homography*Vector3(col_left_, row_left_, 1));
+    if (pixel_in_depth.z() <= 0) {
+      return;
+    }
+    row_depth = std::round(pixel_in_depth.y()/pixel_in_depth.z());
+    col_depth = std::round(pixel_in_depth.x()/pixel_in_depth.z());
+    radius    = _sparse_registration_radius_depth_pixels;
+  }
+
+  //ds register all depth pixels in the neighborhood
+  const int32_t row_start = std::max(row_depth-radius, 0);
+  const int32_t row_end   = std::min(row_depth+radius+1, _number_of_rows_depth);
+  const int32_t col_start = std::max(col_depth-radius, 0);
+  const int32_t col_end   = std::min(col_depth+radius+1, _number_of_cols_depth);
+  for (int32_t r = row_start; r < row_end; ++r) {
+    for (int32_t c = col_start; c < col_end; ++c) {
+      _registerDepthPixel(r, c);
+    }
+  }
+}
+
+void DepthFramePointGenerator::_registerDepthPixel(const int32_t& row_depth_, const int32_t& col_depth_) {
+  const unsigned short& raw_depth = _depth_image.at<const unsigned short>(row_depth_, col_depth_);
+  if (!raw_depth) {
+    return;
+  }
+
+  //ds retrieve point in depth camera
+  const Index index_depth  = row_depth_*_number_of_cols_depth+col_depth_;
+  const float depth_meters = raw_depth*_depth_pixel_to_meters;
+  const float x = _ray_table_x[index_depth]*depth_meters;
+  const float y = _ray_table_y[index_depth]*depth_meters;
+
+  //ds map the point to the left camera
+  int32_t dest_r = row_depth_;
+  int32_t dest_c = col_depth_;
+  cv::Vec3f point_in_left_camera_meters(x, y, depth_meters);
+  if (!_is_depth_registered) {
+    const float* rotation    = _depth_to_left_rotation;
+    const float* translation = _depth_to_left_translation;
+    point_in_left_camera_meters = cv::Vec3f(rotation[0]*x+rotation[1]*y+rotation[2]*depth_meters+translation[0],
+                                            rotation[3]*x+rotation[4]*y+rotation[5]*depth_meters+translation[1],
+                                            rotation[6]*x+rotation[7]*y+rotation[8]*depth_meters+translation[2]);
+    if (point_in_left_camera_meters[2] <= 0) {
+      return;
+    }
+    dest_c = std::round(_camera_matrix_left[0]*point_in_left_camera_meters[0]/point_in_left_camera_meters[2]+_camera_matrix_left[2]);
+    dest_r = std::round(_camera_matrix_left[1]*point_in_left_camera_meters[1]/point_in_left_camera_meters[2]+_camera_matrix_left[3]);
+    if (dest_r < 0 || dest_r >= _number_of_rows_image || dest_c < 0 || dest_c >= _number_of_cols_image) {
+      return;
+    }
+  }
+
+  //ds do z buffering and update indices
+  cv::Vec3f& dest_space = _space_map_left_meters.at<cv::Vec3f>(dest_r, dest_c);
+  if (dest_space[2] > point_in_left_camera_meters[2]) {
+
+    //ds remember the pixel for the next reset if it was not registered yet
+    if (_row_map.at<short>(dest_r, dest_c) == -1) {
+      _registered_pixels.push_back(dest_r*_number_of_cols_image+dest_c);
+    }
+    dest_space = point_in_left_camera_meters;
+    _row_map.at<short>(dest_r, dest_c) = row_depth_;
+    _col_map.at<short>(dest_r, dest_c) = col_depth_;
   }
 }
 
 void DepthFramePointGenerator::initialize(Frame* frame_, const bool& extract_features_) {
-  //ds TODO
+  if (!frame_) {
+    throw std::runtime_error("DepthFramePointGenerator::initialize|called with empty frame");
+  }
+
+  //ds check if a new feature extraction is desired (the frame might already be set up)
+  if (extract_features_) {
+
+    //ds detect new features to generate frame points from (fixed thresholds)
+    detectKeypoints(frame_->intensityImageLeft(), frame_->keypointsLeft());
+
+    //ds adjust detector thresholds for next frame
+    adjustDetectorThresholds();
+    _number_of_detected_keypoints         = frame_->keypointsLeft().size();
+    frame_->_number_of_detected_keypoints = _number_of_detected_keypoints;
+
+    //ds extract descriptors for detected features
+    computeDescriptors(frame_->intensityImageLeft(), frame_->keypointsLeft(), frame_->descriptorsLeft());
+    LOG_DEBUG(std::cerr << "DepthFramePointGenerator::initialize|extracted features: " << frame_->keypointsLeft().size() << std::endl)
+
+    //ds register the depth image in the intensity image (once per frame, the depth map is reused for tracking, recovery and new points)
+    CHRONOMETER_START(depth_map_generation)
+    //ds sparse registration falls back to the full one if the keypoint neighborhoods cover more pixels than the depth image
+    if (_enable_sparse_registration &&
+        frame_->keypointsLeft().size()*_number_of_depth_pixels_per_neighborhood < _ray_table_x.size()) {
+      _computeDepthMapSparse(frame_->intensityImageRight(), frame_->keypointsLeft());
+    } else {
+      _computeDepthMap(frame_->intensityImageRight());
+    }
+    CHRONOMETER_STOP(depth_map_generation)
+  }
+
+  //ds initialize matcher for the intensity image
+  _feature_matcher_left.setFeatures(frame_->keypointsLeft(), frame_->descriptorsLeft());
 }
 
-//ds computes framepoints stored in a image-like matrix (_framepoints_in_image) for provided stereo images
-void DepthFramePointGenerator::compute(Frame* frame_) {
-  assert(frame_->intensityImageRight().type() == CV_16UC1);
+void DepthFramePointGenerator::track(Frame* frame_,
+                                     Frame* frame_previous_,
+                                     const TransformMatrix3D& camera_left_previous_in_current_,
+                                     FramePointPointerVector& previous_framepoints_without_tracks_,
+                                     const bool track_by_appearance_) {
+  if (!frame_ || !frame_previous_) {
+    throw std::runtime_error("DepthFramePointGenerator::track|called with invalid frames");
+  }
+  frame_->clear();
+  const Matrix3& camera_calibration_matrix = _camera_left->cameraMatrix();
+  FramePointPointerVector& framepoints(frame_->points());
+  FramePointPointerVector& framepoints_previous(frame_previous_->points());
 
-  //ds detect new features
-  detectKeypoints(frame_->intensityImageLeft(), frame_->keypointsLeft());
+  //ds allocate space, existing framepoints will be overwritten!
+  framepoints.resize(framepoints_previous.size());
 
-  CHRONOMETER_START(depth_map_generation)
-  _computeDepthMap(frame_->intensityImageRight());
-  CHRONOMETER_STOP(depth_map_generation)
+  //ds store points for which we couldn't find a track candidate
+  previous_framepoints_without_tracks_.resize(framepoints_previous.size());
+  Count number_of_points       = 0;
+  Count number_of_points_lost  = 0;
+  _number_of_tracked_landmarks = 0;
 
-  //ds extract descriptors for detected features
-  computeDescriptors(frame_->intensityImageLeft(), frame_->keypointsLeft(), frame_->descriptorsLeft());
+  //ds for each previous point
+  for (FramePoint* point_previous: framepoints_previous) {
 
-  //ds prepare and execute stereo keypoint search
-  CHRONOMETER_START(depth_assignment)
-  computeCoordinatesFromDepth(frame_, frame_->keypointsLeft(), frame_->descriptorsLeft());
-  CHRONOMETER_STOP(depth_assignment)
+    //ds transform the point into the current camera frame
+    const Vector3 point_in_camera_left_prediction(camera_left_previous_in_current_*point_previous->cameraCoordinatesLeft());
+    if (point_in_camera_left_prediction.z() <= 0) {
+      continue;
+    }
+
+    //ds project the point into the current left image plane
+    const Vector3 point_in_image_left(camera_calibration_matrix*point_in_camera_left_prediction);
+    const int32_t col_projection_left = point_in_image_left.x()/point_in_image_left.z();
+    const int32_t row_projection_left = point_in_image_left.y()/point_in_image_left.z();
+
+    //ds skip point if not in image plane
+    if (col_projection_left < 0 || col_projection_left >= _number_of_cols_image ||
+        row_projection_left < 0 || row_projection_left >= _number_of_rows_image) {
+      continue;
+    }
+
+    //ds define search region (rectangular ROI)
+    const int32_t row_start_point = std::max(row_projection_left-_projection_tracking_distance_pixels, 0);
+    const int32_t row_end_point   = std::min(row_projection_left+_projection_tracking_distance_pixels+1, _number_of_rows_image);
+    const int32_t col_start_point = std::max(col_projection_left-_projection_tracking_distance_pixels, 0);
+    const int32_t col_end_point   = std::min(col_projection_left+_projection_tracking_distance_pixels+1, _number_of_cols_image);
+
+    //ds find the best match for the previous left feature (i.e. track it)
+    real descriptor_distance_best = _parameters->matching_distance_tracking_threshold;
+    IntensityFeature* feature_left = _feature_matcher_left.getMatchingFeatureInRectangularRegion(row_projection_left,
+                                                                                                 col_projection_left,
+                                                                                                 point_previous->descriptorLeft(),
+                                                                                                 row_start_point,
+                                                                                                 row_end_point,
+                                                                                                 col_start_point,
+                                                                                                 col_end_point,
+                                                                                                 _parameters->matching_distance_tracking_threshold,
+                                                                                                 track_by_appearance_,
+                                                                                                 descriptor_distance_best);
+
+    //ds if we found a match - retrieve its depth
+    if (feature_left) {
+      PointCoordinates point_in_camera_left(PointCoordinates::Zero());
+      cv::Point2f image_coordinates_depth;
+      if (getPointInLeftCamera(feature_left->keypoint.pt, point_in_camera_left, image_coordinates_depth)) {
+        cv::KeyPoint keypoint_depth(feature_left->keypoint);
+        keypoint_depth.pt = image_coordinates_depth;
+
+        //ds create a tracked point (the feature remains owned by the matcher)
+        FramePoint* framepoint = frame_->createFramepoint(feature_left->keypoint,
+                                                          feature_left->descriptor,
+                                                          keypoint_depth,
+                                                          feature_left->descriptor,
+                                                          point_in_camera_left,
+                                                          point_previous);
+        framepoint->setDescriptorDistanceTriangulation(descriptor_distance_best);
+
+        //ds VISUALIZATION ONLY
+        framepoint->setProjectionEstimateLeft(cv::Point2f(col_projection_left, row_projection_left));
+
+        //ds store and move to next slot
+        framepoints[number_of_points] = framepoint;
+        ++number_of_points;
+
+        //ds remove feature from lattice (blocks it for further tracking and for new point creation in compute)
+        _feature_matcher_left.feature_lattice[feature_left->row][feature_left->col] = nullptr;
+        if (framepoint->landmark()) {
+          ++_number_of_tracked_landmarks;
+        }
+      }
+    }
+
+    //ds if we couldn't track the point
+    if (!point_previous->next()) {
+      previous_framepoints_without_tracks_[number_of_points_lost] = point_previous;
+      ++number_of_points_lost;
+    }
+  }
+  framepoints.resize(number_of_points);
+  previous_framepoints_without_tracks_.resize(number_of_points_lost);
+  LOG_DEBUG(std::cerr << "DepthFramePointGenerator::track|tracked points: " << number_of_points
+                      << "/" << framepoints_previous.size() << " (landmarks: " << _number_of_tracked_landmarks << ")" << std::endl)
+  LOG_DEBUG(std::cerr << "DepthFramePointGenerator::track|lost points: " << number_of_points_lost
+                      << "/" << framepoints_previous.size() << std::endl)
+}
+
+void DepthFramePointGenerator::registerDepth(const cv::Point2f& image_coordinates_left_) {
+  const int32_t row = image_coordinates_left_.y;
+  const int32_t col = image_coordinates_left_.x;
+
+  //ds in sparse mode the pixel might not have been registered yet (e.g. for recovered points)
+  if (_is_depth_map_sparse && row >= 0 && row < _number_of_rows_image && col >= 0 && col < _number_of_cols_image) {
+    _registerNeighborhood(row, col);
+  }
+}
+
+const bool DepthFramePointGenerator::getPointInLeftCamera(const cv::Point2f& image_coordinates_left_,
+                                                          PointCoordinates& point_in_left_camera_,
+                                                          cv::Point2f& image_coordinates_depth_) const {
+  const int32_t row = image_coordinates_left_.y;
+  const int32_t col = image_coordinates_left_.x;
+  if (row < 0 || row >= _number_of_rows_image || col < 0 || col >= _number_of_cols_image) {
+    return false;
+  }
+
+  //ds the registered depth map contains holes if the depth camera has a lower resolution or a baseline to the intensity camera
+  //ds if the center pixel is invalid we pick the closest measurement in the direct neighborhood (consistent with the z-buffering)
+  int32_t row_best = row;
+  int32_t col_best = col;
+  if (_space_map_left_meters.at<const cv::Vec3f>(row, col)[2] >= _maximum_reliable_depth_far_meters) {
+    float depth_best = _maximum_reliable_depth_far_meters;
+    row_best = -1;
+    for (int32_t r = std::max(row-1, 0); r <= std::min(row+1, _number_of_rows_image-1); ++r) {
+      for (int32_t c = std::max(col-1, 0); c <= std::min(col+1, _number_of_cols_image-1); ++c) {
+        const float& depth_meters = _space_map_left_meters.at<const cv::Vec3f>(r, c)[2];
+        if (depth_meters < depth_best) {
+          depth_best = depth_meters;
+          row_best   = r;
+          col_best   = c;
+        }
+      }
+    }
+
+    //ds no valid depth measurement available
+    if (row_best == -1) {
+      return false;
+    }
+  }
+
+  //ds set measurement
+  const cv::Vec3f& point = _space_map_left_meters.at<const cv::Vec3f>(row_best, col_best);
+  point_in_left_camera_      = PointCoordinates(point[0], point[1], point[2]);
+  image_coordinates_depth_.x = _col_map.at<short>(row_best, col_best);
+  image_coordinates_depth_.y = _row_map.at<short>(row_best, col_best);
+  return true;
 }
 
-//ds computes all potential stereo keypoints (exhaustive in matching distance) and stores them as framepoints (called within compute)
-void DepthFramePointGenerator::computeCoordinatesFromDepth(Frame* frame_, std::vector<cv::KeyPoint>& keypoints_, cv::Mat& descriptors_) {
-  _number_of_available_points = 0;
-  frame_->points().resize(keypoints_.size());
+//ds computes framepoints for the remaining features (not tracked) with a valid depth measurement
+void DepthFramePointGenerator::compute(Frame* frame_) {
+  if (!frame_) {
+    throw std::runtime_error("DepthFramePointGenerator::compute|called with empty frame");
+  }
+  assert(frame_->intensityImageRight().type() == CV_16UC1);
+  CHRONOMETER_START(depth_assignment)
+  FramePointPointerVector& framepoints(frame_->points());
+  const Count number_of_points_tracked = framepoints.size();
+
+  //ds store already present points for optional binning
+  if (_parameters->enable_keypoint_binning) {
+    for (FramePoint* point: framepoints) {
+      const Index row_bin = std::rint(static_cast<real>(point->row)/_parameters->bin_size_pixels);
+      const Index col_bin = std::rint(static_cast<real>(point->col)/_parameters->bin_size_pixels);
+      _bin_map_left[row_bin][col_bin] = point;
+    }
+  }
 
-  for (size_t i=0; i<keypoints_.size(); i++) {
-    const cv::KeyPoint & keypoint_left=keypoints_[i];
-    const cv::Mat& descriptor_left=descriptors_.row(i);
-    const Index r_left=keypoint_left.pt.y;
-    const Index c_left=keypoint_left.pt.x;
-    const cv::Vec3f& p=_space_map_left_meters.at<const cv::Vec3f>(r_left, c_left);
-    if (p[2]>=_maximum_reliable_depth_far_meters)
+  //ds new framepoints - optionally filtered in a consecutive binning
+  const IntensityFeaturePointerVector& features_left(_feature_matcher_left.feature_vector);
+  FramePointPointerVector framepoints_new(features_left.size());
+  Count number_of_new_points = 0;
+  for (const IntensityFeature* feature_left: features_left) {
+
+    //ds skip features that have been consumed by tracking
+    if (_feature_matcher_left.feature_lattice[feature_left->row][feature_left->col] != feature_left) {
       continue;
+    }
 
+    //ds skip features without a valid depth measurement
+    PointCoordinates point_in_camera_left(PointCoordinates::Zero());
+    cv::Point2f image_coordinates_depth;
+    if (!getPointInLeftCamera(feature_left->keypoint.pt, point_in_camera_left, image_coordinates_depth)) {
+      continue;
+    }
+    cv::KeyPoint keypoint_depth(feature_left->keypoint);
+    keypoint_depth.pt = image_coordinates_depth;
+
+    //ds compute a new framepoint without track
+    FramePoint* framepoint = frame_->createFramepoint(feature_left->keypoint,
+                                                      feature_left->descriptor,
+                                                      keypoint_depth,
+                                                      feature_left->descriptor,
+                                                      point_in_camera_left);
+
+    //ds store point for optional binning
+    if (_parameters->enable_keypoint_binning) {
+      const Index row_bin = std::rint(static_cast<real>(feature_left->row)/_parameters->bin_size_pixels);
+      const Index col_bin = std::rint(static_cast<real>(feature_left->col)/_parameters->bin_size_pixels);
+
+      //ds if there is already a point in the bin
+      if (_bin_map_left[row_bin][col_bin]) {
 
-    cv::KeyPoint keypoint_right=keypoint_left;
-    keypoint_right.pt.x=_col_map.at<short>(r_left,c_left);
-    keypoint_right.pt.y=_row_map.at<short>(r_left,c_left);
+        //ds if the point in the bin is not tracked, we prefer closer points (= more accurate depth measurement)
+        if (!_bin_map_left[row_bin][col_bin]->previous() &&
+            framepoint->depthMeters() < _bin_map_left[row_bin][col_bin]->depthMeters()) {
 
-    const PointCoordinates camera_coordinates=PointCoordinates(p[0], p[1], p[2]); // compute
+          //ds overwrite the entry
+          _bin_map_left[row_bin][col_bin] = framepoint;
+        }
+      } else {
 
-    //ds add to framepoint map
-    frame_->points()[_number_of_available_points] = frame_->createFramepoint(keypoint_left,
-                                                                             descriptor_left,
-                                                                             keypoint_right,
-                                                                             descriptor_left,
-                                                                             camera_coordinates);
-    ++_number_of_available_points;
+        //ds add a new entry
+        _bin_map_left[row_bin][col_bin] = framepoint;
+      }
+    }
+
+    //ds set point to buffer
+    framepoints_new[number_of_new_points] = framepoint;
+    ++number_of_new_points;
   }
-  frame_->points().resize(_number_of_available_points);
+  framepoints_new.resize(number_of_new_points);
+  LOG_DEBUG(std::cerr << "DepthFramePointGenerator::compute|number of new depth points: " << number_of_new_points << std::endl)
+
+  //ds update framepoints - checking for the available points to optionally disable binning in very sparse scenarios
+  const real available_point_ratio = static_cast<real>(number_of_points_tracked+framepoints_new.size())/_target_number_of_keypoints;
+  if (_parameters->enable_keypoint_binning && available_point_ratio > 0.1) {
+
+    //ds reserve space for the best case (all points can be added)
+    Count number_of_points_binned = number_of_points_tracked;
+    framepoints.resize(number_of_points_tracked+number_of_new_points);
+
+    //ds accumulate new points over bin grid
+    for (Index row = 0; row < _number_of_rows_bin; ++row) {
+      for (Index col = 0; col < _number_of_cols_bin; ++col) {
+        if (_bin_map_left[row][col] && !_bin_map_left[row][col]->previous()) {
+          framepoints[number_of_points_binned] = _bin_map_left[row][col];
+          ++number_of_points_binned;
+        }
+        _bin_map_left[row][col] = nullptr;
+      }
+    }
+    framepoints.resize(number_of_points_binned);
+    LOG_DEBUG(std::cerr << "DepthFramePointGenerator::compute|number of new depth points binned: " << number_of_points_binned-number_of_points_tracked << std::endl)
+  } else {
+
+    //ds add all points to frame
+    framepoints.insert(framepoints.end(), framepoints_new.begin(), framepoints_new.end());
+
+    //ds clean up bins if skipped before
+    if (_parameters->enable_keypoint_binning) {
+      LOG_WARNING(std::cerr << "DepthFramePointGenerator::compute|skipped binning due to low point density: " << available_point_ratio << std::endl)
+      for (Index row = 0; row < _number_of_rows_bin; ++row) {
+        for (Index col = 0; col < _number_of_cols_bin; ++col) {
+          _bin_map_left[row][col] = nullptr;
+        }
+      }
+    }
+  }
+  _number_of_available_points = framepoints.size();
+  CHRONOMETER_STOP(depth_assignment)
 }
 }
@@ -1,9 +1,12 @@
 #pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include "base_framepoint_generator.h"
 
 namespace proslam {
 
-//ds this class computes potential framepoints in a stereo image pair by triangulation
+//ds this class computes potential framepoints in a rgb-d image pair by registering the depth image to the intensity image
 class DepthFramePointGenerator: public BaseFramePointGenerator {
 
 //ds object handling
@@ -12,13 +15,39 @@ PROSLAM_MAKE_PROCESSING_CLASS(DepthFramePointGenerator)
 //ds functionality
 public:
 
-  //ds initializes the framepoint generator (e.g. detects keypoints and computes descriptors)
+  //ds initializes the framepoint generator (e.g. detects keypoints, computes descriptors and registers the depth image)
   virtual void initialize(Frame* frame_, const bool& extract_features_ = true);
 
-  //ds computes framepoints stored in a image-like matrix (_framepoints_in_image) for provided stereo images
+  //! @brief computes framepoints for all remaining (untracked) features with a valid depth measurement
+  //! @param[in, out] frame_ frame that will be filled with framepoints
   virtual void compute(Frame* frame_);
 
-  void computeCoordinatesFromDepth(Frame* frame_, std::vector<cv::KeyPoint>& keypoints_, cv::Mat& descriptors_);
+  //! @brief computes first tracks between previous framepoints by projection into the current image
+  //! @brief the depth of a tracked point is taken directly from the registered depth image
+  //! @param[in, out] frame_ frame that will be filled with framepoints and tracks
+  //! @param[in] frame_previous_ previous frame that contains valid framepoints on which we will track
+  //! @param[in] camera_left_previous_in_current_ the relative camera motion guess between frame_ and frame_previous_
+  //! @param[out] previous_points_without_tracks_ lost points
+  void track(Frame* frame_,
+             Frame* frame_previous_,
+             const TransformMatrix3D& camera_left_previous_in_current_,
+             FramePointPointerVector& previous_framepoints_without_tracks_,
+             const bool track_by_appearance_ = true) override;
+
+  //! @brief makes the depth around an image point available for getPointInLeftCamera (e.g. for recovered points)
+  //! @brief in sparse registration mode the neighborhood of the pixel is registered on demand, otherwise this is a no-op
+  //! @param[in] image_coordinates_left_ pixel coordinates in the left (intensity) image
+  void registerDepth(const cv::Point2f& image_coordinates_left_);
+
+  //! @brief retrieves the 3D position of an image point in the left camera frame from the registered depth image
+  //! @brief in sparse registration mode only detected keypoints and pixels passed to registerDepth are available
+  //! @param[in] image_coordinates_left_ pixel coordinates in the left (intensity) image
+  //! @param[out] point_in_left_camera_ point coordinates in the left camera frame
+  //! @param[out] image_coordinates_depth_ corresponding pixel coordinates in the depth image
+  //! @return true if a reliable depth measurement is available in the vicinity of the pixel
+  const bool getPointInLeftCamera(const cv::Point2f& image_coordinates_left_,
+                                  PointCoordinates& point_in_left_camera_,
+                                  cv::Point2f& image_coordinates_depth_) const;
 
 //ds setters/getters
 public:
@@ -27,8 +56,46 @@ public:
 
 protected:
 
+  //! @brief registers the complete depth image in the left image (row-wise, using the precomputed ray table)
+  //! the rows are split over the calling thread and the registration threads, the result does not depend on the number of threads
+  //! @param[in] right_depth_image 16 bit depth image
   void _computeDepthMap(const cv::Mat& right_depth_image);
 
+  //! @brief transforms and projects a band of depth image rows into the left image (first registration phase)
+  //! @param[in] index_band_ band of depth image rows to process (one per thread)
+  void _projectDepthRows(const Index& index_band_);
+
+  //! @brief writes the projected depth measurements falling into a band of left image rows with z-buffering (second registration phase)
+  //! @param[in] index_band_ band of left image rows to fill (one per thread)
+  void _scatterDepthRows(const Index& index_band_);
+
+  //! @brief runs a registration phase on all bands: the calling thread processes the first band, the registration threads the others
+  //! @param[in] phase_ registration phase to run
+  void _runRegistrationPhase(void (DepthFramePointGenerator::*phase_)(const Index&));
+
+  //! @brief registration thread loop: processes its band in each registration phase until stopped
+  //! @param[in] index_band_ band processed by the thread
+  //! @param[in] round_ registration round at launch
+  void _processRegistrations(const Index index_band_, Count round_);
+
+  //! @brief stops and joins the registration threads
+  void _stopRegistration();
+
+  //! @brief registers only the depth measurements around the provided keypoints in the left image
+  //! @param[in] right_depth_image 16 bit depth image
+  //! @param[in] keypoints_left_ detected keypoints in the left image
+  void _computeDepthMapSparse(const cv::Mat& right_depth_image, const std::vector<cv::KeyPoint>& keypoints_left_);
+
+  //! @brief registers the depth measurements in the neighborhood of a single left image pixel (sparse mode)
+  //! @param[in] row_left_ pixel row in the left image
+  //! @param[in] col_left_ pixel col in the left image
+  void _registerNeighborhood(const int32_t& row_left_, const int32_t& col_left_);
+
+  //! @brief maps a single depth image pixel into the left image with z-buffering
+  //! @param[in] row_depth_ pixel row in the depth image
+  //! @param[in] col_depth_ pixel col in the depth image
+  void _registerDepthPixel(const int32_t& row_depth_, const int32_t& col_depth_);
+
 //ds settings
 protected:
 
@@ -36,11 +103,76 @@ protected:
 
   const real _maximum_reliable_depth_far_meters = 5;
 
+  //ds raw depth value to meters
+  const float _depth_pixel_to_meters = 1e-3;
+
   //ds inner memory buffers (operated on in compute)
   cv::Mat _space_map_left_meters; // xyz coordinates of every pixel of the left image in meters
   cv::Mat _row_map;               // row index in the depth image(right) corresponding to the pixel ar [r,c] in left image
   cv::Mat _col_map;               // col index in the depth image(right) corresponding to the pixel ar [r,c] in left image
 
+  //ds depth image dimensions
+  int32_t _number_of_rows_depth = 0;
+  int32_t _number_of_cols_depth = 0;
+
+  //ds precomputed viewing rays (normalized image coordinates) for every pixel of the depth image, row major
+  std::vector<float> _ray_table_x;
+  std::vector<float> _ray_table_y;
+
+  //ds transformed depth points and their left image pixels for the complete depth image, row major (full registration)
+  std::vector<float> _buffer_x;
+  std::vector<float> _buffer_y;
+  std::vector<float> _buffer_z;
+  std::vector<float> _buffer_row;
+  std::vector<float> _buffer_col;
+
+  //ds range of left image rows hit by each depth image row (full registration, bounds the scatter of a row band)
+  std::vector<int32_t> _destination_row_minimum;
+  std::vector<int32_t> _destination_row_maximum;
+
+  //ds registration threads and the current registration round: each band of rows is processed by exactly one thread
+  Count _number_of_bands = 1;
+  std::vector<std::thread> _registration_threads;
+  std::mutex _mutex_registration;
+  std::condition_variable _condition_registration;
+  void (DepthFramePointGenerator::*_registration_phase)(const Index&) = nullptr;
+  Count _registration_round            = 0;
+  Count _number_of_registering_threads = 0;
+  bool _is_registration_running        = false;
+
+  //ds depth camera to left camera transform, flattened in single precision
+  float _depth_to_left_rotation[9];
+  float _depth_to_left_translation[3];
+  float _camera_matrix_left[4]; //ds fx, fy, cx, cy
+
+  //ds set if the depth image is already registered to the left image (same calibration, no relative motion)
+  bool _is_depth_registered = false;
+
+  //ds sparse registration mode
+  bool _enable_sparse_registration = false;
+
+  //ds set if the current depth map has been registered sparsely (sparse mode falls back to full registration if that is cheaper)
+  bool _is_depth_map_sparse = false;
+
+  //ds number of depth pixels registered for all keypoint neighborhoods in sparse mode (upper bound, for the cost comparison)
+  Count _number_of_depth_pixels_per_neighborhood = 0;
+
+  //ds left image to depth image mapping for points at infinity (sparse mode)
+  Matrix3 _left_to_depth_homography = Matrix3::Identity();
+
+  //ds neighborhood radius in the depth image in sparse mode (accounts for the parallax)
+  int32_t _sparse_registration_radius_depth_pixels = 0;
+
+  //ds currently processed depth image (shallow copy)
+  cv::Mat _depth_image;
+
+  //ds left image pixels that have been registered in sparse mode (reset before the next registration)
+  std::vector<Index> _registered_pixels;
+
+  //ds registration stamps for all left image pixels that have been used as a neighborhood center
+  std::vector<Count> _neighborhood_stamps;
+  Count _registration_stamp = 0;
+
 private:
 
   //ds informative only
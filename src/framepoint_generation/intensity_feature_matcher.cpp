@@ -160,4 +160,20 @@ void IntensityFeatureMatcher::prune(const std::set<uint32_t>& matched_indices_)
   }
   feature_vector.resize(number_of_unmatched_elements);
 }
+
+void IntensityFeatureMatcher::prune(const std::set<const IntensityFeature*>& matched_features_) {
+  if (matched_features_.empty()) {
+    return;
+  }
+
+  //ds remove matched features from candidate pools
+  size_t number_of_unmatched_elements = 0;
+  for (size_t index = 0; index < feature_vector.size(); ++index) {
+    if (matched_features_.count(feature_vector[index]) == 0) {
+      feature_vector[number_of_unmatched_elements] = feature_vector[index];
+      ++number_of_unmatched_elements;
+    }
+  }
+  feature_vector.resize(number_of_unmatched_elements);
+}
 } //namespace proslam
@@ -39,6 +39,9 @@ public:
   //ds prunes features from feature vector if existing
   void prune(const std::set<uint32_t>& matched_indices_);
 
+  //ds prunes features from feature vector by address (independent of the current vector ordering)
+  void prune(const std::set<const IntensityFeature*>& matched_features_);
+
 //ds attributes
 public:
 
@@ -139,8 +139,8 @@ void StereoFramePointGenerator::track(Frame* frame_,
     const int32_t row_projection_left = point_in_image_left.y()/point_in_image_left.z();
 
     //ds skip point if not in image plane
-    if (col_projection_left < 0 || col_projection_left > _number_of_cols_image ||
-        row_projection_left < 0 || row_projection_left > _number_of_rows_image) {
+    if (col_projection_left < 0 || col_projection_left >= _number_of_cols_image ||
+        row_projection_left < 0 || row_projection_left >= _number_of_rows_image) {
       continue;
     }
 
@@ -177,8 +177,8 @@ void StereoFramePointGenerator::track(Frame* frame_,
       const int32_t row_projection_right_corrected = point_in_image_right.y()/point_in_image_right.z()-projection_error.y;
 
       //ds skip point if not in image plane
-      if (col_projection_right_corrected < 0 || col_projection_right_corrected > _number_of_cols_image ||
-          row_projection_right_corrected < 0 || row_projection_right_corrected > _number_of_rows_image) {
+      if (col_projection_right_corrected < 0 || col_projection_right_corrected >= _number_of_cols_image ||
+          row_projection_right_corrected < 0 || row_projection_right_corrected >= _number_of_rows_image) {
         continue;
       }
 
@@ -224,7 +224,7 @@ void StereoFramePointGenerator::track(Frame* frame_,
         framepoint->setEpipolarOffset(feature_right->row-feature_left->row);
         framepoint->setDescriptorDistanceTriangulation(descriptor_distance_best);
 
-        //ds VSUALIZATION ONLY
+        //ds VISUALIZATION ONLY
         framepoint->setProjectionEstimateLeft(cv::Point2f(col_projection_left, row_projection_left));
         framepoint->setProjectionEstimateRight(cv::Point2f(point_in_image_right.x()/point_in_image_right.z(), point_in_image_right.y()/point_in_image_right.z()));
         framepoint->setProjectionEstimateRightCorrected(cv::Point2f(col_projection_right_corrected, row_projection_right_corrected));
@@ -265,6 +265,103 @@ void StereoFramePointGenerator::track(Frame* frame_,
                       << "/" << framepoints_previous.size() << std::endl)
 }
 
+Count StereoFramePointGenerator::recover(Frame* frame_,
+                                         const FramePointPointerVector& previous_framepoints_,
+                                         const std::vector<PointCoordinates>& points_in_camera_left_,
+                                         const int32_t& search_distance_pixels_) {
+  if (!frame_ || previous_framepoints_.size() != points_in_camera_left_.size()) {
+    throw std::runtime_error("StereoFramePointGenerator::recover|called with invalid input");
+  }
+  const Matrix3& camera_calibration_matrix = _camera_left->cameraMatrix();
+
+  //ds recovered features (to not consider them in the exhaustive stereo matching)
+  std::set<const IntensityFeature*> matched_features_left;
+  std::set<const IntensityFeature*> matched_features_right;
+  Count number_of_recovered_points = 0;
+
+  //ds for each prediction
+  for (Index index = 0; index < previous_framepoints_.size(); ++index) {
+    FramePoint* point_previous = previous_framepoints_[index];
+    if (points_in_camera_left_[index].z() <= 0) {
+      continue;
+    }
+
+    //ds project the point into the current left image plane
+    const Vector3 point_in_image_left(camera_calibration_matrix*points_in_camera_left_[index]);
+    const int32_t col_projection_left = point_in_image_left.x()/point_in_image_left.z();
+    const int32_t row_projection_left = point_in_image_left.y()/point_in_image_left.z();
+    if (col_projection_left < 0 || col_projection_left >= _number_of_cols_image ||
+        row_projection_left < 0 || row_projection_left >= _number_of_rows_image) {
+      continue;
+    }
+
+    //ds obtain the closest unassigned feature in the left image within the tracking distance
+    real descriptor_distance_best = _parameters->matching_distance_tracking_threshold;
+    IntensityFeature* feature_left = _feature_matcher_left.getMatchingFeatureInRectangularRegion(row_projection_left,
+                                                                                                 col_projection_left,
+                                                                                                 point_previous->descriptorLeft(),
+                                                                                                 std::max(row_projection_left-search_distance_pixels_, 0),
+                                                                                                 std::min(row_projection_left+search_distance_pixels_+1, _number_of_rows_image),
+                                                                                                 std::max(col_projection_left-search_distance_pixels_, 0),
+                                                                                                 std::min(col_projection_left+search_distance_pixels_+1, _number_of_cols_image),
+                                                                                                 _parameters->matching_distance_tracking_threshold,
+                                                                                                 false,
+                                                                                                 descriptor_distance_best);
+    if (!feature_left) {
+      continue;
+    }
+
+    //ds project point into the right image - correcting by the prediction error
+    const cv::Point2f projection_error(col_projection_left-feature_left->keypoint.pt.x, row_projection_left-feature_left->keypoint.pt.y);
+    const Vector3 point_in_image_right(point_in_image_left+_baseline);
+    const int32_t col_projection_right_corrected = point_in_image_right.x()/point_in_image_right.z()-projection_error.x;
+    const int32_t row_projection_right_corrected = point_in_image_right.y()/point_in_image_right.z()-projection_error.y;
+    if (col_projection_right_corrected < 0 || col_projection_right_corrected >= _number_of_cols_image ||
+        row_projection_right_corrected < 0 || row_projection_right_corrected >= _number_of_rows_image) {
+      continue;
+    }
+
+    //ds obtain matching feature in right image on the epipolar range, to the left of the left feature
+    const int32_t epipolar_offset = std::max(std::abs(point_previous->epipolarOffset()), _maximum_epipolar_search_offset_pixels);
+    IntensityFeature* feature_right = _feature_matcher_right.getMatchingFeatureInRectangularRegion(row_projection_right_corrected,
+                                                                                                   col_projection_right_corrected,
+                                                                                                   feature_left->descriptor,
+                                                                                                   std::max(row_projection_right_corrected-epipolar_offset, 0),
+                                                                                                   std::min(row_projection_right_corrected+epipolar_offset+1, _number_of_rows_image),
+                                                                                                   std::max(col_projection_right_corrected-search_distance_pixels_, 0),
+                                                                                                   std::min(col_projection_right_corrected+search_distance_pixels_+1, feature_left->col),
+                                                                                                   _current_maximum_descriptor_distance_triangulation,
+                                                                                                   true,
+                                                                                                   descriptor_distance_best);
+    if (!feature_right || feature_left->col-feature_right->col < _parameters->minimum_disparity_pixels) {
+      continue;
+    }
+
+    //ds create a stereo match continuing the previous track
+    FramePoint* framepoint = frame_->createFramepoint(feature_left,
+                                                      feature_right,
+                                                      getPointInLeftCamera(feature_left->keypoint.pt, feature_right->keypoint.pt),
+                                                      point_previous);
+    framepoint->setEpipolarOffset(feature_right->row-feature_left->row);
+    framepoint->setDescriptorDistanceTriangulation(descriptor_distance_best);
+    frame_->points().push_back(framepoint);
+    ++number_of_recovered_points;
+
+    //ds remove features from lattices and block them for exhaustive matching
+    matched_features_left.insert(feature_left);
+    matched_features_right.insert(feature_right);
+    _feature_matcher_left.feature_lattice[feature_left->row][feature_left->col]    = nullptr;
+    _feature_matcher_right.feature_lattice[feature_right->row][feature_right->col] = nullptr;
+  }
+
+  //ds remove matched features from candidate pools
+  _feature_matcher_left.prune(matched_features_left);
+  _feature_matcher_right.prune(matched_features_right);
+  LOG_DEBUG(std::cerr << "StereoFramePointGenerator::recover|recovered points: " << number_of_recovered_points
+                      << "/" << previous_framepoints_.size() << std::endl)
+  return number_of_recovered_points;
+}
+
 const PointCoordinates StereoFramePointGenerator::getPointInLeftCamera(const cv::Point2f& image_coordinates_left_, const cv::Point2f& image_coordinates_right_) const {
   assert(image_coordinates_left_.x >= image_coordinates_right_.x);
   assert(image_coordinates_left_.x-image_coordinates_right_.x >= _parameters->minimum_disparity_pixels);
@@ -31,6 +31,17 @@ public:
              FramePointPointerVector& previous_framepoints_without_tracks_,
              const bool track_by_appearance_ = true) override;
 
+  //! @brief continues framepoint tracks from older frames by matching their predicted projections against the features left unassigned by track
+  //! @param[in, out] frame_ frame to which recovered framepoints are added
+  //! @param[in] previous_framepoints_ framepoints to continue (e.g. last measurements of landmarks without track)
+  //! @param[in] points_in_camera_left_ predicted coordinates of the previous framepoints in the current left camera
+  //! @param[in] search_distance_pixels_ half size of the search window around the predicted projections
+  //! @return number of recovered framepoints
+  Count recover(Frame* frame_,
+                const FramePointPointerVector& previous_framepoints_,
+                const std::vector<PointCoordinates>& points_in_camera_left_,
+                const int32_t& search_distance_pixels_);
+
   //ds computes 3D position of a stereo keypoint pair in the keft camera frame
   const PointCoordinates getPointInLeftCamera(const cv::Point2f& image_coordinates_left_, const cv::Point2f& image_coordinates_right_) const;
 
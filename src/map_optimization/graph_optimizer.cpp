@@ -26,6 +26,7 @@ GraphOptimizer::GraphOptimizer(GraphOptimizerParameters* parameters_): _paramete
 
 void GraphOptimizer::configure() {
   LOG_INFO(std::cerr << "GraphOptimizer::configure|configuring" << std::endl)
+  _stop();
 
   //ds solver setup
   g2o::OptimizationAlgorithm* solver = nullptr;
@@ -75,6 +76,15 @@ void GraphOptimizer::configure() {
     ALLOCATE_SOLVER(OptimizerLevenberg, LinearSolverCSparseVariable, BlockSolverVariable)
   }
 
+  //ds pose graph solver backend
+  if (_parameters->pose_graph_solver == "NATIVE") {
+    _is_pose_graph_solver_native = true;
+  } else if (_parameters->pose_graph_solver == "G2O") {
+    _is_pose_graph_solver_native = false;
+  } else {
+    throw std::runtime_error("GraphOptimizer::configure|unknown pose graph solver: " + _parameters->pose_graph_solver);
+  }
+
   //ds if we couldn't allocate a solver
   if (!solver) {
 
@@ -84,16 +94,49 @@ void GraphOptimizer::configure() {
 
   //ds allocate optimizer (deleting a previous one)
   if (_optimizer) {delete _optimizer;}
+  if (_terminate_action) {delete _terminate_action;}
+  _terminate_action = nullptr;
   _optimizer = new g2o::SparseOptimizer();
 
   //ds set the solver
   _optimizer->setAlgorithm(solver);
 
+  //ds incremental optimization stops iterating once converged
+  if (_parameters->enable_incremental_optimization) {
+    _terminate_action = new g2o::SparseOptimizerTerminateAction();
+    _terminate_action->setGainThreshold(_parameters->minimum_relative_gain_for_termination);
+    _optimizer->addPostIterationAction(_terminate_action);
+  }
+
   //ds clean bookkeeping
   _vertex_frame_last_added = 0;
   _frames_in_pose_graph.clear();
+  _odometry_edges_in_pose_graph.clear();
   _local_maps_in_graph.clear();
   _landmarks_in_pose_graph.clear();
+  _frames_pending.clear();
+  _closures_pending.clear();
+  _frames_handed_over.clear();
+  _closures_handed_over.clear();
+  _frame_last_handed_over = nullptr;
+  _local_maps_handed_over.clear();
+  _poses_optimized.clear();
+  _poses_optimized_published.clear();
+  _is_optimizing = false;
+  _has_result    = false;
+  _pose_graph_solver.clear();
+  _frames_in_pose_graph_solver.clear();
+  _vertex_indices_in_pose_graph_solver.clear();
+  _odometry_edge_indices_in_pose_graph_solver.clear();
+  _index_vertex_frame_last_added = 0;
+  _keyframe_last_added = nullptr;
+  _information_factor_since_keyframe = _parameters->base_information_frame;
+  _frames_since_keyframe.clear();
+  _frames_attached.clear();
+  _frame_relocalized = nullptr;
+  _keyframe_relocalization_reference = nullptr;
+  _frame_last_added = nullptr;
+  _closures_to_anchor.clear();
 
   //ds clean pose graph
   _optimizer->clear();
@@ -103,13 +146,59 @@ void GraphOptimizer::configure() {
   g2o::ParameterSE3Offset* parameter_world_offset = new g2o::ParameterSE3Offset();
   parameter_world_offset->setId(G2oParameter::WORLD_OFFSET);
   _optimizer->addParameter(parameter_world_offset);
+
+  //ds allocate the local bundle adjustment optimizer: fixed pose and point blocks with marginalized landmarks
+  if (_optimizer_local) {delete _optimizer_local;}
+  _optimizer_local = nullptr;
+  if (_parameters->enable_local_bundle_adjustment) {
+    solver = nullptr;
+    if (_parameters->optimization_algorithm == "GAUSS_NEWTON" && _parameters->linear_solver_type == "CHOLMOD") {
+      ALLOCATE_SOLVER(OptimizerGaussNewton, LinearSolverCholmod6x3, BlockSolver6x3)
+    } else if (_parameters->optimization_algorithm == "GAUSS_NEWTON" && _parameters->linear_solver_type == "CSPARSE") {
+      ALLOCATE_SOLVER(OptimizerGaussNewton, LinearSolverCSparse6x3, BlockSolver6x3)
+    } else if (_parameters->optimization_algorithm == "LEVENBERG" && _parameters->linear_solver_type == "CHOLMOD") {
+      ALLOCATE_SOLVER(OptimizerLevenberg, LinearSolverCholmod6x3, BlockSolver6x3)
+    } else if (_parameters->optimization_algorithm == "LEVENBERG" && _parameters->linear_solver_type == "CSPARSE") {
+      ALLOCATE_SOLVER(OptimizerLevenberg, LinearSolverCSparse6x3, BlockSolver6x3)
+    }
+    if (!solver) {
+      throw std::runtime_error("GraphOptimizer::configure|unable to set local bundle adjustment solver, please check configuration");
+    }
+    _optimizer_local = new g2o::SparseOptimizer();
+    _optimizer_local->setAlgorithm(solver);
+    _optimizer_local->setVerbose(false);
+    g2o::ParameterSE3Offset* parameter_world_offset_local = new g2o::ParameterSE3Offset();
+    parameter_world_offset_local->setId(G2oParameter::WORLD_OFFSET);
+    _optimizer_local->addParameter(parameter_world_offset_local);
+
+    //ds preallocate the window bookkeeping
+    const Count number_of_local_maps = _parameters->number_of_local_maps_for_local_bundle_adjustment;
+    _local_maps_in_window.reserve(number_of_local_maps);
+    _vertices_local_maps_in_window.reserve(number_of_local_maps);
+  }
+  _local_maps_in_window.clear();
+  _vertices_local_maps_in_window.clear();
+  _landmarks_in_window.clear();
+  _vertices_landmarks_in_window.clear();
+  _landmark_indices_in_window.clear();
+
+  //ds launch optimizer thread if desired
+  if (_parameters->enable_asynchronous_optimization) {
+    _is_running = true;
+    _worker     = std::thread(&GraphOptimizer::_processQueue, this);
+  }
   LOG_INFO(std::cerr << "GraphOptimizer::configure|allocated optimization algorithm: " << _parameters->optimization_algorithm
-                     << " with solver: " << _parameters->linear_solver_type << std::endl)
+                     << " with solver: " << _parameters->linear_solver_type
+                     << " (pose graph solver: " << _parameters->pose_graph_solver << ")"
+                     << " (incremental: " << _parameters->enable_incremental_optimization
+                     << " asynchronous: " << _parameters->enable_asynchronous_optimization
+                     << " keyframes only: " << _parameters->enable_keyframe_pose_graph << ")" << std::endl)
   LOG_INFO(std::cerr << "GraphOptimizer::configure|configured" << std::endl)
 }
 
 GraphOptimizer::~GraphOptimizer(){
   LOG_INFO(std::cerr << "GraphOptimizer::~GraphOptimizer|destroying" << std::endl)
+  _stop();
   _frames_in_pose_graph.clear();
   _landmarks_in_pose_graph.clear();
   if (_optimizer) {
@@ -117,6 +206,12 @@ GraphOptimizer::~GraphOptimizer(){
     _optimizer->clearParameters();
     delete _optimizer;
   }
+  delete _terminate_action;
+  if (_optimizer_local) {
+    _optimizer_local->clear();
+    _optimizer_local->clearParameters();
+    delete _optimizer_local;
+  }
   LOG_INFO(std::cerr << "GraphOptimizer::~GraphOptimizer|destroyed" << std::endl)
 }
 
@@ -225,48 +320,84 @@ void GraphOptimizer::writePoseGraphToFile(const WorldMap* world_map_, const std:
 
 void GraphOptimizer::addFrame(Frame* frame_) {
   CHRONOMETER_START(addition)
+  _frame_last_added = frame_;
 
-  //ds get the frames pose to g2o representation
-  g2o::VertexSE3* vertex_frame_current = new g2o::VertexSE3();
-  vertex_frame_current->setId(frame_->identifier());
-  vertex_frame_current->setEstimate(frame_->robotToWorld().cast<double>());
-  _optimizer->addVertex(vertex_frame_current);
+  //ds compute information value based on landmark content
+  real information_factor = _parameters->base_information_frame;
 
-  //ds if its the first frame to be added (start or recently cleared pose graph)
-  if (!_vertex_frame_last_added) {
+  //ds adjust information value according to frame state
+  if (frame_->isTrackBroken()) {
 
-    //ds fix the initial vertex - no measurement to add
-    vertex_frame_current->setFixed(true);
-  } else {
+    //ds set minimum information
+    information_factor = 1;
+  }
+  if (frame_->status() == Frame::Localizing) {
 
-    //ds compute information value based on landmark content
-    real information_factor = _parameters->base_information_frame;
+    //ds reduce information value (we don't have landmarks in a localizing frame)
+    information_factor = _parameters->base_information_frame/10;
+  }
 
-    //ds adjust information value according to frame state
-    if (frame_->isTrackBroken()) {
+  //ds tie a relocalized frame to its reference keyframe once it enters the graph (in keyframe mode the next keyframe carries the constraint)
+  if (_frame_relocalized) {
+    if (frame_ != _frame_relocalized && frame_->isTrackBroken()) {
+
+      //ds the track broke again before the constraint could be integrated
+      _frame_relocalized = nullptr;
+    } else if (!_parameters->enable_keyframe_pose_graph || frame_->isKeyframe()) {
+      _closures_pending.push_back(PendingClosure(frame_,
+                                                 _keyframe_relocalization_reference,
+                                                 _frame_relocalized_to_reference*_frame_relocalized->worldToRobot()*frame_->robotToWorld(),
+                                                 _parameters->base_information_frame));
+      _frame_relocalized = nullptr;
+    }
+  }
 
-      //ds set minimum information
-      information_factor = 1;
+  //ds in keyframe mode the frames between keyframes do not enter the graph
+  if (_parameters->enable_keyframe_pose_graph) {
+    _information_factor_since_keyframe = std::min(_information_factor_since_keyframe, information_factor);
+    if (!frame_->isKeyframe()) {
+      _frames_since_keyframe.push_back(frame_);
+      CHRONOMETER_STOP(addition)
+      return;
     }
-    if (frame_->status() == Frame::Localizing) {
 
-      //ds reduce information value (we don't have landmarks in a localizing frame)
-      information_factor = _parameters->base_information_frame/10;
+    //ds frames that did not end up in a local map (the window was dropped at a track break) follow the preceeding keyframe
+    if (_keyframe_last_added) {
+      for (Frame* frame: _frames_since_keyframe) {
+        if (!frame->localMap()) {
+          _frames_attached[_keyframe_last_added].push_back(AttachedFrame(frame, _keyframe_last_added));
+        }
+      }
     }
+    _frames_since_keyframe.clear();
 
-    //ds we can connect it to the preceeding frame by adding the odometry measurement
-    _setPoseEdge(_optimizer,
-                vertex_frame_current,
-                _vertex_frame_last_added,
-                frame_->previous()->worldToRobot()*frame_->robotToWorld(),
-                information_factor,
-                _parameters->free_translation_for_poses,
-                _parameters->enable_robust_kernel_for_poses);
+    //ds buffer the odometry measurement to the preceeding keyframe with the weakest information of the frames in between
+    TransformMatrix3D previous_to_current(TransformMatrix3D::Identity());
+    if (_keyframe_last_added) {
+      previous_to_current = _keyframe_last_added->worldToRobot()*frame_->robotToWorld();
+    }
+    _frames_pending.push_back(PendingFrame(frame_, previous_to_current, _information_factor_since_keyframe));
+    _keyframe_last_added               = frame_;
+    _information_factor_since_keyframe = _parameters->base_information_frame;
+  } else {
+
+    //ds buffer the odometry measurement to the preceeding frame (not used if the frame becomes the first vertex of the graph)
+    TransformMatrix3D previous_to_current(TransformMatrix3D::Identity());
+    if (frame_->previous()) {
+      previous_to_current = frame_->previous()->worldToRobot()*frame_->robotToWorld();
+    }
+    _frames_pending.push_back(PendingFrame(frame_, previous_to_current, information_factor));
   }
 
-  //ds if the frame is part of a local map
+  //ds anchor the closures that arrived while no frame was buffered
+  for (const LocalMapClosure& closure: _closures_to_anchor) {
+    _addLoopClosure(frame_, closure.first, closure.second);
+  }
+  _closures_to_anchor.clear();
+
+  //ds if the frame is the keyframe of a local map (frames absorbed by a covering local map do not carry its closures)
   LocalMap* local_map = frame_->localMap();
-  if (local_map) {
+  if (local_map && local_map->keyframe() == frame_) {
 
     //ds if the local map has not been checked in a previous frame
     if (_local_maps_in_graph.find(local_map->identifier()) == _local_maps_in_graph.end()) {
@@ -274,45 +405,55 @@ void GraphOptimizer::addFrame(Frame* frame_) {
 
       //ds for all linked loop closures
       for (const LocalMap::ClosureConstraint& closure: local_map->closures()) {
+        _addLoopClosure(local_map, closure);
+      }
+    }
+  }
+  CHRONOMETER_STOP(addition)
+}
 
-        //ds reference frame
-        Frame* reference_frame = closure.local_map->keyframe();
+void GraphOptimizer::addLoopClosure(const LocalMap* local_map_query_, const LocalMap::ClosureConstraint& closure_) {
 
-        //ds check if the reference frame is not contained in the current graph
-        if (_frames_in_pose_graph.find(reference_frame) == _frames_in_pose_graph.end()) {
+  //ds if the keyframe of the query is in the graph we can add the closure right away
+  if (_local_maps_in_graph.find(local_map_query_->identifier()) != _local_maps_in_graph.end()) {
+    _addLoopClosure(local_map_query_, closure_);
+    return;
+  }
 
-          //ds the vertex was not found - we have to add it to the graph again and fix it
-          g2o::VertexSE3* vertex_reference = new g2o::VertexSE3();
-          vertex_reference->setId(reference_frame->identifier());
-          vertex_reference->setEstimate(reference_frame->robotToWorld().cast<double>());
-          vertex_reference->setFixed(true);
-          _optimizer->addVertex(vertex_reference);
-          _frames_in_pose_graph.insert(std::make_pair(reference_frame, vertex_reference));
-        } else {
+  //ds closures of local maps that are not yet in the graph are added together with the keyframe
+  if (!_frame_last_added || local_map_query_->keyframe()->identifier() > _frame_last_added->identifier()) {
+    return;
+  }
 
-          //ds fix reference vertex
-          _optimizer->vertex(reference_frame->identifier())->setFixed(true);
-        }
+  //ds the keyframe left the graph (e.g. a folded window queries an earlier local map, or the graph has been cleared since):
+  //ds the closure is anchored on a buffered frame through its pose in the query local map - or on the next frame that is buffered
+  if (!_frames_pending.empty()) {
+    _addLoopClosure(_frames_pending.back().frame, local_map_query_, closure_);
+  } else {
+    _closures_to_anchor.push_back(std::make_pair(local_map_query_, closure_));
+  }
+}
 
-        //ds compute information value
-        const real information_factor = _parameters->base_information_frame*closure.omega;
+void GraphOptimizer::_addLoopClosure(const LocalMap* local_map_query_, const LocalMap::ClosureConstraint& closure_) {
+  _closures_pending.push_back(PendingClosure(local_map_query_->keyframe(),
+                                             closure_.local_map->keyframe(),
+                                             closure_.relation,
+                                             _parameters->base_information_frame*closure_.omega));
+}
 
-        //ds retrieve closure edge
-        _setPoseEdge(_optimizer,
-                     _optimizer->vertex(local_map->keyframe()->identifier()),
-                     _optimizer->vertex(reference_frame->identifier()),
-                     closure.relation,
-                     information_factor,
-                     _parameters->free_translation_for_poses,
-                     _parameters->enable_robust_kernel_for_poses);
-      }
-    }
-  }
+void GraphOptimizer::_addLoopClosure(const Frame* frame_query_, const LocalMap* local_map_query_, const LocalMap::ClosureConstraint& closure_) {
+  _closures_pending.push_back(PendingClosure(frame_query_,
+                                             closure_.local_map->keyframe(),
+                                             closure_.relation*local_map_query_->worldToLocalMap()*frame_query_->robotToWorld(),
+                                             _parameters->base_information_frame*closure_.omega));
+}
 
-  //ds bookkeep the added frame
-  _vertex_frame_last_added = vertex_frame_current;
-  _frames_in_pose_graph.insert(std::make_pair(frame_, vertex_frame_current));
-  CHRONOMETER_STOP(addition)
+void GraphOptimizer::addFrameRelocalization(const Frame* frame_, const LocalMap* local_map_reference_, const TransformMatrix3D& robot_to_local_map_) {
+
+  //ds the odometry edge at the track break carries no information: without this constraint the relocalized segment is not anchored
+  _frame_relocalized                 = frame_;
+  _keyframe_relocalization_reference = local_map_reference_->keyframe();
+  _frame_relocalized_to_reference    = robot_to_local_map_;
 }
 
 void GraphOptimizer::addFrameWithLandmarks(Frame* frame_) {
@@ -406,24 +547,77 @@ void GraphOptimizer::addFrameWithLandmarks(Frame* frame_) {
   CHRONOMETER_STOP(addition)
 }
 
+void GraphOptimizer::updateEstimates() {
+
+  //ds the graph must not be touched while it is optimized
+  synchronize();
+  for (std::pair<Frame*, g2o::VertexSE3*> frame_in_pose_graph: _frames_in_pose_graph) {
+    frame_in_pose_graph.second->setEstimate(frame_in_pose_graph.first->robotToWorld().cast<double>());
+  }
+  for (std::pair<Landmark*, g2o::VertexPointXYZ*> landmark_in_pose_graph: _landmarks_in_pose_graph) {
+    landmark_in_pose_graph.second->setEstimate(landmark_in_pose_graph.first->coordinates().cast<double>());
+  }
+  for (Index index_vertex = 0; index_vertex < _frames_in_pose_graph_solver.size(); ++index_vertex) {
+    _pose_graph_solver.setEstimate(index_vertex, _frames_in_pose_graph_solver[index_vertex]->robotToWorld());
+  }
+}
+
 void GraphOptimizer::optimizeFrames(WorldMap* world_map_) {
+  if (hasPendingOptimization()) {
+    throw std::runtime_error("GraphOptimizer::optimizeFrames|previous optimization has not been integrated");
+  }
+  _startOptimization();
+
+  //ds in synchronous mode the result is available right away
+  if (!_parameters->enable_asynchronous_optimization) {
+    integrateOptimization(world_map_);
+  }
+}
+
+const bool GraphOptimizer::integrateOptimization(WorldMap* world_map_) {
+  {
+    std::lock_guard<std::mutex> lock(_mutex_optimization);
+    if (!_has_result) {
+      return false;
+    }
+  }
+  _applyOptimization(world_map_);
+  {
+    std::lock_guard<std::mutex> lock(_mutex_optimization);
+    _has_result = false;
+  }
+  return true;
+}
+
+void GraphOptimizer::synchronize() {
+  std::unique_lock<std::mutex> lock(_mutex_optimization);
+  _condition_optimization.wait(lock, [this]{return !_is_optimizing;});
+}
+
+const bool GraphOptimizer::hasPendingOptimization() {
+  std::lock_guard<std::mutex> lock(_mutex_optimization);
+  return _is_optimizing || _has_result;
+}
+
+void GraphOptimizer::optimizeFramesWithLandmarks(WorldMap* world_map_) {
   CHRONOMETER_START(optimization)
+  const double time_begin_seconds = srrg_core::getTime();
 
   //ds optimize graph (uncomment lines below for g2o graph dumping)
 //  const std::string file_name = "pose_graph_"+std::to_string(world_map_->currentFrame()->identifier())+".g2o";
 //  _optimizer->save(file_name.c_str());
   _optimizer->initializeOptimization();
   _optimizer->optimize(_parameters->maximum_number_of_iterations);
+  _optimization_statistics.push_back(OptimizationStatistics(_optimizer->vertices().size(),
+                                                            _optimizer->edges().size(),
+                                                            srrg_core::getTime()-time_begin_seconds));
 
-  //ds directly backpropagate solution to frames - without updating the local maps (we want to keep the fine-grained, frame-wise g2o estimate)
+  //ds directly backpropagate solution to frames and landmarks
   for(std::pair<Frame*, g2o::VertexSE3*> frame_in_pose_graph: _frames_in_pose_graph) {
     frame_in_pose_graph.first->setRobotToWorld(frame_in_pose_graph.second->estimate().cast<real>());
   }
-
-  //ds update all active landmark positions based on their last local map presence TODO make this more efficient
-  for (std::pair<const Identifier, LocalMap*>& local_map_entry: _local_maps_in_graph) {
-    LocalMap* local_map = local_map_entry.second;
-    local_map->setLocalMapToWorld(local_map->keyframe()->robotToWorld(), true);
+  for(std::pair<Landmark*, g2o::VertexPointXYZ*> landmark_in_pose_graph: _landmarks_in_pose_graph) {
+    landmark_in_pose_graph.first->setCoordinates(landmark_in_pose_graph.second->estimate().cast<real>());
   }
   world_map_->setRobotToWorld(world_map_->currentFrame()->robotToWorld());
   ++_number_of_optimizations;
@@ -432,58 +626,608 @@ void GraphOptimizer::optimizeFrames(WorldMap* world_map_) {
   _optimizer->clear();
   _vertex_frame_last_added = 0;
   _frames_in_pose_graph.clear();
-  _local_maps_in_graph.clear();
   _landmarks_in_pose_graph.clear();
   CHRONOMETER_STOP(optimization)
 }
 
-void GraphOptimizer::optimizeFramesWithLandmarks(WorldMap* world_map_) {
+void GraphOptimizer::optimizeLocalMaps(WorldMap* world_map_) {
+  LocalMap* local_map_newest = world_map_->currentLocalMap();
+  if (!_optimizer_local || !local_map_newest) {
+    return;
+  }
+
+  //ds frames moved here would be overwritten by the pending pose graph result
+  if (hasPendingOptimization()) {
+    ++_number_of_skipped_local_optimizations;
+    return;
+  }
+  CHRONOMETER_START(local_optimization)
+
+  //ds collect the most recent local maps of the current track
+  _local_maps_in_window.clear();
+  for (LocalMap* local_map = local_map_newest;
+       local_map && local_map->root() == local_map_newest->root() &&
+       _local_maps_in_window.size() < _parameters->number_of_local_maps_for_local_bundle_adjustment;
+       local_map = local_map->previous()) {
+    _local_maps_in_window.push_back(local_map);
+  }
+
+  //ds add the keyframe poses of the window and their landmark measurements (framepoints of the local map frames)
+  Count number_of_landmarks = 0;
+  for (const LocalMap* local_map: _local_maps_in_window) {
+    number_of_landmarks += local_map->landmarks().size();
+  }
+  _landmark_indices_in_window.reserve(number_of_landmarks);
+  _local_map_measuring_landmark.reserve(number_of_landmarks);
+  for (LocalMap* local_map: _local_maps_in_window) {
+    g2o::VertexSE3* vertex_keyframe = new g2o::VertexSE3();
+    vertex_keyframe->setId(local_map->keyframe()->identifier());
+    vertex_keyframe->setEstimate(local_map->localMapToWorld().cast<double>());
+    _optimizer_local->addVertex(vertex_keyframe);
+    _vertices_local_maps_in_window.push_back(vertex_keyframe);
+    _collectLocalMapMeasurements(local_map, true);
+    for (const std::pair<Index, PointCoordinates>& measurement: _measurements_local_map) {
+      _setPointEdge(_optimizer_local,
+                    vertex_keyframe,
+                    _vertices_landmarks_in_window[measurement.first],
+                    measurement.second,
+                    1/std::max(measurement.second.norm(), static_cast<real>(1)));
+    }
+  }
+
+  //ds select the boundary: local maps outside of the window observing window landmarks enter with fixed poses
+  //ds the number of boundary local maps is bounded (revisited places are observed by many), the most covisible ones are kept
+  for (Landmark* landmark: _landmarks_in_window) {
+    for (LocalMap* local_map: landmark->localMaps()) {
+      if (std::find(_local_maps_in_window.begin(), _local_maps_in_window.end(), local_map) != _local_maps_in_window.end()) {
+        continue;
+      }
+      const std::pair<Index*, bool> entry = _local_map_indices_boundary.insert(local_map->identifier(), _local_maps_boundary.size());
+      if (entry.second) {
+        _local_maps_boundary.push_back(std::make_pair(0, local_map));
+      }
+      ++_local_maps_boundary[*entry.first].first;
+    }
+  }
+  if (_local_maps_boundary.size() > _parameters->maximum_number_of_fixed_local_maps_for_local_bundle_adjustment) {
+    std::sort(_local_maps_boundary.begin(), _local_maps_boundary.end(), [](const std::pair<Count, LocalMap*>& a_, const std::pair<Count, LocalMap*>& b_) {
+      return a_.first > b_.first || (a_.first == b_.first && a_.second->identifier() > b_.second->identifier());
+    });
+    _local_maps_boundary.resize(_parameters->maximum_number_of_fixed_local_maps_for_local_bundle_adjustment);
+  }
+
+  //ds add the measurements of the selected boundary local maps
+  bool has_fixed_pose = false;
+  for (const std::pair<Count, LocalMap*>& local_map_boundary: _local_maps_boundary) {
+    const LocalMap* local_map = local_map_boundary.second;
+    _collectLocalMapMeasurements(local_map, false);
+    if (_measurements_local_map.empty()) {
+      continue;
+    }
+    g2o::VertexSE3* vertex_keyframe = new g2o::VertexSE3();
+    vertex_keyframe->setId(local_map->keyframe()->identifier());
+    vertex_keyframe->setEstimate(local_map->localMapToWorld().cast<double>());
+    vertex_keyframe->setFixed(true);
+    _optimizer_local->addVertex(vertex_keyframe);
+    has_fixed_pose = true;
+    for (const std::pair<Index, PointCoordinates>& measurement: _measurements_local_map) {
+      _setPointEdge(_optimizer_local,
+                    vertex_keyframe,
+                    _vertices_landmarks_in_window[measurement.first],
+                    measurement.second,
+                    1/std::max(measurement.second.norm(), static_cast<real>(1)));
+    }
+  }
+
+  //ds without boundary (start of the track) the oldest keyframe anchors the window
+  if (!has_fixed_pose) {
+    _vertices_local_maps_in_window.back()->setFixed(true);
+  }
+
+  //ds optimize with a fixed budget - unless there is nothing to adjust
+  if (_vertices_local_maps_in_window.size() > 1 || has_fixed_pose) {
+    _optimizer_local->initializeOptimization();
+    _optimizer_local->optimize(_parameters->number_of_iterations_for_local_bundle_adjustment);
+
+    //ds move the local maps with their frames and refresh the landmark snapshots of the window (the measurements are the framepoints)
+    for (Index index = 0; index < _local_maps_in_window.size(); ++index) {
+      LocalMap* local_map = _local_maps_in_window[index];
+      local_map->update(_vertices_local_maps_in_window[index]->estimate().cast<real>());
+    }
+    for (Index index = 0; index < _landmarks_in_window.size(); ++index) {
+      _landmarks_in_window[index]->setCoordinates(_vertices_landmarks_in_window[index]->estimate().cast<real>());
+    }
+    for (LocalMap* local_map: _local_maps_in_window) {
+      for (LocalMap::LandmarkStateMapElement& element: local_map->landmarks()) {
+        element.second.coordinates_in_local_map = local_map->worldToLocalMap()*element.second.landmark->coordinates();
+      }
+    }
+    world_map_->updateLandmarkVoxelHash(_landmarks_in_window);
+    world_map_->setRobotToWorld(world_map_->currentFrame()->robotToWorld());
+
+    //ds keep the estimates of the pose graph consistent (the optimizer thread is idle)
+    for (const LocalMap* local_map: _local_maps_in_window) {
+      for (Frame* frame: local_map->frames()) {
+        std::map<Frame*, g2o::VertexSE3*>::iterator iterator = _frames_in_pose_graph.find(frame);
+        if (iterator != _frames_in_pose_graph.end()) {
+          iterator->second->setEstimate(frame->robotToWorld().cast<double>());
+        }
+        const Index* index_vertex = _vertex_indices_in_pose_graph_solver.find(frame->identifier());
+        if (index_vertex) {
+          _pose_graph_solver.setEstimate(*index_vertex, frame->robotToWorld());
+        }
+      }
+    }
+    for (Landmark* landmark: _landmarks_in_window) {
+      std::map<Landmark*, g2o::VertexPointXYZ*>::iterator iterator = _landmarks_in_pose_graph.find(landmark);
+      if (iterator != _landmarks_in_pose_graph.end()) {
+        iterator->second->setEstimate(landmark->coordinates().cast<double>());
+      }
+    }
+
+    //ds re-measure the odometry of the moved frames, the tracked relative poses would pull the next pose graph optimization back
+    //ds the window holds the most recent local maps: frames in the graph that follow a moved frame are moved as well
+    auto is_moved = [this](const Frame* frame_) {
+      return frame_ && frame_->localMap() &&
+             std::find(_local_maps_in_window.begin(), _local_maps_in_window.end(), frame_->localMap()) != _local_maps_in_window.end();
+    };
+    for (const LocalMap* local_map: _local_maps_in_window) {
+      for (const Frame* frame: local_map->frames()) {
+        g2o::EdgeSE3** edge_odometry = _odometry_edges_in_pose_graph.find(frame->identifier());
+        if (edge_odometry) {
+          (*edge_odometry)->setMeasurement(static_cast<g2o::VertexSE3*>((*edge_odometry)->vertex(0))->estimate().inverse()*
+                                           static_cast<g2o::VertexSE3*>((*edge_odometry)->vertex(1))->estimate());
+        }
+        const Index* index_edge = _odometry_edge_indices_in_pose_graph_solver.find(frame->identifier());
+        if (index_edge) {
+          _pose_graph_solver.resetMeasurement(*index_edge);
+        }
+      }
+    }
+    for (Index index = 0; index < _frames_pending.size(); ++index) {
+      PendingFrame& frame_pending = _frames_pending[index];
+      const Frame* frame_previous = frame_pending.frame->previous();
+      if (_parameters->enable_keyframe_pose_graph) {
+        frame_previous = (index > 0)? _frames_pending[index-1].frame: _frame_last_handed_over;
+      }
+      if (frame_previous && (is_moved(frame_pending.frame) || is_moved(frame_previous))) {
+        frame_pending.previous_to_current = frame_previous->worldToRobot()*frame_pending.frame->robotToWorld();
+      }
+    }
+    ++_number_of_local_optimizations;
+  }
+
+  //ds reset the window (the bookkeeping keeps its memory)
+  _optimizer_local->clear();
+  _local_maps_in_window.clear();
+  _vertices_local_maps_in_window.clear();
+  _landmarks_in_window.clear();
+  _vertices_landmarks_in_window.clear();
+  _landmark_indices_in_window.clear();
+  _local_map_measuring_landmark.clear();
+  _local_maps_boundary.clear();
+  _local_map_indices_boundary.clear();
+  CHRONOMETER_STOP(local_optimization)
+}
+
+void GraphOptimizer::_collectLocalMapMeasurements(const LocalMap* local_map_, const bool& add_landmarks_) {
+  _measurements_local_map.clear();
+  const Identifier& identifier_local_map = local_map_->identifier();
+
+  //ds scan the frames starting with the most recent one (the keyframe): the first observation of a landmark is its measurement
+  for (FramePointerVector::const_reverse_iterator iterator = local_map_->frames().rbegin(); iterator != local_map_->frames().rend(); ++iterator) {
+    const Frame* frame = *iterator;
+    for (const FramePoint* frame_point: frame->points()) {
+      const Landmark* landmark = frame_point->landmark();
+      if (!landmark || local_map_->landmarks().find(landmark->identifier()) == local_map_->landmarks().end()) {
+        continue;
+      }
+
+      //ds boundary local maps only measure landmarks of the window
+      const Index* index_landmark = _landmark_indices_in_window.find(landmark->identifier());
+      if (!index_landmark && !add_landmarks_) {
+        continue;
+      }
+
+      //ds a single measurement per local map and landmark
+      const std::pair<Identifier*, bool> entry = _local_map_measuring_landmark.insert(landmark->identifier(), identifier_local_map);
+      if (!entry.second) {
+        if (*entry.first == identifier_local_map) {
+          continue;
+        }
+        *entry.first = identifier_local_map;
+      }
+
+      //ds add the landmark to the window
+      if (!index_landmark) {
+        index_landmark = _landmark_indices_in_window.insert(landmark->identifier(), _landmarks_in_window.size()).first;
+        g2o::VertexPointXYZ* vertex_landmark = new g2o::VertexPointXYZ();
+        vertex_landmark->setId(landmark->identifier()+_parameters->identifier_space);
+        vertex_landmark->setEstimate(landmark->coordinates().cast<double>());
+        vertex_landmark->setMarginalized(true);
+        _optimizer_local->addVertex(vertex_landmark);
+        _landmarks_in_window.push_back(const_cast<Landmark*>(landmark));
+        _vertices_landmarks_in_window.push_back(vertex_landmark);
+      }
+
+      //ds framepoint measurement expressed in the keyframe (the frames of a local map are rigidly attached to it)
+      _measurements_local_map.push_back(std::make_pair(*index_landmark, frame->frameToLocalMap()*frame_point->robotCoordinates()));
+    }
+  }
+}
+
+void GraphOptimizer::_startOptimization() {
+
+  //ds refresh the initial estimates with the current poses (e.g. moved by a relocalized track since buffering)
+  for (PendingFrame& frame_pending: _frames_pending) {
+    frame_pending.robot_to_world = frame_pending.frame->robotToWorld();
+  }
+  for (PendingClosure& closure_pending: _closures_pending) {
+    closure_pending.robot_to_world_reference = closure_pending.keyframe_reference->robotToWorld();
+  }
+
+  //ds snapshot the last frame handed over: frames added during the optimization are corrected relative to it
+  if (!_frames_pending.empty()) {
+    _frame_last_handed_over = _frames_pending.back().frame;
+  }
+  if (_frame_last_handed_over) {
+    _robot_to_world_last_handed_over = _frame_last_handed_over->robotToWorld();
+  }
+
+  //ds the local maps of a graph that is cleared after the optimization are updated with its result only
+  if (!_parameters->enable_incremental_optimization) {
+    _local_maps_handed_over.clear();
+    _local_maps_handed_over.swap(_local_maps_in_graph);
+  }
+
+  //ds hand over the buffered measurements
+  _frames_handed_over.clear();
+  _frames_handed_over.swap(_frames_pending);
+  _closures_handed_over.clear();
+  _closures_handed_over.swap(_closures_pending);
+
+  //ds optimize in the optimizer thread or right away
+  if (_parameters->enable_asynchronous_optimization) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex_optimization);
+      _is_optimizing = true;
+    }
+    _condition_optimization.notify_all();
+  } else {
+    _is_optimizing = true;
+    _optimize();
+  }
+}
+
+void GraphOptimizer::_optimize() {
   CHRONOMETER_START(optimization)
+  const double time_begin_seconds = srrg_core::getTime();
+
+  //ds integrate the handed over measurements, optimize and write the solution to the back buffer
+  OptimizationStatistics statistics(0, 0, 0);
+  if (_is_pose_graph_solver_native) {
+    statistics = _optimizeNative(time_begin_seconds);
+  } else {
+    statistics = _optimizeG2o(time_begin_seconds);
+  }
+  _frames_handed_over.clear();
+  _closures_handed_over.clear();
+  CHRONOMETER_STOP(optimization)
+
+  //ds publish the solution
+  {
+    std::lock_guard<std::mutex> lock(_mutex_optimization);
+    _poses_optimized_published.swap(_poses_optimized);
+    _statistics_published = statistics;
+    _is_optimizing = false;
+    _has_result    = true;
+  }
+  _condition_optimization.notify_all();
+}
+
+const GraphOptimizer::OptimizationStatistics GraphOptimizer::_optimizeG2o(const double& time_begin_seconds_) {
+
+  //ds integrate the handed over frames into the graph
+  for (const PendingFrame& frame_pending: _frames_handed_over) {
+    g2o::VertexSE3* vertex_frame_current = new g2o::VertexSE3();
+    vertex_frame_current->setId(frame_pending.frame->identifier());
+    vertex_frame_current->setEstimate(frame_pending.robot_to_world.cast<double>());
+    _optimizer->addVertex(vertex_frame_current);
+
+    //ds if its the first frame to be added (start or recently cleared pose graph)
+    if (!_vertex_frame_last_added) {
+
+      //ds fix the initial vertex - no measurement to add
+      vertex_frame_current->setFixed(true);
+    } else {
+
+      //ds we can connect it to the preceeding frame by adding the odometry measurement
+      g2o::EdgeSE3* edge_odometry = _setPoseEdge(_optimizer,
+                                                 vertex_frame_current,
+                                                 _vertex_frame_last_added,
+                                                 frame_pending.previous_to_current,
+                                                 frame_pending.information_factor,
+                                                 _parameters->free_translation_for_poses,
+                                                 _parameters->enable_robust_kernel_for_poses);
+      _odometry_edges_in_pose_graph.insert(frame_pending.frame->identifier(), edge_odometry);
+    }
+
+    //ds bookkeep the added frame
+    _vertex_frame_last_added = vertex_frame_current;
+    _frames_in_pose_graph.insert(std::make_pair(frame_pending.frame, vertex_frame_current));
+  }
+
+  //ds integrate the handed over loop closures into the graph
+  for (const PendingClosure& closure_pending: _closures_handed_over) {
+    g2o::OptimizableGraph::Vertex* vertex_query = _optimizer->vertex(closure_pending.frame_query->identifier());
+    if (!vertex_query) {
+      continue;
+    }
+
+    //ds check if the reference frame is not contained in the current graph
+    Frame* reference_frame = closure_pending.keyframe_reference;
+    if (_frames_in_pose_graph.find(reference_frame) == _frames_in_pose_graph.end()) {
+
+      //ds the vertex was not found - we have to add it to the graph again and fix it
+      g2o::VertexSE3* vertex_reference = new g2o::VertexSE3();
+      vertex_reference->setId(reference_frame->identifier());
+      vertex_reference->setEstimate(closure_pending.robot_to_world_reference.cast<double>());
+      vertex_reference->setFixed(true);
+      _optimizer->addVertex(vertex_reference);
+      _frames_in_pose_graph.insert(std::make_pair(reference_frame, vertex_reference));
+    } else if (!_parameters->enable_incremental_optimization) {
+
+      //ds fix reference vertex (the persistent graph of the incremental mode is anchored at its first vertex only)
+      _optimizer->vertex(reference_frame->identifier())->setFixed(true);
+    }
+
+    //ds add closure edge
+    _setPoseEdge(_optimizer,
+                 vertex_query,
+                 _optimizer->vertex(reference_frame->identifier()),
+                 closure_pending.query_to_reference,
+                 closure_pending.information_factor,
+                 _parameters->free_translation_for_poses,
+                 _parameters->enable_robust_kernel_for_poses);
+  }
 
   //ds optimize graph (uncomment lines below for g2o graph dumping)
-//  const std::string file_name = "pose_graph_"+std::to_string(world_map_->currentFrame()->identifier())+".g2o";
+//  const std::string file_name = "pose_graph_"+std::to_string(_vertex_frame_last_added->id())+".g2o";
 //  _optimizer->save(file_name.c_str());
+  //ds the structure is always rebuilt: the stock linear solvers do not support online updates (incremental Cholesky)
+  //ds a persistent graph (incremental optimization) still warm starts the optimization with the previous solution
   _optimizer->initializeOptimization();
+  if (_parameters->enable_incremental_optimization) {
+
+    //ds reset the termination criterion
+    g2o::HyperGraphAction::ParametersIteration parameters_termination(-1);
+    (*_terminate_action)(_optimizer, &parameters_termination);
+  }
   _optimizer->optimize(_parameters->maximum_number_of_iterations);
+  const OptimizationStatistics statistics(_optimizer->vertices().size(),
+                                          _optimizer->edges().size(),
+                                          srrg_core::getTime()-time_begin_seconds_);
+
+  //ds write the solution to the back buffer
+  _poses_optimized.clear();
+  _poses_optimized.reserve(_frames_in_pose_graph.size());
+  for (std::pair<Frame*, g2o::VertexSE3*> frame_in_pose_graph: _frames_in_pose_graph) {
+    _poses_optimized.push_back(std::make_pair(frame_in_pose_graph.first, frame_in_pose_graph.second->estimate().cast<real>()));
+  }
 
-  //ds directly backpropagate solution to frames and landmarks
-  for(std::pair<Frame*, g2o::VertexSE3*> frame_in_pose_graph: _frames_in_pose_graph) {
-    frame_in_pose_graph.first->setRobotToWorld(frame_in_pose_graph.second->estimate().cast<real>());
+  //ds reset graph for next optimization (unless it is kept)
+  if (!_parameters->enable_incremental_optimization) {
+    _optimizer->clear();
+    _vertex_frame_last_added = 0;
+    _frames_in_pose_graph.clear();
+    _odometry_edges_in_pose_graph.clear();
+    _landmarks_in_pose_graph.clear();
   }
-  for(std::pair<Landmark*, g2o::VertexPointXYZ*> landmark_in_pose_graph: _landmarks_in_pose_graph) {
-    landmark_in_pose_graph.first->setCoordinates(landmark_in_pose_graph.second->estimate().cast<real>());
+  return statistics;
+}
+
+const GraphOptimizer::OptimizationStatistics GraphOptimizer::_optimizeNative(const double& time_begin_seconds_) {
+
+  //ds integrate the handed over frames into the graph
+  for (const PendingFrame& frame_pending: _frames_handed_over) {
+
+    //ds the first frame of the graph is fixed - no measurement to add
+    const bool is_first = _frames_in_pose_graph_solver.empty();
+    const Index index_vertex = _pose_graph_solver.addVertex(frame_pending.robot_to_world, is_first);
+    if (!is_first) {
+
+      //ds connect it to the preceeding frame by adding the odometry measurement
+      const Index index_edge = _pose_graph_solver.addEdge(index_vertex,
+                                                          _index_vertex_frame_last_added,
+                                                          frame_pending.previous_to_current,
+                                                          _getPoseInformation(frame_pending.information_factor, _parameters->free_translation_for_poses),
+                                                          _parameters->enable_robust_kernel_for_poses);
+      _odometry_edge_indices_in_pose_graph_solver.insert(frame_pending.frame->identifier(), index_edge);
+    }
+
+    //ds bookkeep the added frame
+    _index_vertex_frame_last_added = index_vertex;
+    _frames_in_pose_graph_solver.push_back(frame_pending.frame);
+    _vertex_indices_in_pose_graph_solver.insert(frame_pending.frame->identifier(), index_vertex);
+  }
+
+  //ds integrate the handed over loop closures into the graph
+  for (const PendingClosure& closure_pending: _closures_handed_over) {
+    const Index* index_vertex_query = _vertex_indices_in_pose_graph_solver.find(closure_pending.frame_query->identifier());
+    if (!index_vertex_query) {
+      continue;
+    }
+    const Index index_vertex_query_value = *index_vertex_query;
+
+    //ds if the reference frame is not contained in the current graph we have to add it again and fix it
+    Frame* reference_frame = closure_pending.keyframe_reference;
+    const std::pair<Index*, bool> entry = _vertex_indices_in_pose_graph_solver.insert(reference_frame->identifier(), _frames_in_pose_graph_solver.size());
+    if (entry.second) {
+      _pose_graph_solver.addVertex(closure_pending.robot_to_world_reference, true);
+      _frames_in_pose_graph_solver.push_back(reference_frame);
+    } else if (!_parameters->enable_incremental_optimization) {
+
+      //ds fix reference vertex (the persistent graph of the incremental mode is anchored at its first vertex only)
+      _pose_graph_solver.setFixed(*entry.first, true);
+    }
+    _pose_graph_solver.addEdge(index_vertex_query_value,
+                               *entry.first,
+                               closure_pending.query_to_reference,
+                               _getPoseInformation(closure_pending.information_factor, _parameters->free_translation_for_poses),
+                               _parameters->enable_robust_kernel_for_poses);
+  }
+
+  //ds incremental mode: reserve blocks for about twice the frames handed over (appended frames keep the symbolic factorization)
+  if (_parameters->enable_incremental_optimization) {
+    _pose_graph_solver.setNumberOfReservedVertices(2*_frames_handed_over.size());
+  }
+
+  //ds optimize, starting from the previous solution in incremental mode (the symbolic factorization is reused while the graph grows within it)
+  _pose_graph_solver.optimize(_parameters->maximum_number_of_iterations, _parameters->minimum_relative_gain_for_termination);
+  const OptimizationStatistics statistics(_pose_graph_solver.numberOfVertices(),
+                                          _pose_graph_solver.numberOfEdges(),
+                                          srrg_core::getTime()-time_begin_seconds_);
+
+  //ds write the solution to the back buffer
+  _poses_optimized.clear();
+  _poses_optimized.reserve(_frames_in_pose_graph_solver.size());
+  for (Index index_vertex = 0; index_vertex < _frames_in_pose_graph_solver.size(); ++index_vertex) {
+    _poses_optimized.push_back(std::make_pair(_frames_in_pose_graph_solver[index_vertex], _pose_graph_solver.estimate(index_vertex)));
   }
+
+  //ds reset graph for next optimization (unless it is kept)
+  if (!_parameters->enable_incremental_optimization) {
+    _pose_graph_solver.clear();
+    _frames_in_pose_graph_solver.clear();
+    _vertex_indices_in_pose_graph_solver.clear();
+    _odometry_edge_indices_in_pose_graph_solver.clear();
+  }
+  return statistics;
+}
+
+void GraphOptimizer::_applyOptimization(WorldMap* world_map_) {
+
+  //ds directly backpropagate solution to frames - without updating the local maps (we want to keep the fine-grained, frame-wise g2o estimate)
+  TransformMatrix3D correction(TransformMatrix3D::Identity());
+  for (const std::pair<Frame*, TransformMatrix3D>& pose_optimized: _poses_optimized_published) {
+    pose_optimized.first->setRobotToWorld(pose_optimized.second);
+    if (pose_optimized.first == _frame_last_handed_over) {
+      correction = pose_optimized.second*_robot_to_world_last_handed_over.inverse();
+    }
+  }
+
+  //ds frames added during the optimization are not in the graph yet: move them rigidly with the last optimized frame
+  //ds (in keyframe mode as well as the frames since the last keyframe, which are not yet in a local map)
+  if (!_frames_pending.empty() || !_frames_since_keyframe.empty()) {
+    for (PendingFrame& frame_pending: _frames_pending) {
+      frame_pending.frame->setRobotToWorld(correction*frame_pending.frame->robotToWorld());
+    }
+    for (Frame* frame: _frames_since_keyframe) {
+      frame->setRobotToWorld(correction*frame->robotToWorld());
+    }
+
+    //ds as well as the landmarks currently tracked (landmarks of local maps are updated below)
+    for (Landmark* landmark: world_map_->currentlyTrackedLandmarks()) {
+      landmark->transform(correction);
+    }
+  }
+
+  //ds update the landmark positions based on their last local map presence: for the handed over local maps (holding the tracked landmarks)
+  //ds and the local maps whose keyframe has been corrected noticeably - the cost scales with the corrected part of the map
+  //ds in keyframe mode the frames of the local maps and the frames attached to their keyframe are moved rigidly with the keyframe
+  //ds the correction is measured against the last applied local map pose, such that skipped corrections accumulate until they are applied
+  const bool update_frames                  = _parameters->enable_keyframe_pose_graph;
+  const real minimum_translation_correction = _parameters->minimum_keyframe_translation_correction_for_update;
+  const real minimum_rotation_correction    = _parameters->minimum_keyframe_rotation_correction_for_update;
+  auto update_local_map = [this, update_frames, minimum_translation_correction, minimum_rotation_correction](LocalMap* local_map_, const bool& is_handed_over_) {
+    const TransformMatrix3D& keyframe_to_world = local_map_->keyframe()->robotToWorld();
+    if (!is_handed_over_) {
+      const TransformMatrix3D correction(local_map_->worldToLocalMap()*keyframe_to_world);
+      if (correction.translation().norm() < minimum_translation_correction &&
+          Eigen::AngleAxis<real>(correction.linear()).angle() < minimum_rotation_correction) {
+        return;
+      }
+    }
+    if (update_frames) {
+      local_map_->update(keyframe_to_world);
+      const AttachedFrameMap::const_iterator iterator = _frames_attached.find(local_map_->keyframe());
+      if (iterator != _frames_attached.end()) {
+        for (const AttachedFrame& frame_attached: iterator->second) {
+          frame_attached.frame->setRobotToWorld(keyframe_to_world*frame_attached.frame_to_keyframe);
+        }
+      }
+    }
+    local_map_->setLocalMapToWorld(keyframe_to_world, true);
+  };
+  for (std::pair<const Identifier, LocalMap*>& local_map_entry: _local_maps_handed_over) {
+    update_local_map(local_map_entry.second, true);
+  }
+  for (std::pair<const Identifier, LocalMap*>& local_map_entry: _local_maps_in_graph) {
+    update_local_map(local_map_entry.second, false);
+  }
+  _local_maps_handed_over.clear();
   world_map_->setRobotToWorld(world_map_->currentFrame()->robotToWorld());
+  _optimization_statistics.push_back(_statistics_published);
   ++_number_of_optimizations;
+}
 
-  //ds reset graph for next optimization
-  _optimizer->clear();
-  _vertex_frame_last_added = 0;
-  _frames_in_pose_graph.clear();
-  _landmarks_in_pose_graph.clear();
-  CHRONOMETER_STOP(optimization)
+void GraphOptimizer::_processQueue() {
+  while (true) {
+
+    //ds wait for handed over measurements
+    {
+      std::unique_lock<std::mutex> lock(_mutex_optimization);
+      _condition_optimization.wait(lock, [this]{return !_is_running || _is_optimizing;});
+      if (!_is_running) {
+        return;
+      }
+    }
+
+    //ds the graph and the handed over buffers are owned by this thread until the solution is published
+    _optimize();
+  }
 }
 
-void GraphOptimizer::_setPoseEdge(g2o::OptimizableGraph* optimizer_,
-                                  g2o::OptimizableGraph::Vertex* vertex_from_,
-                                  g2o::OptimizableGraph::Vertex* vertex_to_,
-                                  const TransformMatrix3D& transform_from_to_,
-                                  const real& information_factor_,
-                                  const bool& free_translation_,
-                                  const bool& enable_robust_kernel_) const {
-  g2o::EdgeSE3* edge_pose = new g2o::EdgeSE3();
-  edge_pose->setVertex(1, vertex_from_);
-  edge_pose->setVertex(0, vertex_to_);
-  edge_pose->setMeasurement(transform_from_to_.cast<double>());
+void GraphOptimizer::_stop() {
+  if (!_worker.joinable()) {
+    return;
+  }
+
+  //ds a running optimization is completed before the thread terminates
+  synchronize();
+  {
+    std::lock_guard<std::mutex> lock(_mutex_optimization);
+    _is_running = false;
+  }
+  _condition_optimization.notify_all();
+  _worker.join();
+  LOG_INFO(std::cerr << "GraphOptimizer::_stop|stopped optimizer thread (discarded result: " << _has_result << ")" << std::endl)
+  _has_result = false;
+}
 
-  //ds information value
-  Eigen::Matrix<double, 6, 6> information(information_factor_*Eigen::Matrix<double, 6, 6>::Identity());
+const PoseGraphSolver::Matrix6 GraphOptimizer::_getPoseInformation(const real& information_factor_, const bool& free_translation_) const {
+  PoseGraphSolver::Matrix6 information(information_factor_*PoseGraphSolver::Matrix6::Identity());
   if (free_translation_) {
     information.block<3,3>(0,0) *= _parameters->base_information_frame_factor_for_translation;
   }
-  edge_pose->setInformation(information);
+  return information;
+}
+
+g2o::EdgeSE3* GraphOptimizer::_setPoseEdge(g2o::OptimizableGraph* optimizer_,
+                                           g2o::OptimizableGraph::Vertex* vertex_from_,
+                                           g2o::OptimizableGraph::Vertex* vertex_to_,
+                                           const TransformMatrix3D& transform_from_to_,
+                                           const real& information_factor_,
+                                           const bool& free_translation_,
+                                           const bool& enable_robust_kernel_) const {
+  g2o::EdgeSE3* edge_pose = new g2o::EdgeSE3();
+  edge_pose->setVertex(1, vertex_from_);
+  edge_pose->setVertex(0, vertex_to_);
+  edge_pose->setMeasurement(transform_from_to_.cast<double>());
+  edge_pose->setInformation(_getPoseInformation(information_factor_, free_translation_).cast<double>());
   if (enable_robust_kernel_) {edge_pose->setRobustKernel(new g2o::RobustKernelCauchy());}
   optimizer_->addEdge(edge_pose);
+  return edge_pose;
 }
 
 void GraphOptimizer::_setPointEdge(g2o::OptimizableGraph* optimizer_,
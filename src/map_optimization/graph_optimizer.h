@@ -1,4 +1,7 @@
 #pragma once
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 
 //ds g2o
 #include "g2o/core/optimizable_graph.h"
@@ -11,9 +14,11 @@
 #include "g2o/types/slam3d/types_slam3d.h"
 #include "g2o/core/optimization_algorithm_gauss_newton.h"
 #include "g2o/core/optimization_algorithm_levenberg.h"
+#include "g2o/core/sparse_optimizer_terminate_action.h"
 
 //ds proslam
 #include "types/world_map.h"
+#include "pose_graph_solver.h"
 #include "relocalization/closure.h"
 
 namespace proslam {
@@ -38,6 +43,18 @@ public:
   typedef g2o::OptimizationAlgorithmGaussNewton OptimizerGaussNewton;
   typedef g2o::OptimizationAlgorithmLevenberg OptimizerLevenberg;
 
+  //! @brief size and duration of a single graph optimization
+  struct OptimizationStatistics {
+    OptimizationStatistics(const Count& number_of_vertices_,
+                           const Count& number_of_edges_,
+                           const double& duration_seconds_): number_of_vertices(number_of_vertices_),
+                                                             number_of_edges(number_of_edges_),
+                                                             duration_seconds(duration_seconds_) {}
+    Count number_of_vertices;
+    Count number_of_edges;
+    double duration_seconds;
+  };
+
   //! @brief g2o parameter identifiers
   enum G2oParameter {
     WORLD_OFFSET     = 0,
@@ -57,37 +74,95 @@ public:
   //! @param[in] file_name_ desired file name for the g2o outfile
   void writePoseGraphToFile(const WorldMap* world_map_, const std::string& file_name_) const;
 
-  //! @brief adds a new frame to the pose graph
+  //! @brief adds a new frame to the pose graph (its measurements are buffered and integrated into the graph at the next optimization)
+  //! in keyframe mode only local map keyframes enter the graph (connected by the odometry between consecutive keyframes),
+  //! the other frames are moved rigidly with the keyframe of their local map (or the preceeding keyframe if they are in none)
   //! @param[in] frame_ the frame to add
   void addFrame(Frame* frame_);
 
+  //! @brief adds a loop closure constraint of a local map that has already been added (closures integrated asynchronously or a folded window)
+  //! if the keyframe of the query is no longer in the graph, the closure is anchored on the most recent frame through its pose in the query
+  //! @param[in] local_map_query_ the query local map carrying the closure
+  //! @param[in] closure_ the closure constraint to the reference local map
+  void addLoopClosure(const LocalMap* local_map_query_, const LocalMap::ClosureConstraint& closure_);
+
+  //! @brief adds a constraint between a relocalized frame (track loss) and the keyframe of the local map it was registered against
+  //! the constraint is integrated with the frame, in keyframe mode with the next keyframe (through the odometry since the frame)
+  //! @param[in] frame_ the relocalized frame, not yet added to the pose graph
+  //! @param[in] local_map_reference_ the local map the frame was registered against
+  //! @param[in] robot_to_local_map_ the frame pose in the reference local map
+  void addFrameRelocalization(const Frame* frame_, const LocalMap* local_map_reference_, const TransformMatrix3D& robot_to_local_map_);
+
   //! @brief adds a new frame to the pose graph with all connected landmarks
   //! @param[in] frame_ the frame to add including its captured landmarks
   void addFrameWithLandmarks(Frame* frame_);
 
+  //! @brief refreshes the vertex estimates from the current frame poses and landmark coordinates (e.g. after a lost track was relocalized)
+  void updateEstimates();
+
   //! @brief triggers an adjustment of poses only
+  //! in incremental mode the graph is kept for the next call: only vertices and edges added since the last call are integrated
+  //! and the optimization is warm started from the previous solution
+  //! in asynchronous mode the optimization is started in the optimizer thread and the call returns immediately,
+  //! the result is applied by integrateOptimization (no further optimization can be started until then)
   //! @param[in] world_map_ map in which the optimization takes place
   void optimizeFrames(WorldMap* world_map_);
 
+  //! @brief applies the result of a completed background optimization (to be called at a safe point of the tracking loop)
+  //! frames added during the optimization and the currently tracked landmarks are moved rigidly with the correction of the last optimized frame
+  //! @param[in] world_map_ map in which the optimization takes place
+  //! @return true if an optimization result has been applied
+  const bool integrateOptimization(WorldMap* world_map_);
+
+  //! @brief blocks until the background optimization (if any) has completed, its result remains to be integrated
+  void synchronize();
+
   //! @brief triggers a full bundle adjustment optimization of the current pose graph
   //! @param[in] world_map_ map in which the optimization takes place
   void optimizeFramesWithLandmarks(WorldMap* world_map_);
 
+  //! @brief local bundle adjustment of the keyframe poses of the most recent local maps of the current track and their landmarks
+  //! local maps outside of the window that observe its landmarks are fixed, the frames of a local map are moved rigidly with its keyframe
+  //! the cost per call is bounded by the window size, independent of the map size (skipped while a pose graph optimization is pending)
+  //! @param[in] world_map_ map in which the optimization takes place (its current local map is the most recent one)
+  void optimizeLocalMaps(WorldMap* world_map_);
+
 //ds getters/setters
 public:
 
   const Count numberOfOptimizations() const {return _number_of_optimizations;}
+  const Count numberOfLocalOptimizations() const {return _number_of_local_optimizations;}
+  const Count numberOfSkippedLocalOptimizations() const {return _number_of_skipped_local_optimizations;}
+  const std::vector<OptimizationStatistics>& optimizationStatistics() const {return _optimization_statistics;}
+  inline const bool isAsynchronous() const {return _parameters->enable_asynchronous_optimization;}
+
+  //! @brief true if an optimization is running or completed but not yet integrated
+  const bool hasPendingOptimization();
 
 //ds g2o wrapper functions
 protected:
 
-  void _setPoseEdge(g2o::OptimizableGraph* optimizer_,
-                    g2o::OptimizableGraph::Vertex* vertex_from_,
-                    g2o::OptimizableGraph::Vertex* vertex_to_,
-                    const TransformMatrix3D& transform_from_to_,
-                    const real& information_factor_,
-                    const bool& free_translation_ = true,
-                    const bool& enable_robust_kernel_ = false) const;
+  //! @brief information matrix of a pose measurement (translation, rotation order)
+  const PoseGraphSolver::Matrix6 _getPoseInformation(const real& information_factor_, const bool& free_translation_) const;
+
+  g2o::EdgeSE3* _setPoseEdge(g2o::OptimizableGraph* optimizer_,
+                             g2o::OptimizableGraph::Vertex* vertex_from_,
+                             g2o::OptimizableGraph::Vertex* vertex_to_,
+                             const TransformMatrix3D& transform_from_to_,
+                             const real& information_factor_,
+                             const bool& free_translation_ = true,
+                             const bool& enable_robust_kernel_ = false) const;
+
+  //! @brief buffers a loop closure edge between the query and reference keyframes
+  void _addLoopClosure(const LocalMap* local_map_query_, const LocalMap::ClosureConstraint& closure_);
+
+  //! @brief buffers a loop closure edge between a frame and the reference keyframe, composed with the pose of the frame in the query local map
+  void _addLoopClosure(const Frame* frame_query_, const LocalMap* local_map_query_, const LocalMap::ClosureConstraint& closure_);
+
+  //! @brief local bundle adjustment: collects the framepoint measurements of a local map, expressed in its keyframe (most recent observation)
+  //! @param[in] local_map_ local map whose frames are scanned
+  //! @param[in] add_landmarks_ if set landmarks not yet in the window are added to it (window local maps), otherwise skipped (boundary)
+  void _collectLocalMapMeasurements(const LocalMap* local_map_, const bool& add_landmarks_);
 
   void _setPointEdge(g2o::OptimizableGraph* optimizer_,
                      g2o::VertexSE3* vertex_frame_,
@@ -95,6 +170,83 @@ protected:
                      const PointCoordinates& framepoint_robot_coordinates,
                      const real& information_factor_) const;
 
+//ds pose graph optimization helpers
+protected:
+
+  //! @brief frame measurements buffered for integration into the graph
+  struct PendingFrame {
+    PendingFrame(Frame* frame_,
+                 const TransformMatrix3D& previous_to_current_,
+                 const real& information_factor_): frame(frame_),
+                                                   robot_to_world(frame_->robotToWorld()),
+                                                   previous_to_current(previous_to_current_),
+                                                   information_factor(information_factor_) {}
+    Frame* frame;
+    TransformMatrix3D robot_to_world;      //ds initial estimate (refreshed when handed to the optimization)
+    TransformMatrix3D previous_to_current; //ds odometry measurement
+    real information_factor;
+  };
+  typedef std::vector<PendingFrame, Eigen::aligned_allocator<PendingFrame>> PendingFrameVector;
+
+  //! @brief loop closure measurements buffered for integration into the graph
+  struct PendingClosure {
+    PendingClosure(const Frame* frame_query_,
+                   Frame* keyframe_reference_,
+                   const TransformMatrix3D& query_to_reference_,
+                   const real& information_factor_): frame_query(frame_query_),
+                                                     keyframe_reference(keyframe_reference_),
+                                                     robot_to_world_reference(keyframe_reference_->robotToWorld()),
+                                                     query_to_reference(query_to_reference_),
+                                                     information_factor(information_factor_) {}
+    const Frame* frame_query; //ds keyframe of the query local map, or the frame the closure is anchored on
+    Frame* keyframe_reference;
+    TransformMatrix3D robot_to_world_reference; //ds estimate if the reference is not in the graph (refreshed when handed over)
+    TransformMatrix3D query_to_reference;
+    real information_factor;
+  };
+  typedef std::vector<PendingClosure, Eigen::aligned_allocator<PendingClosure>> PendingClosureVector;
+  typedef std::pair<const LocalMap*, LocalMap::ClosureConstraint> LocalMapClosure;
+  typedef std::vector<LocalMapClosure, Eigen::aligned_allocator<LocalMapClosure>> LocalMapClosureVector;
+
+  //! @brief keyframe mode: frame that is not part of a local map (dropped by a track break), moved rigidly with the preceeding keyframe
+  struct AttachedFrame {
+    AttachedFrame(Frame* frame_, const Frame* keyframe_): frame(frame_),
+                                                          keyframe(keyframe_),
+                                                          frame_to_keyframe(keyframe_->worldToRobot()*frame_->robotToWorld()) {}
+    Frame* frame;
+    const Frame* keyframe;
+    TransformMatrix3D frame_to_keyframe;
+  };
+  typedef std::vector<AttachedFrame, Eigen::aligned_allocator<AttachedFrame>> AttachedFrameVector;
+  typedef std::map<const Frame*, AttachedFrameVector> AttachedFrameMap;
+
+  //! @brief hands the buffered measurements over to an optimization: in the optimizer thread or right away (synchronous mode)
+  void _startOptimization();
+
+  //! @brief integrates the handed over measurements into the graph and optimizes it, the solution is written to the result buffer
+  //! runs in the optimizer thread in asynchronous mode, nothing but the graph and the handed over buffers must be accessed
+  void _optimize();
+
+  //! @brief _optimize with the g2o pose graph
+  //! @param[in] time_begin_seconds_ start time of the optimization
+  //! @return statistics of the optimization
+  const OptimizationStatistics _optimizeG2o(const double& time_begin_seconds_);
+
+  //! @brief _optimize with the specialized pose graph solver
+  //! @param[in] time_begin_seconds_ start time of the optimization
+  //! @return statistics of the optimization
+  const OptimizationStatistics _optimizeNative(const double& time_begin_seconds_);
+
+  //! @brief applies the result buffer to frames, local maps and the world map
+  //! @param[in] world_map_ map in which the optimization takes place
+  void _applyOptimization(WorldMap* world_map_);
+
+  //! @brief optimizer thread loop: optimizes whenever measurements are handed over until stopped
+  void _processQueue();
+
+  //! @brief stops and joins the optimizer thread (a running optimization is completed first), the unapplied result is discarded
+  void _stop();
+
 //ds attributes
 protected:
 
@@ -104,8 +256,55 @@ protected:
   //! @brief last frame vertex added (to be locked for optimization)
   g2o::VertexSE3* _vertex_frame_last_added;
 
-  //! @brief bookkeeping: added frames
+  //! @brief buffered measurements, not yet handed to an optimization (tracking thread only)
+  PendingFrameVector _frames_pending;
+  PendingClosureVector _closures_pending;
+
+  //! @brief measurements handed to the running optimization (optimizer thread only while optimizing)
+  PendingFrameVector _frames_handed_over;
+  PendingClosureVector _closures_handed_over;
+
+  //! @brief keyframe mode: last keyframe added, the minimum information of the frames since (odometry measurement to the next keyframe)
+  //! and the frames added since, which are not in the graph (tracking thread only)
+  const Frame* _keyframe_last_added = nullptr;
+  real _information_factor_since_keyframe = 0;
+  FramePointerVector _frames_since_keyframe;
+
+  //! @brief keyframe mode: frames that are not part of a local map, grouped by their keyframe (moved only if the keyframe is corrected)
+  AttachedFrameMap _frames_attached;
+
+  //! @brief last frame added and the closures to be anchored on the next buffered frame (their query keyframe left the graph)
+  const Frame* _frame_last_added = nullptr;
+  LocalMapClosureVector _closures_to_anchor;
+
+  //! @brief relocalized frame whose constraint to the reference keyframe is not yet buffered and its pose in the reference
+  const Frame* _frame_relocalized = nullptr;
+  Frame* _keyframe_relocalization_reference = nullptr;
+  TransformMatrix3D _frame_relocalized_to_reference = TransformMatrix3D::Identity();
+
+  //! @brief last frame handed to the running optimization and its pose at hand over (reference for the correction of newer frames)
+  Frame* _frame_last_handed_over = nullptr;
+  TransformMatrix3D _robot_to_world_last_handed_over = TransformMatrix3D::Identity();
+
+  //! @brief local maps of the graph handed to the running optimization (the graph is cleared afterwards if not incremental)
+  std::map<const Identifier, LocalMap*> _local_maps_handed_over;
+
+  //! @brief double buffered optimization result: written by the optimizer thread, applied by the tracking thread
+  std::vector<std::pair<Frame*, TransformMatrix3D>, Eigen::aligned_allocator<std::pair<Frame*, TransformMatrix3D>>> _poses_optimized;
+  std::vector<std::pair<Frame*, TransformMatrix3D>, Eigen::aligned_allocator<std::pair<Frame*, TransformMatrix3D>>> _poses_optimized_published;
+  OptimizationStatistics _statistics_published = OptimizationStatistics(0, 0, 0);
+
+  //ds optimizer thread and its state (asynchronous optimization)
+  std::thread _worker;
+  bool _is_running    = false;
+  bool _is_optimizing = false;
+  bool _has_result    = false;
+  std::mutex _mutex_optimization;
+  std::condition_variable _condition_optimization;
+
+  //! @brief bookkeeping: added frames and the odometry edge to their preceeding frame (by frame identifier)
   std::map<Frame*, g2o::VertexSE3*> _frames_in_pose_graph;
+  IdentifierHashMap<g2o::EdgeSE3*> _odometry_edges_in_pose_graph;
 
   //! @brief bookkeeping: added local maps
   std::map<const Identifier, LocalMap*> _local_maps_in_graph;
@@ -113,9 +312,44 @@ protected:
   //! @brief bookkeeping: added landmarks
   std::map<Landmark*, g2o::VertexPointXYZ*> _landmarks_in_pose_graph;
 
+  //! @brief incremental optimization: convergence based termination (warm started optimizations require few iterations)
+  g2o::SparseOptimizerTerminateAction* _terminate_action = nullptr;
+
+  //! @brief specialized pose graph solver (replaces the g2o pose graph if configured)
+  bool _is_pose_graph_solver_native = true;
+  PoseGraphSolver _pose_graph_solver;
+
+  //! @brief specialized pose graph solver bookkeeping: frame of each vertex, vertex of each frame and the last frame vertex added
+  //! and the odometry edge of each frame to its preceeding frame
+  std::vector<Frame*> _frames_in_pose_graph_solver;
+  IdentifierHashMap<Index> _vertex_indices_in_pose_graph_solver;
+  IdentifierHashMap<Index> _odometry_edge_indices_in_pose_graph_solver;
+  Index _index_vertex_frame_last_added = 0;
+
+  //! @brief local bundle adjustment: g2o optimizer (landmarks marginalized) and window bookkeeping, reused across calls
+  g2o::SparseOptimizer* _optimizer_local = nullptr;
+  std::vector<LocalMap*> _local_maps_in_window;
+  std::vector<g2o::VertexSE3*> _vertices_local_maps_in_window;
+  LandmarkPointerVector _landmarks_in_window;
+  std::vector<g2o::VertexPointXYZ*> _vertices_landmarks_in_window;
+  IdentifierHashMap<Index> _landmark_indices_in_window;
+
+  //! @brief local bundle adjustment: boundary candidates <number of observed window landmarks, local map> and the selected ones
+  std::vector<std::pair<Count, LocalMap*>> _local_maps_boundary;
+  IdentifierHashMap<Index> _local_map_indices_boundary;
+
+  //! @brief local bundle adjustment: framepoint measurements of a local map <window landmark index, coordinates in the keyframe>
+  //! and the local map that measured each landmark last (a single measurement per local map and landmark)
+  std::vector<std::pair<Index, PointCoordinates>> _measurements_local_map;
+  IdentifierHashMap<Identifier> _local_map_measuring_landmark;
+
   //ds informative only
   CREATE_CHRONOMETER(addition)
   CREATE_CHRONOMETER(optimization)
+  CREATE_CHRONOMETER(local_optimization)
   Count _number_of_optimizations = 0;
+  Count _number_of_local_optimizations = 0;
+  Count _number_of_skipped_local_optimizations = 0;
+  std::vector<OptimizationStatistics> _optimization_statistics;
 };
 }
@@ -0,0 +1,385 @@
+#include "pose_graph_solver.h"
+
+namespace proslam {
+
+//ds skew symmetric matrix of a vector (cross product)
+inline Matrix3 getSkew(const Vector3& vector_) {
+  Matrix3 skew;
+  skew <<           0, -vector_.z(),  vector_.y(),
+          vector_.z(),            0, -vector_.x(),
+         -vector_.y(),  vector_.x(),           0;
+  return skew;
+}
+
+void PoseGraphSolver::clear() {
+  _vertices.clear();
+  _edges.clear();
+  _H.resize(0, 0);
+  _b.resize(0);
+  _is_structure_changed    = true;
+  _is_pattern_changed      = false;
+  _is_factorized           = false;
+  _number_of_free_vertices = 0;
+  _number_of_blocks        = 0;
+  _chi2 = 0;
+}
+
+const Index PoseGraphSolver::addVertex(const TransformMatrix3D& estimate_, const bool& is_fixed_) {
+  _vertices.push_back(Vertex(estimate_, is_fixed_));
+
+  //ds a free vertex takes the next reserved block if available (fixed vertices have no block)
+  if (!is_fixed_ && !_is_structure_changed) {
+    if (_number_of_free_vertices < _number_of_blocks) {
+      _vertices.back().index_block = _number_of_free_vertices;
+      ++_number_of_free_vertices;
+    } else {
+      _is_structure_changed = true;
+    }
+  }
+  return _vertices.size()-1;
+}
+
+const Index PoseGraphSolver::addEdge(const Index& index_vertex_from_,
+                                     const Index& index_vertex_to_,
+                                     const TransformMatrix3D& transform_from_to_,
+                                     const Matrix6& information_,
+                                     const bool& enable_robust_kernel_) {
+  if (index_vertex_from_ >= _vertices.size() || index_vertex_to_ >= _vertices.size() || index_vertex_from_ == index_vertex_to_) {
+    throw std::runtime_error("PoseGraphSolver::addEdge|invalid vertices: " + std::to_string(index_vertex_from_) + " " + std::to_string(index_vertex_to_));
+  }
+  _edges.push_back(Edge(index_vertex_to_, index_vertex_from_, transform_from_to_.inverse(), information_, enable_robust_kernel_));
+
+  //ds if the blocks of the edge are not allocated: extend the pattern if they lie within the fill-in of the symbolic factorization,
+  //ds otherwise the structure has to be analyzed again (a new fill reducing ordering)
+  if (!_is_structure_changed && !_setOffsets(_edges.size()-1)) {
+    if (_isInFactor(_edges.size()-1)) {
+      _is_pattern_changed = true;
+    } else {
+      _is_structure_changed = true;
+    }
+  }
+  return _edges.size()-1;
+}
+
+void PoseGraphSolver::resetMeasurement(const Index& index_edge_) {
+  Edge& edge = _edges[index_edge_];
+
+  //ds the inverse measurement is stored: pose of the to vertex (a) in the from vertex (b)
+  edge.measurement_inverse = _vertices[edge.index_b].estimate.inverse()*_vertices[edge.index_a].estimate;
+}
+
+void PoseGraphSolver::setFixed(const Index& index_vertex_, const bool& is_fixed_) {
+  if (_vertices[index_vertex_].is_fixed != is_fixed_) {
+    _vertices[index_vertex_].is_fixed = is_fixed_;
+    _is_structure_changed = true;
+  }
+}
+
+const Count PoseGraphSolver::optimize(const Count& maximum_number_of_iterations_, const real& minimum_relative_gain_) {
+  if (_is_structure_changed) {
+    _analyzeStructure();
+  } else if (_is_pattern_changed) {
+    _allocatePattern();
+    ++_number_of_pattern_extensions;
+  }
+  _estimates_previous.resize(_vertices.size());
+  if (_number_of_free_vertices == 0) {
+    _chi2 = _computeChi2();
+    return 0;
+  }
+
+  //ds Gauss-Newton steps, falling back to increasingly damped steps (Levenberg-Marquardt, scaled diagonal) if a step does not decrease the error
+  real damping = 0;
+  Count number_of_iterations = 0;
+  for (; number_of_iterations < maximum_number_of_iterations_; ++number_of_iterations) {
+    const real chi2 = _linearize();
+    _chi2 = chi2;
+    for (Index index_vertex = 0; index_vertex < _vertices.size(); ++index_vertex) {
+      _estimates_previous[index_vertex] = _vertices[index_vertex].estimate;
+    }
+    for (Index index_diagonal = 0; index_diagonal < _diagonal_offsets.size(); ++index_diagonal) {
+      _diagonal[index_diagonal] = _H.valuePtr()[_diagonal_offsets[index_diagonal]];
+    }
+
+    bool is_improved = false;
+    for (Count number_of_trials = 0; number_of_trials < _maximum_number_of_damping_trials; ++number_of_trials) {
+      for (Index index_diagonal = 0; index_diagonal < _diagonal_offsets.size(); ++index_diagonal) {
+        _H.valuePtr()[_diagonal_offsets[index_diagonal]] = (1+damping)*_diagonal[index_diagonal];
+      }
+
+      //ds solve the normal equations (numeric factorization only)
+      _decomposition.factorize(_H);
+      _is_factorized = (_decomposition.info() == Eigen::Success);
+      if (_is_factorized) {
+        _update(_decomposition.solve(-_b));
+
+        //ds accept the step if it decreased the error, otherwise revert and increase the damping
+        const real chi2_updated = _computeChi2();
+        if (chi2_updated <= chi2) {
+          _chi2       = chi2_updated;
+          is_improved = true;
+          break;
+        }
+        for (Index index_vertex = 0; index_vertex < _vertices.size(); ++index_vertex) {
+          _vertices[index_vertex].estimate = _estimates_previous[index_vertex];
+        }
+      }
+      damping = (damping == 0)? 1e-3: 10*damping;
+    }
+    if (!is_improved) {
+      LOG_WARNING(std::cerr << "PoseGraphSolver::optimize|unable to decrease chi2: " << chi2 << std::endl)
+      break;
+    }
+    damping = (damping > 1e-3)? damping/10: 0;
+
+    //ds check convergence
+    if (chi2 == 0 || (chi2-_chi2)/chi2 < minimum_relative_gain_) {
+      ++number_of_iterations;
+      break;
+    }
+  }
+  return number_of_iterations;
+}
+
+void PoseGraphSolver::_update(const Eigen::Matrix<real, Eigen::Dynamic, 1>& perturbation_) {
+
+  //ds apply the perturbation on the right of the free poses (translation in the local frame, rotation vector)
+  for (Vertex& vertex: _vertices) {
+    if (!vertex.is_fixed) {
+      const Vector6 delta = perturbation_.segment<6>(6*vertex.index_block);
+      const Vector3 rotation_vector = delta.tail<3>();
+      const real angle = rotation_vector.norm();
+      vertex.estimate.translation() += vertex.estimate.linear()*delta.head<3>();
+      if (angle > 0) {
+        vertex.estimate.linear() = vertex.estimate.linear()*Eigen::AngleAxis<real>(angle, rotation_vector/angle).toRotationMatrix();
+      }
+    }
+  }
+}
+
+void PoseGraphSolver::_analyzeStructure() {
+
+  //ds assign the blocks of the free vertices, followed by the reserved blocks
+  _number_of_free_vertices = 0;
+  for (Vertex& vertex: _vertices) {
+    if (!vertex.is_fixed) {
+      vertex.index_block = _number_of_free_vertices;
+      ++_number_of_free_vertices;
+    }
+  }
+  _number_of_blocks = (_number_of_free_vertices > 0)? _number_of_free_vertices+_number_of_reserved_vertices: 0;
+  _index_block_reserved_begin = _number_of_free_vertices;
+  _H.resize(6*_number_of_blocks, 6*_number_of_blocks);
+  _b.resize(6*_number_of_blocks);
+  _is_factorized = false;
+  if (_number_of_blocks == 0) {
+    _is_structure_changed = false;
+    _is_pattern_changed   = false;
+    return;
+  }
+  _allocatePattern();
+
+  //ds symbolic factorization (fill reducing ordering and elimination tree), kept until the structure changes
+  _decomposition.analyzePattern(_H);
+  ++_number_of_symbolic_factorizations;
+  _is_structure_changed = false;
+}
+
+void PoseGraphSolver::_allocatePattern() {
+
+  //ds allocate the pattern: dense diagonal blocks, the lower off-diagonal block of each edge between free vertices
+  //ds and the blocks connecting each reserved block to its predecessor (an appended vertex with odometry)
+  std::vector<Eigen::Triplet<real>> entries;
+  entries.reserve(36*(2*_number_of_blocks+_edges.size()));
+  auto addBlock = [&entries](const Index& index_row_, const Index& index_column_) {
+    for (Index c = 0; c < 6; ++c) {
+      for (Index r = 0; r < 6; ++r) {
+        entries.push_back(Eigen::Triplet<real>(6*index_row_+r, 6*index_column_+c, 0));
+      }
+    }
+  };
+  for (Index index_block = 0; index_block < _number_of_blocks; ++index_block) {
+    addBlock(index_block, index_block);
+    if (index_block >= _index_block_reserved_begin && index_block > 0) {
+      addBlock(index_block, index_block-1);
+    }
+  }
+  for (const Edge& edge: _edges) {
+    const Vertex& vertex_a = _vertices[edge.index_a];
+    const Vertex& vertex_b = _vertices[edge.index_b];
+    if (!vertex_a.is_fixed && !vertex_b.is_fixed) {
+      addBlock(std::max(vertex_a.index_block, vertex_b.index_block), std::min(vertex_a.index_block, vertex_b.index_block));
+    }
+  }
+  _H.setFromTriplets(entries.begin(), entries.end());
+  _H.makeCompressed();
+
+  //ds cache the value offsets of the edges and the diagonal (damping)
+  for (Index index_edge = 0; index_edge < _edges.size(); ++index_edge) {
+    _setOffsets(index_edge);
+  }
+  _diagonal_offsets.resize(6*_number_of_blocks);
+  _diagonal.resize(6*_number_of_blocks);
+  for (Index index_diagonal = 0; index_diagonal < _diagonal_offsets.size(); ++index_diagonal) {
+    _getOffset(index_diagonal, index_diagonal, _diagonal_offsets[index_diagonal]);
+  }
+  _is_pattern_changed = false;
+}
+
+const bool PoseGraphSolver::_getOffset(const Index& row_, const Index& column_, Index& offset_) const {
+  const int* inner_indices = _H.innerIndexPtr();
+  const int* end = inner_indices+_H.outerIndexPtr()[column_+1];
+  const int* entry = std::lower_bound(inner_indices+_H.outerIndexPtr()[column_], end, static_cast<int>(row_));
+  offset_ = entry-inner_indices;
+  return entry != end && *entry == static_cast<int>(row_);
+}
+
+const bool PoseGraphSolver::_setOffsets(const Index& index_edge_) {
+  Edge& edge = _edges[index_edge_];
+  const Vertex& vertex_a = _vertices[edge.index_a];
+  const Vertex& vertex_b = _vertices[edge.index_b];
+
+  //ds the diagonal blocks are always allocated, the 6 rows of a block are contiguous in a compressed column
+  for (Index c = 0; c < 6; ++c) {
+    if (!vertex_a.is_fixed) {
+      _getOffset(6*vertex_a.index_block, 6*vertex_a.index_block+c, edge.offsets_aa[c]);
+    }
+    if (!vertex_b.is_fixed) {
+      _getOffset(6*vertex_b.index_block, 6*vertex_b.index_block+c, edge.offsets_bb[c]);
+    }
+    if (!vertex_a.is_fixed && !vertex_b.is_fixed) {
+      const Index index_row    = std::max(vertex_a.index_block, vertex_b.index_block);
+      const Index index_column = std::min(vertex_a.index_block, vertex_b.index_block);
+      if (!_getOffset(6*index_row, 6*index_column+c, edge.offsets_ab[c])) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+const bool PoseGraphSolver::_isInFactor(const Index& index_edge_) const {
+  if (!_is_factorized) {
+    return false;
+  }
+
+  //ds the symbolic factorization remains valid for entries that are structural nonzeros of the factor L (permuted)
+  const Eigen::SparseMatrix<real>& factor = _decomposition.matrixL().nestedExpression();
+  const Eigen::SparseMatrix<real>::StorageIndex* permutation = _decomposition.permutationP().indices().data();
+  const Index index_block_a = _vertices[_edges[index_edge_].index_a].index_block;
+  const Index index_block_b = _vertices[_edges[index_edge_].index_b].index_block;
+  for (Index c = 0; c < 6; ++c) {
+    for (Index r = 0; r < 6; ++r) {
+      const int index_a = permutation[6*index_block_a+r];
+      const int index_b = permutation[6*index_block_b+c];
+      const int* end = factor.innerIndexPtr()+factor.outerIndexPtr()[std::min(index_a, index_b)+1];
+      const int* entry = std::lower_bound(factor.innerIndexPtr()+factor.outerIndexPtr()[std::min(index_a, index_b)], end, std::max(index_a, index_b));
+      if (entry == end || *entry != std::max(index_a, index_b)) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+const real PoseGraphSolver::_computeError(const Index& index_edge_, Vector6& error_, Matrix6& jacobian_a_, Matrix6& jacobian_b_, real& weight_) const {
+  const Edge& edge = _edges[index_edge_];
+  const TransformMatrix3D& pose_a = _vertices[edge.index_a].estimate;
+  const TransformMatrix3D& pose_b = _vertices[edge.index_b].estimate;
+
+  //ds relative pose and its deviation from the measurement: translation and vector part of the unit quaternion with non-negative real part (as g2o)
+  const TransformMatrix3D b_in_a(pose_a.inverse()*pose_b);
+  const TransformMatrix3D deviation(edge.measurement_inverse*b_in_a);
+  Quaternion rotation(deviation.linear());
+  rotation.normalize();
+  if (rotation.w() < 0) {
+    rotation.coeffs() *= -1;
+  }
+  error_.head<3>() = deviation.translation();
+  error_.tail<3>() = rotation.vec();
+
+  //ds analytic jacobians for right perturbations (translation, rotation vector) of both poses
+  //ds the quaternion vector part changes with 0.5*(w*I+[v]x) for a right perturbation of the deviation
+  const Matrix3 quaternion_jacobian = 0.5*(rotation.w()*Matrix3::Identity()+getSkew(rotation.vec()));
+  const Matrix3& measurement_rotation_transposed = edge.measurement_inverse.linear();
+  jacobian_a_.block<3,3>(0,0) = -measurement_rotation_transposed;
+  jacobian_a_.block<3,3>(0,3) = measurement_rotation_transposed*getSkew(b_in_a.translation());
+  jacobian_a_.block<3,3>(3,0).setZero();
+  jacobian_a_.block<3,3>(3,3) = -quaternion_jacobian*b_in_a.linear().transpose();
+  jacobian_b_.block<3,3>(0,0) = deviation.linear();
+  jacobian_b_.block<3,3>(0,3).setZero();
+  jacobian_b_.block<3,3>(3,0).setZero();
+  jacobian_b_.block<3,3>(3,3) = quaternion_jacobian;
+
+  //ds Cauchy kernel (unit width, as g2o)
+  const real chi2 = error_.transpose()*edge.information*error_;
+  if (edge.enable_robust_kernel) {
+    weight_ = 1/(1+chi2);
+    return std::log1p(chi2);
+  } else {
+    weight_ = 1;
+    return chi2;
+  }
+}
+
+const real PoseGraphSolver::_computeChi2() const {
+  real chi2 = 0;
+  Vector6 error;
+  Matrix6 jacobian_a;
+  Matrix6 jacobian_b;
+  real weight = 1;
+  for (Index index_edge = 0; index_edge < _edges.size(); ++index_edge) {
+    chi2 += _computeError(index_edge, error, jacobian_a, jacobian_b, weight);
+  }
+  return chi2;
+}
+
+const real PoseGraphSolver::_linearize() {
+  std::fill(_H.valuePtr(), _H.valuePtr()+_H.nonZeros(), 0);
+  _b.setZero();
+
+  //ds unused reserved blocks are decoupled (identity)
+  for (Index index_diagonal = 6*_number_of_free_vertices; index_diagonal < _diagonal_offsets.size(); ++index_diagonal) {
+    _H.valuePtr()[_diagonal_offsets[index_diagonal]] = 1;
+  }
+  real chi2 = 0;
+  Vector6 error;
+  Matrix6 jacobian_a;
+  Matrix6 jacobian_b;
+  real weight = 1;
+  for (Index index_edge = 0; index_edge < _edges.size(); ++index_edge) {
+    chi2 += _computeError(index_edge, error, jacobian_a, jacobian_b, weight);
+    const Edge& edge = _edges[index_edge];
+    const Vertex& vertex_a = _vertices[edge.index_a];
+    const Vertex& vertex_b = _vertices[edge.index_b];
+    const Matrix6 information = weight*edge.information;
+    const Matrix6 jacobian_a_transposed_information = jacobian_a.transpose()*information;
+    const Matrix6 jacobian_b_transposed_information = jacobian_b.transpose()*information;
+    if (!vertex_a.is_fixed) {
+      _addBlock(edge.offsets_aa, jacobian_a_transposed_information*jacobian_a);
+      _b.segment<6>(6*vertex_a.index_block) += jacobian_a_transposed_information*error;
+    }
+    if (!vertex_b.is_fixed) {
+      _addBlock(edge.offsets_bb, jacobian_b_transposed_information*jacobian_b);
+      _b.segment<6>(6*vertex_b.index_block) += jacobian_b_transposed_information*error;
+    }
+    if (!vertex_a.is_fixed && !vertex_b.is_fixed) {
+      if (vertex_a.index_block > vertex_b.index_block) {
+        _addBlock(edge.offsets_ab, jacobian_a_transposed_information*jacobian_b);
+      } else {
+        _addBlock(edge.offsets_ab, jacobian_b_transposed_information*jacobian_a);
+      }
+    }
+  }
+  return chi2;
+}
+
+void PoseGraphSolver::_addBlock(const Index* offsets_, const Matrix6& block_) {
+  real* values = _H.valuePtr();
+  for (Index c = 0; c < 6; ++c) {
+    for (Index r = 0; r < 6; ++r) {
+      values[offsets_[c]+r] += block_(r, c);
+    }
+  }
+}
+}
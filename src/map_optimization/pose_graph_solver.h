@@ -0,0 +1,215 @@
+#pragma once
+#include <Eigen/SparseCore>
+#include <Eigen/SparseCholesky>
+#include "types/definitions.h"
+
+namespace proslam {
+
+//ds fill reducing ordering (AMD) of the 6x6 block structure of a pose graph system, expanded to its scalar entries (blocks stay contiguous)
+//ds the block pattern is 36 times smaller than the scalar one, which makes the symbolic factorization considerably cheaper
+template<typename StorageIndex_>
+struct BlockAMDOrdering {
+  typedef Eigen::PermutationMatrix<Eigen::Dynamic, Eigen::Dynamic, StorageIndex_> PermutationType;
+
+  template<typename MatrixType_>
+  void operator()(const MatrixType_& matrix_, PermutationType& permutation_) {
+    const StorageIndex_ number_of_blocks = matrix_.cols()/6;
+
+    //ds the blocks are dense: the first column of a block column contains the first row of each of its blocks
+    std::vector<Eigen::Triplet<real, StorageIndex_>> entries;
+    entries.reserve(matrix_.nonZeros()/36);
+    for (StorageIndex_ index_block = 0; index_block < number_of_blocks; ++index_block) {
+      for (typename MatrixType_::InnerIterator iterator(matrix_, 6*index_block); iterator; ++iterator) {
+        if (iterator.index()%6 == 0) {
+          entries.push_back(Eigen::Triplet<real, StorageIndex_>(iterator.index()/6, index_block, 1));
+        }
+      }
+    }
+    Eigen::SparseMatrix<real, Eigen::ColMajor, StorageIndex_> pattern(number_of_blocks, number_of_blocks);
+    pattern.setFromTriplets(entries.begin(), entries.end());
+    PermutationType permutation_blocks;
+    Eigen::AMDOrdering<StorageIndex_>()(pattern, permutation_blocks);
+    permutation_.resize(matrix_.cols());
+    for (StorageIndex_ index_block = 0; index_block < number_of_blocks; ++index_block) {
+      for (StorageIndex_ r = 0; r < 6; ++r) {
+        permutation_.indices()[6*index_block+r] = 6*permutation_blocks.indices()[index_block]+r;
+      }
+    }
+  }
+};
+
+//ds Gauss-Newton solver specialized for SE(3) pose graphs (pose vertices and relative pose edges only)
+//ds the jacobians are analytic and the normal equations are solved with a sparse Cholesky (LDLT) decomposition on the 6x6 block structure,
+//ds whose symbolic factorization is cached while the graph grows within it: appended vertices take reserved blocks (connected to their
+//ds predecessor) and edges within the fill-in of the factor extend the pattern only, other changes require a new symbolic factorization
+class PoseGraphSolver {
+
+//ds exported types
+public: EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+
+  typedef Eigen::Matrix<real, 6, 6> Matrix6;
+  typedef Eigen::Matrix<real, 6, 1> Vector6;
+
+//ds object handling
+public:
+
+  PoseGraphSolver() {}
+  ~PoseGraphSolver() {}
+
+//ds functionality
+public:
+
+  //! @brief removes all vertices and edges
+  void clear();
+
+  //! @brief adds a pose vertex
+  //! @param[in] estimate_ initial pose estimate
+  //! @param[in] is_fixed_ fixed vertices are not optimized
+  //! @return index of the vertex
+  const Index addVertex(const TransformMatrix3D& estimate_, const bool& is_fixed_ = false);
+
+  //! @brief adds a relative pose constraint with the semantics of g2o::EdgeSE3 (information matrix in translation, rotation order)
+  //! the rotational error is the vector part of the error quaternion (non-negative real part), as minimized by g2o
+  //! @param[in] index_vertex_from_ vertex of which the pose is measured
+  //! @param[in] index_vertex_to_ vertex in which the pose is measured
+  //! @param[in] transform_from_to_ measured pose of the from vertex in the to vertex
+  //! @param[in] information_ information matrix of the measurement
+  //! @param[in] enable_robust_kernel_ weights the constraint with a Cauchy kernel
+  //! @return index of the edge
+  const Index addEdge(const Index& index_vertex_from_,
+                      const Index& index_vertex_to_,
+                      const TransformMatrix3D& transform_from_to_,
+                      const Matrix6& information_,
+                      const bool& enable_robust_kernel_ = false);
+
+  //! @brief replaces the measurement of an edge by the relative pose of its current vertex estimates
+  //! @param[in] index_edge_ the edge to re-measure
+  void resetMeasurement(const Index& index_edge_);
+
+  //! @brief optimizes the free vertices with Gauss-Newton steps (damped if a step does not decrease chi2), stopping after
+  //! the maximum number of iterations, once the relative chi2 gain drops below the provided threshold or if chi2 cannot be decreased
+  //! @param[in] maximum_number_of_iterations_ maximum number of Gauss-Newton iterations
+  //! @param[in] minimum_relative_gain_ relative chi2 gain threshold for termination
+  //! @return number of performed iterations
+  const Count optimize(const Count& maximum_number_of_iterations_, const real& minimum_relative_gain_ = 0);
+
+//ds getters/setters
+public:
+
+  inline const TransformMatrix3D& estimate(const Index& index_vertex_) const {return _vertices[index_vertex_].estimate;}
+  inline void setEstimate(const Index& index_vertex_, const TransformMatrix3D& estimate_) {_vertices[index_vertex_].estimate = estimate_;}
+  void setFixed(const Index& index_vertex_, const bool& is_fixed_);
+
+  //! @brief number of blocks allocated beyond the free vertices at the next symbolic factorization (incremental use)
+  //! each reserved block is connected to its predecessor: vertices appended with an edge to the preceeding vertex keep the factorization
+  inline void setNumberOfReservedVertices(const Count& number_of_reserved_vertices_) {_number_of_reserved_vertices = number_of_reserved_vertices_;}
+  inline const Count numberOfVertices() const {return _vertices.size();}
+  inline const Count numberOfEdges() const {return _edges.size();}
+  inline const real chi2() const {return _chi2;}
+  inline const Count numberOfSymbolicFactorizations() const {return _number_of_symbolic_factorizations;}
+  inline const Count numberOfPatternExtensions() const {return _number_of_pattern_extensions;}
+
+//ds helpers
+protected:
+
+  //! @brief assigns the blocks of the free vertices and the reserved blocks, allocates the sparsity pattern and analyzes it symbolically
+  void _analyzeStructure();
+
+  //! @brief allocates the sparsity pattern of the system for the assigned blocks and caches the value offsets
+  void _allocatePattern();
+
+  //! @brief retrieves the value offset of an entry of the system
+  //! @return true if the entry is allocated (otherwise the offset is its insertion position)
+  const bool _getOffset(const Index& row_, const Index& column_, Index& offset_) const;
+
+  //! @brief caches the value offsets of the blocks of an edge
+  //! @return true if all blocks of the edge are allocated
+  const bool _setOffsets(const Index& index_edge_);
+
+  //! @brief checks if the off-diagonal block of an edge lies within the structure of the last factorization (its fill-in)
+  const bool _isInFactor(const Index& index_edge_) const;
+
+  //! @brief computes the error and its jacobians with respect to the to (a) and from (b) vertex of an edge
+  //! @return robustified chi2 of the edge
+  const real _computeError(const Index& index_edge_, Vector6& error_, Matrix6& jacobian_a_, Matrix6& jacobian_b_, real& weight_) const;
+
+  //! @brief computes the robustified chi2 of the current estimates
+  const real _computeChi2() const;
+
+  //! @brief fills the values of the normal equations in place (the sparsity pattern is fixed)
+  //! @return robustified chi2 of the current estimates
+  const real _linearize();
+
+  //! @brief applies a perturbation to the free poses
+  void _update(const Eigen::Matrix<real, Eigen::Dynamic, 1>& perturbation_);
+
+  //! @brief adds a 6x6 block to the system at the cached value offsets (6 column offsets)
+  void _addBlock(const Index* offsets_, const Matrix6& block_);
+
+//ds attributes
+protected:
+
+  //ds pose vertex
+  struct Vertex {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Vertex(const TransformMatrix3D& estimate_, const bool& is_fixed_): estimate(estimate_), is_fixed(is_fixed_) {}
+    TransformMatrix3D estimate;
+    bool is_fixed;
+    Index index_block = 0;
+  };
+
+  //ds relative pose edge: error of measured_to_from*to_to_world*from_to_world (a: to, b: from)
+  struct Edge {
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    Edge(const Index& index_a_,
+         const Index& index_b_,
+         const TransformMatrix3D& measurement_inverse_,
+         const Matrix6& information_,
+         const bool& enable_robust_kernel_): index_a(index_a_),
+                                             index_b(index_b_),
+                                             measurement_inverse(measurement_inverse_),
+                                             information(information_),
+                                             enable_robust_kernel(enable_robust_kernel_) {}
+    Index index_a;
+    Index index_b;
+    TransformMatrix3D measurement_inverse;
+    Matrix6 information;
+    bool enable_robust_kernel;
+
+    //ds value offsets of the system blocks aa, bb and the lower off-diagonal block for each of the 6 block columns
+    Index offsets_aa[6] = {0, 0, 0, 0, 0, 0};
+    Index offsets_bb[6] = {0, 0, 0, 0, 0, 0};
+    Index offsets_ab[6] = {0, 0, 0, 0, 0, 0};
+  };
+
+  std::vector<Vertex, Eigen::aligned_allocator<Vertex>> _vertices;
+  std::vector<Edge, Eigen::aligned_allocator<Edge>> _edges;
+
+  //ds normal equations (lower triangle plus full diagonal blocks) and the decomposition with cached symbolic factorization
+  Eigen::SparseMatrix<real> _H;
+  Eigen::Matrix<real, Eigen::Dynamic, 1> _b;
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<real>, Eigen::Lower, BlockAMDOrdering<int>> _decomposition;
+  bool _is_structure_changed = true;
+  bool _is_pattern_changed   = false;
+  bool _is_factorized        = false;
+  Count _number_of_free_vertices = 0;
+
+  //ds allocated blocks (free vertices followed by reserved ones), the first reserved block at the last analysis and the reserve
+  Count _number_of_blocks = 0;
+  Index _index_block_reserved_begin = 0;
+  Count _number_of_reserved_vertices = 0;
+
+  //ds estimates before the last update (reverted if chi2 increased)
+  std::vector<TransformMatrix3D, Eigen::aligned_allocator<TransformMatrix3D>> _estimates_previous;
+
+  //ds undamped diagonal of the system and its value offsets (damped steps)
+  std::vector<Index> _diagonal_offsets;
+  Eigen::Matrix<real, Eigen::Dynamic, 1> _diagonal;
+  const Count _maximum_number_of_damping_trials = 10;
+
+  //ds informative only
+  real _chi2 = 0;
+  Count _number_of_symbolic_factorizations = 0;
+  Count _number_of_pattern_extensions = 0;
+};
+}
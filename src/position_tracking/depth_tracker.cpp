@@ -34,7 +34,104 @@ namespace proslam {
     BaseTracker::compute();
   }
 
+  //ds attempts to recover framepoints in the current image using the more precise pose estimate, retrieved after pose optimization
   void DepthTracker::_recoverPoints(Frame* current_frame_) {
-    return;
+
+    //ds precompute transforms
+    const TransformMatrix3D world_to_camera_left  = current_frame_->worldToCameraLeft();
+    const CameraMatrix& camera_calibration_matrix = _camera_left->cameraMatrix();
+
+    //ds obtain currently active tracking distance
+    const real maximum_descriptor_distance = _framepoint_generator->parameters()->matching_distance_tracking_threshold;
+
+    //ds buffers
+    const cv::Mat& intensity_image_left = current_frame_->intensityImageLeft();
+    std::vector<cv::KeyPoint> keypoint_buffer_left(1);
+
+    //ds recover lost landmarks
+    Index index_lost_point_recovered = _number_of_tracked_points;
+    current_frame_->points().resize(_number_of_tracked_points+_number_of_lost_points);
+    for (FramePoint* point_previous: _lost_points) {
+
+      //ds skip non landmarks for now (TODO parametrize)
+      if (!point_previous->landmark()) {
+        continue;
+      }
+      point_previous->landmark()->incrementNumberOfRecoveries();
+
+      //ds get point in camera frame based on landmark coordinates
+      const PointCoordinates point_in_camera_left(world_to_camera_left*point_previous->landmark()->coordinates());
+      if (point_in_camera_left.z() <= 0) {
+        continue;
+      }
+
+      //ds obtain point projection on camera image plane
+      PointCoordinates point_in_image_left = camera_calibration_matrix*point_in_camera_left;
+      point_in_image_left /= point_in_image_left.z();
+
+      //ds set projection - at subpixel accuarcy
+      const cv::Point2f projection_left(point_in_image_left.x(), point_in_image_left.y());
+
+      //ds this can be moved outside of the loop if keypoint sizes are constant
+      const float regional_border_center = 5*point_previous->keypointLeft().size;
+      const cv::Point2f offset_keypoint_half(regional_border_center, regional_border_center);
+      const float regional_full_height = regional_border_center+regional_border_center+1;
+
+      //ds if available search range is insufficient (also covers out of FOV projections)
+      if (projection_left.x <= regional_border_center+1                                   ||
+          projection_left.x >= _camera_left->numberOfImageCols()-regional_border_center-1 ||
+          projection_left.y <= regional_border_center+1                                   ||
+          projection_left.y >= _camera_left->numberOfImageRows()-regional_border_center-1 ) {
+
+        //ds skip complete tracking
+        continue;
+      }
+
+      //ds left search region
+      const cv::Point2f corner_left(projection_left-offset_keypoint_half);
+      const cv::Rect_<float> region_of_interest_left(corner_left.x, corner_left.y, regional_full_height, regional_full_height);
+
+      //ds extract descriptors at this position: LEFT
+      keypoint_buffer_left[0]    = point_previous->keypointLeft();
+      keypoint_buffer_left[0].pt = offset_keypoint_half;
+      cv::Mat descriptor_left;
+      const cv::Mat roi_left(intensity_image_left(region_of_interest_left));
+      _framepoint_generator->descriptorExtractor()->compute(roi_left, keypoint_buffer_left, descriptor_left);
+
+      //ds if no descriptor could be computed
+      if (descriptor_left.rows == 0) {
+        continue;
+      }
+
+      //ds if descriptor distance is to high
+      if (cv::norm(point_previous->descriptorLeft(), descriptor_left, SRRG_PROSLAM_DESCRIPTOR_NORM) > maximum_descriptor_distance) {
+        continue;
+      }
+      keypoint_buffer_left[0].pt += corner_left;
+
+      //ds retrieve the measured depth at the recovered position
+      PointCoordinates point_in_camera_left_measured(PointCoordinates::Zero());
+      cv::KeyPoint keypoint_depth(keypoint_buffer_left[0]);
+      _depth_framepoint_generator->registerDepth(keypoint_buffer_left[0].pt);
+      if (!_depth_framepoint_generator->getPointInLeftCamera(keypoint_buffer_left[0].pt, point_in_camera_left_measured, keypoint_depth.pt)) {
+        continue;
+      }
+
+      //ds allocate a new point connected to the previous one
+      FramePoint* current_point = current_frame_->createFramepoint(keypoint_buffer_left[0],
+                                                                   descriptor_left,
+                                                                   keypoint_depth,
+                                                                   descriptor_left,
+                                                                   point_in_camera_left_measured,
+                                                                   point_previous);
+
+      //ds set the point to the control structure
+      current_frame_->points()[index_lost_point_recovered] = current_point;
+      ++index_lost_point_recovered;
+    }
+    _number_of_recovered_points = index_lost_point_recovered-_number_of_tracked_points;
+    _number_of_tracked_points = index_lost_point_recovered;
+    current_frame_->points().resize(_number_of_tracked_points);
+    LOG_DEBUG(std::cerr << "DepthTracker::_recoverPoints|recovered points: " << _number_of_recovered_points << "/" << _number_of_lost_points << std::endl)
   }
 }
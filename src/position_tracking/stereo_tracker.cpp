@@ -184,5 +184,54 @@ namespace proslam {
     _number_of_tracked_points = index_lost_point_recovered;
     current_frame_->points().resize(_number_of_tracked_points);
     LOG_DEBUG(std::cerr << "StereoTracker::_recoverPoints|recovered points: " << _number_of_recovered_points << "/" << _number_of_lost_points << std::endl)
+
+    //ds recover landmarks which have been lost before the previous frame
+    if (_parameters->enable_map_point_recovery) {
+      _recoverPointsFromMap(current_frame_);
+    }
+  }
+
+  void StereoTracker::_recoverPointsFromMap(Frame* current_frame_) {
+    _number_of_recovered_map_points = 0;
+    const TransformMatrix3D world_to_camera_left = current_frame_->worldToCameraLeft();
+
+    //ds retrieve landmarks in the current camera frustum
+    _context->landmarkVoxelHash().getObjectsInFrustum(world_to_camera_left,
+                                                      _camera_left->cameraMatrix(),
+                                                      _camera_left->numberOfImageRows(),
+                                                      _camera_left->numberOfImageCols(),
+                                                      0,
+                                                      _parameters->maximum_depth_for_map_point_recovery_meters,
+                                                      _landmarks_in_frustum);
+
+    //ds keep landmarks without track in the current frame (their last measurement has no successor)
+    //ds landmarks of other track segments are skipped: their coordinates are not expressed in the frame of the current segment
+    const Frame* root = current_frame_->root();
+    _framepoints_to_recover.clear();
+    _points_in_camera_left_to_recover.clear();
+    for (Landmark* landmark: _landmarks_in_frustum) {
+      FramePoint* last_update = landmark->lastUpdate();
+      if (!last_update || last_update->next() || last_update->frame() == current_frame_) {
+        continue;
+      }
+      if (!landmark->origin() || (landmark->origin()->frame() != root && landmark->origin()->frame()->root() != root)) {
+        continue;
+      }
+      _framepoints_to_recover.push_back(last_update);
+      _points_in_camera_left_to_recover.push_back(world_to_camera_left*landmark->coordinates());
+    }
+
+    //ds match the landmark projections against the unassigned keypoints (recovered framepoints are added to the frame)
+    if (!_framepoints_to_recover.empty()) {
+      _number_of_recovered_map_points = _stereo_framepoint_generator->recover(current_frame_,
+                                                                              _framepoints_to_recover,
+                                                                              _points_in_camera_left_to_recover,
+                                                                              _parameters->map_point_recovery_search_distance_pixels);
+    }
+    _number_of_recovered_points           += _number_of_recovered_map_points;
+    _number_of_tracked_points             += _number_of_recovered_map_points;
+    _total_number_of_recovered_map_points += _number_of_recovered_map_points;
+    LOG_DEBUG(std::cerr << "StereoTracker::_recoverPointsFromMap|recovered points: " << _number_of_recovered_map_points
+                        << "/" << _framepoints_to_recover.size() << " (landmarks in frustum: " << _landmarks_in_frustum.size() << ")" << std::endl)
   }
 }
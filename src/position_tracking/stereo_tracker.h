@@ -21,6 +21,7 @@ public:
 
   void setCameraRight(const Camera* camera_right_) {_camera_right = camera_right_;}
   void setIntensityImageRight(const cv::Mat& intensity_image_right_) {_intensity_image_right = intensity_image_right_;}
+  const Count& totalNumberOfRecoveredMapPoints() const {return _total_number_of_recovered_map_points;}
 
 //ds helpers
 protected:
@@ -31,6 +32,11 @@ protected:
   //ds attempts to recover framepoints in the current image using the more precise pose estimate, retrieved after pose optimization
   virtual void _recoverPoints(Frame* current_frame_);
 
+  //! @brief attempts to continue the tracks of landmarks in the camera frustum that are not tracked in the current frame (e.g. after occlusions)
+  //! landmark projections are matched against the keypoints that have not been assigned by tracking
+  //! @param[in, out] current_frame_ frame with refined pose to which recovered framepoints are added
+  void _recoverPointsFromMap(Frame* current_frame_);
+
 //ds attributes
 protected:
 
@@ -42,5 +48,14 @@ protected:
 
   //ds specified generator instance
   StereoFramePointGenerator* _stereo_framepoint_generator = nullptr;
+
+  //ds map point recovery buffers
+  LandmarkPointerVector _landmarks_in_frustum;
+  FramePointPointerVector _framepoints_to_recover;
+  std::vector<PointCoordinates> _points_in_camera_left_to_recover;
+
+  //ds informative only
+  Count _number_of_recovered_map_points       = 0;
+  Count _total_number_of_recovered_map_points = 0;
 };
 }
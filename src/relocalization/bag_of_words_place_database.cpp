@@ -0,0 +1,243 @@
+#include "bag_of_words_place_database.h"
+
+namespace proslam {
+
+BagOfWordsPlaceDatabase::BagOfWordsPlaceDatabase(const RelocalizerParameters* parameters_): BasePlaceDatabase(parameters_) {
+  if (_parameters->bag_of_words_branching_factor == 0 || _parameters->bag_of_words_depth == 0 || _parameters->bag_of_words_maximum_number_of_words == 0) {
+    throw std::runtime_error("BagOfWordsPlaceDatabase::BagOfWordsPlaceDatabase|invalid vocabulary configuration");
+  }
+  _nodes.push_back(Node(HBSTMatchable::Descriptor()));
+
+  //ds the radius shrinks linearly from half the descriptor size below the root to the word radius at the leaves
+  const real radius_root = std::max(_parameters->bag_of_words_word_radius, static_cast<real>(SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS)/2);
+  const Count& depth     = _parameters->bag_of_words_depth;
+  for (Count level = 0; level < depth; ++level) {
+    _radius_per_level.push_back(_parameters->bag_of_words_word_radius+(radius_root-_parameters->bag_of_words_word_radius)*(depth-1-level)/depth);
+  }
+}
+
+void BagOfWordsPlaceDatabase::add(const HBSTTree::MatchableVector& matchables_) {
+  if (matchables_.empty()) {
+    return;
+  }
+  const uint64_t identifier_place = _getPlaceIdentifier(matchables_.front());
+  const std::pair<PlaceStatistics*, bool> result = _statistics_per_place.insert(identifier_place, PlaceStatistics());
+  PlaceStatistics* statistics = result.first;
+  const bool is_new_place     = result.second;
+  if (is_new_place) {
+    _place_identifiers.push_back(identifier_place);
+  }
+
+  //ds quantize the descriptors, extending the vocabulary if required
+  for (HBSTMatchable* matchable: matchables_) {
+    const Index index_word      = _addWord(matchable->descriptor);
+    std::vector<Entry>& entries = _inverted_index[index_word];
+
+    //ds an extended place (e.g. folded local map) keeps its entries contiguous
+    std::vector<Entry>::iterator iterator_place = entries.end();
+    if (is_new_place) {
+      if (!entries.empty() && entries.back().identifier_place == identifier_place) {
+        iterator_place = entries.end()-1;
+      }
+    } else {
+      iterator_place = std::find_if(entries.begin(), entries.end(), [&identifier_place](const Entry& entry_){return entry_.identifier_place == identifier_place;});
+    }
+    if (iterator_place == entries.end()) {
+
+      //ds the place observes the word for the first time: its document frequency changes for all places observing it
+      Count& number_of_places = _number_of_places_per_word[index_word];
+      const real delta        = std::log(static_cast<real>(2+number_of_places))-std::log(static_cast<real>(1+number_of_places));
+      for (const Entry& entry: entries) {
+        _statistics_per_place.find(entry.identifier_place)->sum_of_logarithmic_frequencies += delta;
+      }
+      ++number_of_places;
+      entries.push_back(Entry(identifier_place, matchable));
+    } else {
+      entries.insert(std::find_if(iterator_place, entries.end(), [&identifier_place](const Entry& entry_){return entry_.identifier_place != identifier_place;}),
+                     Entry(identifier_place, matchable));
+    }
+    ++statistics->number_of_entries;
+    statistics->sum_of_logarithmic_frequencies += std::log(static_cast<real>(1+_number_of_places_per_word[index_word]));
+  }
+}
+
+void BagOfWordsPlaceDatabase::match(const HBSTTree::MatchableVector& matchables_,
+                                    HBSTTree::MatchVectorMap& matches_,
+                                    const uint32_t& maximum_distance_) const {
+  for (const uint64_t& identifier_place: _place_identifiers) {
+    matches_[identifier_place];
+  }
+  if (_inverted_index.empty()) {
+    return;
+  }
+  std::vector<Index> words_query;
+  words_query.reserve(matchables_.size());
+  for (const HBSTMatchable* matchable_query: matchables_) {
+    words_query.push_back(_getWord(matchable_query->descriptor));
+  }
+
+  //ds candidate places: the best scoring ones (all if there are not more places than candidates)
+  const bool is_scoring_required = (_place_identifiers.size() > _parameters->bag_of_words_maximum_number_of_candidates);
+  IdentifierHashMap<bool> candidates(_parameters->bag_of_words_maximum_number_of_candidates);
+  if (is_scoring_required) {
+    IdentifierHashMap<real> scores(_place_identifiers.size());
+    _scorePlaces(words_query, scores);
+    std::vector<std::pair<real, uint64_t>> places_by_score;
+    places_by_score.reserve(scores.size());
+    for (const IdentifierHashMap<real>::Slot& slot: scores.slots()) {
+      if (slot.key != IdentifierHashMap<real>::free_key) {
+        places_by_score.push_back(std::make_pair(slot.value, slot.key));
+      }
+    }
+    const Count number_of_candidates = std::min(places_by_score.size(), _parameters->bag_of_words_maximum_number_of_candidates);
+    std::partial_sort(places_by_score.begin(), places_by_score.begin()+number_of_candidates, places_by_score.end(),
+                      std::greater<std::pair<real, uint64_t>>());
+    for (Index index = 0; index < number_of_candidates; ++index) {
+      candidates.insert(places_by_score[index].second, true);
+    }
+  }
+
+  //ds compare each query only against the descriptors of candidate places sharing its word
+  std::vector<const HBSTMatchable*> matchables_best;
+  for (Index index_query = 0; index_query < matchables_.size(); ++index_query) {
+    const HBSTMatchable* matchable_query = matchables_[index_query];
+    const std::vector<Entry>& entries    = _inverted_index[words_query[index_query]];
+
+    //ds best references of the query per place (contiguous runs of entries)
+    for (Index index_begin = 0; index_begin < entries.size();) {
+      const uint64_t& identifier_place = entries[index_begin].identifier_place;
+      Index index_end = index_begin;
+      while (index_end < entries.size() && entries[index_end].identifier_place == identifier_place) {
+        ++index_end;
+      }
+      if (is_scoring_required && !candidates.find(identifier_place)) {
+        index_begin = index_end;
+        continue;
+      }
+      uint32_t distance_best = maximum_distance_;
+      matchables_best.clear();
+      for (Index index_entry = index_begin; index_entry < index_end; ++index_entry) {
+        const uint32_t distance = _getDistance(matchable_query, entries[index_entry].matchable);
+        if (distance < distance_best) {
+          distance_best = distance;
+          matchables_best.clear();
+          matchables_best.push_back(entries[index_entry].matchable);
+        } else if (distance == distance_best && !matchables_best.empty()) {
+          matchables_best.push_back(entries[index_entry].matchable);
+        }
+      }
+      if (!matchables_best.empty()) {
+        matches_[identifier_place].push_back(_makeMatch(matchable_query, matchables_best, distance_best));
+      }
+      index_begin = index_end;
+    }
+  }
+}
+
+void BagOfWordsPlaceDatabase::clear(const bool& free_matchables_) {
+  if (free_matchables_) {
+    for (std::vector<Entry>& entries: _inverted_index) {
+      for (Entry& entry: entries) {
+        delete entry.matchable;
+      }
+    }
+  }
+
+  //ds the vocabulary is kept (it does not depend on the stored places)
+  for (Index index_word = 0; index_word < _inverted_index.size(); ++index_word) {
+    _inverted_index[index_word].clear();
+    _number_of_places_per_word[index_word] = 0;
+  }
+  _place_identifiers.clear();
+  _statistics_per_place.clear();
+}
+
+const Index BagOfWordsPlaceDatabase::_getWord(const HBSTMatchable::Descriptor& descriptor_) const {
+  Index index_node = 0;
+  uint32_t distance = 0;
+  while (!_nodes[index_node].children.empty()) {
+    index_node = _getClosestChild(index_node, descriptor_, distance);
+  }
+  return _nodes[index_node].index_word;
+}
+
+const Index BagOfWordsPlaceDatabase::_addWord(const HBSTMatchable::Descriptor& descriptor_) {
+  Index index_node = 0;
+  for (Count level = 0; level < _parameters->bag_of_words_depth; ++level) {
+    uint32_t distance    = std::numeric_limits<uint32_t>::max();
+    Index index_child    = 0;
+    const Count number_of_children = _nodes[index_node].children.size();
+    if (number_of_children > 0) {
+      index_child = _getClosestChild(index_node, descriptor_, distance);
+    }
+
+    //ds found a new branch down to a new word if the descriptor is not covered and the node and vocabulary have space left
+    if (distance > _radius_per_level[level] &&
+        number_of_children < _parameters->bag_of_words_branching_factor &&
+        _inverted_index.size() < _parameters->bag_of_words_maximum_number_of_words) {
+      for (; level < _parameters->bag_of_words_depth; ++level) {
+        _nodes[index_node].children.push_back(_nodes.size());
+        index_node = _nodes.size();
+        _nodes.push_back(Node(descriptor_));
+      }
+      _nodes[index_node].index_word = _inverted_index.size();
+      _inverted_index.push_back(std::vector<Entry>());
+      _number_of_places_per_word.push_back(0);
+      return _nodes[index_node].index_word;
+    }
+    index_node = index_child;
+  }
+  return _nodes[index_node].index_word;
+}
+
+const Index BagOfWordsPlaceDatabase::_getClosestChild(const Index& index_node_, const HBSTMatchable::Descriptor& descriptor_, uint32_t& distance_) const {
+  const std::vector<Index>& children = _nodes[index_node_].children;
+  Index index_child_best = children.front();
+  distance_ = std::numeric_limits<uint32_t>::max();
+  for (const Index& index_child: children) {
+    const uint32_t distance = (descriptor_^_nodes[index_child].center).count();
+    if (distance < distance_) {
+      distance_        = distance;
+      index_child_best = index_child;
+    }
+  }
+  return index_child_best;
+}
+
+void BagOfWordsPlaceDatabase::_scorePlaces(const std::vector<Index>& words_query_, IdentifierHashMap<real>& scores_) const {
+  std::vector<Index> words_query(words_query_);
+  std::sort(words_query.begin(), words_query.end());
+
+  //ds query norm
+  real norm_query = 0;
+  for (const Index& index_word: words_query) {
+    norm_query += _getWeight(index_word);
+  }
+  if (norm_query <= 0) {
+    return;
+  }
+
+  //ds for each query word (run of equal words): accumulate min(q_w, p_w) over the places observing it (1-0.5*|q-p| = sum of minima)
+  for (Index index_begin = 0; index_begin < words_query.size();) {
+    const Index& index_word = words_query[index_begin];
+    Index index_end = index_begin;
+    while (index_end < words_query.size() && words_query[index_end] == index_word) {
+      ++index_end;
+    }
+    const real weight        = _getWeight(index_word);
+    const real value_query   = weight*(index_end-index_begin)/norm_query;
+    const std::vector<Entry>& entries = _inverted_index[index_word];
+    for (Index index_entry_begin = 0; weight > 0 && index_entry_begin < entries.size();) {
+      const uint64_t& identifier_place = entries[index_entry_begin].identifier_place;
+      Index index_entry_end = index_entry_begin;
+      while (index_entry_end < entries.size() && entries[index_entry_end].identifier_place == identifier_place) {
+        ++index_entry_end;
+      }
+      const real value_place = weight*(index_entry_end-index_entry_begin)/_getNorm(identifier_place);
+      *scores_.insert(identifier_place, 0).first += std::min(value_query, value_place);
+      index_entry_begin = index_entry_end;
+    }
+    index_begin = index_end;
+  }
+}
+}
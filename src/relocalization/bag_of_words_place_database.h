@@ -0,0 +1,114 @@
+#pragma once
+#include "base_place_database.h"
+#include <functional>
+#include "types/flat_containers.h"
+
+namespace proslam {
+
+//ds place database quantizing descriptors into visual words with an inverted index (approximate), the vocabulary is a
+//ds hierarchical tree learned online: a descriptor descends greedily to the closest child at each level and founds a new
+//ds branch if it is farther than the level radius from all children of a non-full node (until the vocabulary is full),
+//ds the leaves are the words (quantization is logarithmic in the vocabulary size)
+//ds queries score the stored places with the L1 distance of their normalized tf-idf vectors over the inverted index and report
+//ds descriptor matches only for the best scoring places
+class BagOfWordsPlaceDatabase: public BasePlaceDatabase {
+
+//ds object handling
+public:
+
+  BagOfWordsPlaceDatabase(const RelocalizerParameters* parameters_);
+  virtual ~BagOfWordsPlaceDatabase() {}
+
+//ds functionality
+public:
+
+  virtual void add(const HBSTTree::MatchableVector& matchables_);
+
+  virtual void match(const HBSTTree::MatchableVector& matchables_, HBSTTree::MatchVectorMap& matches_, const uint32_t& maximum_distance_) const;
+
+  virtual void clear(const bool& free_matchables_);
+
+  virtual const Count numberOfPlaces() const {return _place_identifiers.size();}
+
+//ds getters/setters
+public:
+
+  inline const Count numberOfWords() const {return _inverted_index.size();}
+
+//ds helpers
+protected:
+
+  //! @brief retrieves the word of a descriptor by descending the vocabulary tree (the vocabulary must not be empty)
+  //! @param[in] descriptor_ the descriptor to quantize
+  //! @return the word index
+  const Index _getWord(const HBSTMatchable::Descriptor& descriptor_) const;
+
+  //! @brief retrieves the word of a descriptor, founding a new branch where the descriptor is not covered by the vocabulary
+  //! @param[in] descriptor_ the descriptor to quantize
+  //! @return the word index
+  const Index _addWord(const HBSTMatchable::Descriptor& descriptor_);
+
+  //! @brief closest child of a vocabulary tree node
+  //! @param[in] index_node_ the node (must have children)
+  //! @param[in] descriptor_ the descriptor to compare
+  //! @param[out] distance_ descriptor distance to the child center
+  //! @return the child node index
+  const Index _getClosestChild(const Index& index_node_, const HBSTMatchable::Descriptor& descriptor_, uint32_t& distance_) const;
+
+  //! @brief scores the stored places against a query place: 1-0.5*|q-p|, with q and p the L1 normalized tf-idf vectors,
+  //! which only depends on the shared words and is accumulated over the inverted index
+  //! @param[in] words_query_ word of each query descriptor
+  //! @param[out] scores_ score in [0, 1] for each place sharing at least one word with the query
+  void _scorePlaces(const std::vector<Index>& words_query_, IdentifierHashMap<real>& scores_) const;
+
+  //! @brief idf weight of a word for the current number of places
+  inline const real _getWeight(const Index& index_word_) const {
+    return std::log((1+static_cast<real>(_place_identifiers.size()))/(1+_number_of_places_per_word[index_word_]));
+  }
+
+  //! @brief L1 norm of the tf-idf vector of a place: sum over its entries of log(1+N)-log(1+n_w)
+  inline const real _getNorm(const uint64_t& identifier_place_) const {
+    const PlaceStatistics* statistics = _statistics_per_place.find(identifier_place_);
+    return std::log(1+static_cast<real>(_place_identifiers.size()))*statistics->number_of_entries-statistics->sum_of_logarithmic_frequencies;
+  }
+
+protected:
+
+  //! @brief vocabulary tree node, leaves carry a word
+  struct Node {
+    Node(const HBSTMatchable::Descriptor& center_): center(center_) {}
+    HBSTMatchable::Descriptor center;
+    std::vector<Index> children;
+    Index index_word = std::numeric_limits<Index>::max();
+  };
+
+  //! @brief inverted index entry: a stored matchable and its place
+  struct Entry {
+    Entry(const uint64_t& identifier_place_, HBSTMatchable* matchable_): identifier_place(identifier_place_), matchable(matchable_) {}
+    uint64_t identifier_place;
+    HBSTMatchable* matchable;
+  };
+
+  //ds vocabulary tree (the root is the first node, its center is unused)
+  std::vector<Node> _nodes;
+
+  //ds branching radius for each tree level (coarse at the top, word radius at the leaves)
+  std::vector<real> _radius_per_level;
+
+  //ds inverted index: entries for each word, entries of a place are contiguous (places are added at once)
+  std::vector<std::vector<Entry>> _inverted_index;
+
+  //ds number of places observing each word (document frequency)
+  std::vector<Count> _number_of_places_per_word;
+
+  //! @brief per place terms of the tf-idf vector norm, maintained incrementally (the idf weights change with every added place)
+  struct PlaceStatistics {
+    Count number_of_entries = 0;
+    real sum_of_logarithmic_frequencies = 0;
+  };
+
+  //ds stored places in order of addition and their norm terms
+  std::vector<uint64_t> _place_identifiers;
+  IdentifierHashMap<PlaceStatistics> _statistics_per_place;
+};
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "types/parameters.h"
+#include "types/frame_point.h"
+
+namespace proslam {
+
+//ds base place database class: stores the appearances (HBST matchables) of visited places (= local maps) and retrieves
+//ds descriptor matches of a query place against all stored places, matches are reported in the HBST format for all backends
+class BasePlaceDatabase {
+
+//ds object handling
+public:
+
+  //! @brief default constructor
+  //! @param[in] parameters_ target parameters handle
+  BasePlaceDatabase(const RelocalizerParameters* parameters_): _parameters(parameters_) {}
+
+  //! @brief default destructor (matchables are not freed, see clear)
+  virtual ~BasePlaceDatabase() {}
+
+//ds functionality
+public:
+
+  //! @brief adds the matchables of a place, the database takes ownership of the matchables
+  //! @param[in] matchables_ matchables of a single place (identified by their object identifier)
+  virtual void add(const HBSTTree::MatchableVector& matchables_) = 0;
+
+  //! @brief retrieves the best matches of each query matchable in each stored place
+  //! @param[in] matchables_ query matchables
+  //! @param[out] matches_ match vector for each stored place (by place identifier)
+  //! @param[in] maximum_distance_ matches must have a descriptor distance below this value
+  virtual void match(const HBSTTree::MatchableVector& matchables_, HBSTTree::MatchVectorMap& matches_, const uint32_t& maximum_distance_) const = 0;
+
+  //! @brief match and add in a single call (the query place is not matched against itself)
+  virtual void matchAndAdd(const HBSTTree::MatchableVector& matchables_, HBSTTree::MatchVectorMap& matches_, const uint32_t& maximum_distance_) {
+    match(matchables_, matches_, maximum_distance_);
+    add(matchables_);
+  }
+
+  //! @brief matchables absorbed (and freed) by the last add call, only backends merging descriptors report merges
+  virtual HBSTTree::MatchableMergeVector getMerges() {return HBSTTree::MatchableMergeVector();}
+
+  //! @brief removes all places
+  //! @param[in] free_matchables_ frees the stored matchables if set
+  virtual void clear(const bool& free_matchables_) = 0;
+
+  //! @brief number of stored places
+  virtual const Count numberOfPlaces() const = 0;
+
+//ds helpers
+protected:
+
+  //! @brief builds a match in the HBST format
+  //! @param[in] matchable_query_ the query matchable
+  //! @param[in] matchables_reference_ the reference matchables at the best distance (of a single place)
+  //! @param[in] distance_ the descriptor distance
+  static HBSTTree::Match _makeMatch(const HBSTMatchable* matchable_query_,
+                                    const std::vector<const HBSTMatchable*>& matchables_reference_,
+                                    const uint32_t& distance_) {
+    HBSTTree::Match match;
+    match.object_query    = matchable_query_->objects.begin()->second;
+    match.matchable_query = matchable_query_;
+    match.distance        = distance_;
+    match.object_references.reserve(matchables_reference_.size());
+    for (const HBSTMatchable* matchable_reference: matchables_reference_) {
+      match.object_references.push_back(matchable_reference->objects.begin()->second);
+    }
+    match.matchable_references = matchables_reference_;
+    return match;
+  }
+
+  //! @brief identifier of the place a matchable (of a non merging backend) belongs to
+  static const uint64_t& _getPlaceIdentifier(const HBSTMatchable* matchable_) {return matchable_->objects.begin()->first;}
+
+  //! @brief descriptor distance
+  static const uint32_t _getDistance(const HBSTMatchable* matchable_a_, const HBSTMatchable* matchable_b_) {
+    return (matchable_a_->descriptor^matchable_b_->descriptor).count();
+  }
+
+protected:
+
+  //! @brief configurable parameters
+  const RelocalizerParameters* _parameters;
+};
+
+typedef std::shared_ptr<BasePlaceDatabase> BasePlaceDatabasePtr;
+}
@@ -0,0 +1,50 @@
+#include "brute_force_place_database.h"
+
+namespace proslam {
+
+void BruteForcePlaceDatabase::add(const HBSTTree::MatchableVector& matchables_) {
+  if (matchables_.empty()) {
+    return;
+  }
+  _places.push_back(std::make_pair(_getPlaceIdentifier(matchables_.front()), matchables_));
+}
+
+void BruteForcePlaceDatabase::match(const HBSTTree::MatchableVector& matchables_,
+                                    HBSTTree::MatchVectorMap& matches_,
+                                    const uint32_t& maximum_distance_) const {
+  std::vector<const HBSTMatchable*> matchables_best;
+  for (const std::pair<uint64_t, HBSTTree::MatchableVector>& place: _places) {
+    HBSTTree::MatchVector& matches = matches_[place.first];
+
+    //ds best references of each query in this place (all references at the minimum distance)
+    for (const HBSTMatchable* matchable_query: matchables_) {
+      uint32_t distance_best = maximum_distance_;
+      matchables_best.clear();
+      for (const HBSTMatchable* matchable_reference: place.second) {
+        const uint32_t distance = _getDistance(matchable_query, matchable_reference);
+        if (distance < distance_best) {
+          distance_best = distance;
+          matchables_best.clear();
+          matchables_best.push_back(matchable_reference);
+        } else if (distance == distance_best && !matchables_best.empty()) {
+          matchables_best.push_back(matchable_reference);
+        }
+      }
+      if (!matchables_best.empty()) {
+        matches.push_back(_makeMatch(matchable_query, matchables_best, distance_best));
+      }
+    }
+  }
+}
+
+void BruteForcePlaceDatabase::clear(const bool& free_matchables_) {
+  if (free_matchables_) {
+    for (std::pair<uint64_t, HBSTTree::MatchableVector>& place: _places) {
+      for (HBSTMatchable* matchable: place.second) {
+        delete matchable;
+      }
+    }
+  }
+  _places.clear();
+}
+}
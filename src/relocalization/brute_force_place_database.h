@@ -0,0 +1,32 @@
+#pragma once
+#include "base_place_database.h"
+
+namespace proslam {
+
+//ds place database comparing each query descriptor against all stored descriptors (exact, linear query time)
+//ds serves as exact baseline and is competitive for small maps, descriptors are compared word-wise (popcount)
+class BruteForcePlaceDatabase: public BasePlaceDatabase {
+
+//ds object handling
+public:
+
+  BruteForcePlaceDatabase(const RelocalizerParameters* parameters_): BasePlaceDatabase(parameters_) {}
+  virtual ~BruteForcePlaceDatabase() {}
+
+//ds functionality
+public:
+
+  virtual void add(const HBSTTree::MatchableVector& matchables_);
+
+  virtual void match(const HBSTTree::MatchableVector& matchables_, HBSTTree::MatchVectorMap& matches_, const uint32_t& maximum_distance_) const;
+
+  virtual void clear(const bool& free_matchables_);
+
+  virtual const Count numberOfPlaces() const {return _places.size();}
+
+protected:
+
+  //ds stored places in order of addition: <place identifier, matchables>
+  std::vector<std::pair<uint64_t, HBSTTree::MatchableVector>> _places;
+};
+}
@@ -9,40 +9,50 @@ class Closure {
 //ds exported types
 public: EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
-  //ds match information between two landmark states
-  struct Candidate {
-    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
-    Candidate(Landmark* landmark_query_,
-              Landmark* landmark_reference_,
-              const Count& matching_distance_hamming_): query(landmark_query_),
-                                                        reference(landmark_reference_),
-                                                        matching_distance_hamming(matching_distance_hamming_) {}
-
-    Landmark* query;
-    Landmark* reference;
-    const Count matching_distance_hamming;
-  };
-
-  typedef std::vector<Candidate, Eigen::aligned_allocator<Candidate>> CandidateVector;
-  typedef std::pair<const Identifier, CandidateVector> CandidateMapElement;
-  typedef std::map<const Identifier, CandidateVector, std::less<Identifier>, Eigen::aligned_allocator<CandidateMapElement>> CandidateMap;
-
   //ds container for a single correspondence pair (produced by the relocalization module)
+  //ds landmark identifiers and coordinates are snapshots taken at detection, the landmarks might be merged or culled before the closure is integrated
   struct Correspondence {
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     Correspondence(Landmark* landmark_query_,
                    Landmark* landmark_reference_,
                    const Count& matching_count_,
-                   const real& matching_ratio_): query(landmark_query_),
-                                                 reference(landmark_reference_),
-                                                 matching_count(matching_count_),
-                                                 matching_ratio(matching_ratio_) {}
+                   const real& matching_ratio_,
+                   const PointCoordinates& coordinates_in_query_,
+                   const PointCoordinates& coordinates_in_reference_): query(landmark_query_),
+                                                                       reference(landmark_reference_),
+                                                                       identifier_query(landmark_query_->identifier()),
+                                                                       identifier_reference(landmark_reference_->identifier()),
+                                                                       matching_count(matching_count_),
+                                                                       matching_ratio(matching_ratio_),
+                                                                       coordinates_in_query(coordinates_in_query_),
+                                                                       coordinates_in_reference(coordinates_in_reference_) {}
+
+    //ds correspondence of a framepoint without landmark to a reference landmark (frame relocalization)
+    //ds the query identifier is the reference identifier, such that the correspondence never triggers a landmark merge
+    Correspondence(Landmark* landmark_reference_,
+                   const Count& matching_count_,
+                   const real& matching_ratio_,
+                   const PointCoordinates& coordinates_in_query_,
+                   const PointCoordinates& coordinates_in_reference_): query(nullptr),
+                                                                       reference(landmark_reference_),
+                                                                       identifier_query(landmark_reference_->identifier()),
+                                                                       identifier_reference(landmark_reference_->identifier()),
+                                                                       matching_count(matching_count_),
+                                                                       matching_ratio(matching_ratio_),
+                                                                       coordinates_in_query(coordinates_in_query_),
+                                                                       coordinates_in_reference(coordinates_in_reference_) {}
 
     Landmark* query;
     Landmark* reference;
+    const Identifier identifier_query;
+    const Identifier identifier_reference;
     const Count matching_count;
     const real matching_ratio;
 
+    //ds landmark coordinates in the query and reference local map frames (registration input)
+    const PointCoordinates coordinates_in_query;
+    const PointCoordinates coordinates_in_reference;
+
     //ds determined as inlier in registration algorithm (e.g. ICP)
     bool is_inlier = false;
   };
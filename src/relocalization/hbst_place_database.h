@@ -0,0 +1,44 @@
+#pragma once
+#include "base_place_database.h"
+
+namespace proslam {
+
+//ds place database backed by a Hamming distance embedding binary search tree (approximate, logarithmic query time)
+//ds descriptors of different places are merged if SRRG_MERGE_DESCRIPTORS is defined
+class HBSTPlaceDatabase: public BasePlaceDatabase {
+
+//ds object handling
+public:
+
+  HBSTPlaceDatabase(const RelocalizerParameters* parameters_): BasePlaceDatabase(parameters_) {}
+  virtual ~HBSTPlaceDatabase() {}
+
+//ds functionality
+public:
+
+  virtual void add(const HBSTTree::MatchableVector& matchables_) {
+    _tree.add(matchables_, srrg_hbst::SplittingStrategy::SplitEven);
+  }
+
+  virtual void match(const HBSTTree::MatchableVector& matchables_, HBSTTree::MatchVectorMap& matches_, const uint32_t& maximum_distance_) const {
+    _tree.match(matchables_, matches_, maximum_distance_);
+  }
+
+  virtual void matchAndAdd(const HBSTTree::MatchableVector& matchables_, HBSTTree::MatchVectorMap& matches_, const uint32_t& maximum_distance_) {
+    _tree.matchAndAdd(matchables_, matches_, maximum_distance_);
+  }
+
+#ifdef SRRG_MERGE_DESCRIPTORS
+  virtual HBSTTree::MatchableMergeVector getMerges() {return _tree.getMerges();}
+#endif
+
+  virtual void clear(const bool& free_matchables_) {_tree.clear(free_matchables_);}
+
+  virtual const Count numberOfPlaces() const {return _tree.size();}
+
+protected:
+
+  //ds the tree holding all descriptors
+  HBSTTree _tree;
+};
+}
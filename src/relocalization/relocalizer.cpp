@@ -3,46 +3,202 @@
 namespace proslam {
 
 Relocalizer::Relocalizer(RelocalizerParameters* parameters_): _parameters(parameters_) {
-  _added_local_maps.clear();
+  _places.clear();
   clear();
   LOG_INFO(std::cerr << "Relocalizer::Relocalizer|constructed" << std::endl)
 }
 
 void Relocalizer::configure() {
   LOG_INFO(std::cerr << "Relocalizer::configure|configuring" << std::endl)
-  _added_local_maps.clear();
+  _stop();
+  _stopRegistration();
+  _clearDatabase();
   clear();
 
-  //ds allocate and configure aligner unit
-  _aligner = XYZAlignerPtr(new XYZAligner(_parameters->aligner));
-  _aligner->configure();
-  LOG_INFO(std::cerr << "Relocalizer::configure|configured" << std::endl)
+  //ds parse the place eviction policy
+  if (_parameters->place_eviction_policy == "OLDEST") {
+    _eviction_policy = EvictionPolicy::Oldest;
+  } else if (_parameters->place_eviction_policy == "LEAST_MATCHED") {
+    _eviction_policy = EvictionPolicy::LeastMatched;
+  } else if (_parameters->place_eviction_policy == "SPATIALLY_REDUNDANT") {
+    _eviction_policy = EvictionPolicy::SpatiallyRedundant;
+  } else {
+    throw std::runtime_error("Relocalizer::configure|invalid place eviction policy: " + _parameters->place_eviction_policy);
+  }
+
+  //ds parse the closure query gating
+  if (_parameters->closure_query_gating == "NONE") {
+    _gating = Gating::None;
+  } else if (_parameters->closure_query_gating == "SPATIAL") {
+    _gating = Gating::Spatial;
+  } else {
+    throw std::runtime_error("Relocalizer::configure|invalid closure query gating: " + _parameters->closure_query_gating);
+  }
+
+  //ds allocate the place database backend
+  _place_database = _createPlaceDatabase();
+
+  //ds allocate and configure an aligner unit for each registration thread
+  _aligners.resize(std::max(_parameters->number_of_registration_threads, static_cast<Count>(1)));
+  for (XYZAlignerPtr& aligner: _aligners) {
+    aligner = XYZAlignerPtr(new XYZAligner(_parameters->aligner));
+    aligner->configure();
+  }
+
+  //ds launch the registration threads, kept for all registrations (the calling thread uses the first aligner)
+  _is_registration_running = true;
+  for (Index index = 1; index < _aligners.size(); ++index) {
+    _registration_threads.push_back(std::thread(&Relocalizer::_processRegistrations, this, _aligners[index].get(), _registration_round));
+  }
+
+  //ds launch worker thread if desired
+  if (_parameters->enable_asynchronous_processing) {
+    _is_running = true;
+    _worker     = std::thread(&Relocalizer::_processQueue, this);
+    LOG_INFO(std::cerr << "Relocalizer::configure|launched worker thread (deterministic: "
+                       << _parameters->enable_deterministic_processing << ")" << std::endl)
+  }
+  LOG_INFO(std::cerr << "Relocalizer::configure|configured (place database: " << _parameters->place_database_type
+                     << " place capacity: " << _parameters->maximum_number_of_places
+                     << " eviction policy: " << _parameters->place_eviction_policy
+                     << " gating: " << _parameters->closure_query_gating << ")" << std::endl)
 }
 
 Relocalizer::~Relocalizer() {
   LOG_INFO(std::cerr << "Relocalizer::~Relocalizer|destroying" << std::endl)
-  _added_local_maps.clear();
+  _stop();
+  _stopRegistration();
+  _clearDatabase();
   clear();
   LOG_INFO(std::cerr << "Relocalizer::~Relocalizer|destroyed" << std::endl)
 }
 
+void Relocalizer::process(LocalMap* local_map_query_, const bool& is_connected_) {
+  if (!local_map_query_) {
+    return;
+  }
+
+  //ds the position is taken now, the worker must not read poses that are concurrently optimized
+  const PointCoordinates position_query = local_map_query_->localMapToWorld().translation();
+
+  //ds queue the local map for the worker
+  if (_parameters->enable_asynchronous_processing) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex_queue);
+      _local_maps_queued.push_back(Query(local_map_query_, position_query, is_connected_));
+    }
+    _condition_queue.notify_all();
+  } else {
+
+    //ds process the local map right away
+    detectClosures(local_map_query_, position_query, is_connected_);
+    registerClosures();
+    _has_closures = !_closures.empty();
+  }
+}
+
+void Relocalizer::updatePlacePositions(const LocalMapPointerVector& local_maps_, const bool& are_tracks_connected_) {
+  std::lock_guard<std::mutex> lock(_mutex_queue);
+  _place_positions_pending.clear();
+  _place_positions_pending.reserve(local_maps_.size());
+  for (const LocalMap* local_map: local_maps_) {
+    _place_positions_pending.push_back(std::make_pair(local_map->identifier(), local_map->localMapToWorld().translation()));
+  }
+  _are_tracks_connected_pending = are_tracks_connected_;
+
+  //ds queued queries are refreshed as well (they are compared against the refreshed places)
+  for (Query& query: _local_maps_queued) {
+    query.position     = query.local_map->localMapToWorld().translation();
+    query.is_connected = (query.is_connected || are_tracks_connected_);
+  }
+}
+
+void Relocalizer::synchronize() {
+  std::unique_lock<std::mutex> lock(_mutex_queue);
+  _condition_queue.wait(lock, [this]{return !_is_running || (_local_maps_queued.empty() && !_is_processing);});
+}
+
+const bool Relocalizer::hasClosures() {
+  std::lock_guard<std::mutex> lock(_mutex_queue);
+  return _has_closures;
+}
+
 //ds retrieve loop closure candidates for the given cloud
-void Relocalizer::detectClosures(LocalMap* local_map_query_) {
-  CHRONOMETER_START(overall)
+void Relocalizer::detectClosures(LocalMap* local_map_query_, const PointCoordinates& position_query_, const bool& is_connected_) {
   if (!local_map_query_) {
     return;
   }
 
+  //ds the place database is guarded during the whole call, matched landmarks must not be merged or freed meanwhile
+  std::lock_guard<std::mutex> lock_database(_mutex_database);
+  _applyPlacePositions();
+
+  //ds take over the query appearances (a window folded into the local map adds appearances under the local map guard)
+  std::unique_lock<std::mutex> lock_local_maps(_mutex_local_maps);
+  HBSTTree::MatchableVector matchables_query;
+  matchables_query.swap(local_map_query_->appearances());
+#ifndef SRRG_MERGE_DESCRIPTORS
+  lock_local_maps.unlock();
+#endif
+  if (matchables_query.empty()) {
+    return;
+  }
+  CHRONOMETER_START(overall)
+
   //ds always add the entry (only matching is optional)
-  _added_local_maps.push_back(local_map_query_);
-  const Count number_of_query_matchables = local_map_query_->appearances().size();
+  const Identifier& identifier_query = local_map_query_->identifier();
+  if (_places.size() <= identifier_query) {
+    _places.resize(identifier_query+1);
+  }
+  Place& place_query = _places[identifier_query];
+
+  //ds the distance traveled is not accumulated across track segments (the positions are expressed in different frames)
+  if (_number_of_places_added > 0 && _places[_identifier_last_place].is_connected == is_connected_) {
+    _distance_traveled += (position_query_-_places[_identifier_last_place].position).norm();
+  }
+  _identifier_last_place = identifier_query;
+
+  //ds a local map that absorbed a folded window is queried again with the appearances of the window (its place is extended)
+  if (place_query.local_map) {
+    place_query.matchables.insert(place_query.matchables.end(), matchables_query.begin(), matchables_query.end());
+  } else {
+    place_query.local_map   = local_map_query_;
+    place_query.index_added = _number_of_places_added;
+    place_query.matchables.assign(matchables_query.begin(), matchables_query.end());
+    ++_number_of_places;
+    ++_number_of_places_added;
+  }
+  place_query.position     = position_query_;
+  place_query.is_connected = is_connected_;
+  place_query.distance_traveled = _distance_traveled;
+  ++_number_of_places_added_since_rebuild;
+  const Count number_of_query_matchables = matchables_query.size();
+  _number_of_added_matchables += number_of_query_matchables;
+
+  //ds places in query range: not among the most recent places and within the gate of the query
+  //ds evicted places are not contained in the database anymore
+  Count maximum_index_reference = 0;
+  bool is_in_query_range        = false;
+  if (_number_of_places_added > _parameters->preliminary_minimum_interspace_queries) {
+    maximum_index_reference = _number_of_places_added-_parameters->preliminary_minimum_interspace_queries;
+    for (const Place& place: _places) {
+      if (place.local_map && place.index_added < maximum_index_reference && &place != &place_query && _isInsideGate(place, place_query)) {
+        is_in_query_range = true;
+        break;
+      }
+    }
+    if (!is_in_query_range && _gating != Gating::None) {
+      ++_number_of_gated_queries;
+    }
+  }
 
-  //ds if we are not yet in query range - only add matchables and nothing else to do
-  if (_place_database.size() < _parameters->preliminary_minimum_interspace_queries) {
+  //ds if we are not in query range - only add matchables and nothing else to do
+  //ds with descriptor merging the local map guard is kept: merges free query matchables that are referenced by landmark appearances,
+  //ds no local maps (new matchables) may be created until they are redirected
+  if (!is_in_query_range) {
 
     //ds add matchables
-    _place_database.add(local_map_query_->appearances(), srrg_hbst::SplittingStrategy::SplitEven);
-    local_map_query_->appearances().clear();
+    _place_database->add(matchables_query);
   }
 
   //ds we want to add and match against past places
@@ -52,76 +208,83 @@ void Relocalizer::detectClosures(LocalMap* local_map_query_) {
     HBSTTree::MatchVectorMap matches_per_reference_image;
 
     //ds query database for current matchables and integrate current image simultaneously
-    _place_database.matchAndAdd(local_map_query_->appearances(), matches_per_reference_image, _parameters->maximum_descriptor_distance);
-    local_map_query_->appearances().clear();
+    _place_database->matchAndAdd(matchables_query, matches_per_reference_image, _parameters->maximum_descriptor_distance);
 
-    //ds evaluate matches for each reference image in the range
-    const Count maximum_index_reference = _place_database.size()-_parameters->preliminary_minimum_interspace_queries;
-    for (Count index_reference_local_map = 0; index_reference_local_map < maximum_index_reference; ++index_reference_local_map) {
-      HBSTTree::MatchVector& multiple_matches_mixed = matches_per_reference_image.at(index_reference_local_map);
+    //ds candidate evaluation reads local map structures (snapshots, covisibility), which are guarded from here on
+    if (!lock_local_maps.owns_lock()) {
+      lock_local_maps.lock();
+    }
 
-      //ds compute relative matching ratio (how many of the query matchables were matched)
-      const real relative_number_of_matches = static_cast<real>(multiple_matches_mixed.size())/number_of_query_matchables;
+    //ds collect the reference images in the range with sufficient matching ratio: <matching ratio, reference identifier>
+    std::vector<std::pair<real, Index>>& references = _references;
+    references.clear();
+    _masked_references.clear();
+    for (const std::pair<const uint64_t, HBSTTree::MatchVector>& matches: matches_per_reference_image) {
+      if (matches.first >= _places.size() || !_places[matches.first].local_map ||
+          _places[matches.first].index_added >= maximum_index_reference || matches.first == identifier_query) {
+        continue;
+      }
 
-      //ds skip this reference image if matching ratio is insufficient
-      if (relative_number_of_matches < _parameters->preliminary_minimum_matching_ratio) {
+      //ds skip references outside of the gate (matched by appearance only, spurious)
+      if (!_isInsideGate(_places[matches.first], place_query)) {
+        ++_number_of_gated_candidates;
         continue;
       }
 
-      //ds loop over all matches to organize them per landmark
-      Closure::CandidateMap multiple_matches_per_landmark;
-      for (const HBSTTree::Match& match: multiple_matches_mixed) {
+      //ds compute relative matching ratio (how many of the query matchables were matched)
+      const real relative_number_of_matches = static_cast<real>(matches.second.size())/number_of_query_matchables;
 
-        //ds we need to evaluate matches that have several candidates with the same distance
-        if (match.object_references.size() > 1) {
+      //ds skip this reference image if matching ratio is insufficient
+      if (relative_number_of_matches >= _parameters->preliminary_minimum_matching_ratio) {
+        references.push_back(std::make_pair(relative_number_of_matches, matches.first));
+        ++_places[matches.first].number_of_matches;
+      }
+    }
 
-          //ds check if all candidates belong NOT to the same landmark (otherwise we keep the match!)
-          bool has_multiple_landmarks = false;
-          for (Landmark* landmark_reference: match.object_references) {
-            if (landmark_reference != match.object_references[0]) {
-              has_multiple_landmarks = true;
-              break;
-            }
-          }
+    //ds evaluate the best matching references first (covisibility selection and the early exit of the registration rely on the rank order)
+    std::sort(references.begin(), references.end(), [](const std::pair<real, Index>& a_, const std::pair<real, Index>& b_) {
+      return a_.first > b_.first || (a_.first == b_.first && a_.second < b_.second);
+    });
 
-          //ds we skip matches that have multiple candidates (with same distance) due to ambiguity
-          if (has_multiple_landmarks) {
-            continue;
+    //ds evaluate matches for each candidate reference image
+    for (const std::pair<real, Index>& reference: references) {
+      const real& relative_number_of_matches = reference.first;
+      const LocalMap* local_map_reference    = _places[reference.second].local_map;
+      HBSTTree::MatchVector& multiple_matches_mixed = matches_per_reference_image[reference.second];
+
+      //ds skip references that are strongly covisible with an already selected reference (same place, redundant registration)
+      if (_parameters->enable_covisibility_candidate_selection) {
+        CHRONOMETER_START(covisibility_selection)
+        bool is_redundant = false;
+        for (const Closure* closure: _closures) {
+          if (closure->local_map_reference->numberOfSharedLandmarks(local_map_reference) >= _parameters->minimum_number_of_matched_landmarks) {
+            is_redundant = true;
+            break;
           }
         }
-
-        //ds buffer landmark identifier
-        Landmark* landmark_query                    = match.object_query;
-        Landmark* landmark_reference                = match.object_references[0];
-        const Identifier& query_landmark_identifier = landmark_query->identifier();
-
-        //ds update match map (adding a new entry if not existing yet)
-        try {
-
-          //ds add a new match to the given query point
-          multiple_matches_per_landmark.at(query_landmark_identifier).push_back(Closure::Candidate(landmark_query, landmark_reference, match.distance));
-        } catch(const std::out_of_range& /*exception*/) {
-
-          //ds initialize the first match for the given query point
-          multiple_matches_per_landmark.insert(std::make_pair(query_landmark_identifier,
-                                                              Closure::CandidateVector(1, Closure::Candidate(landmark_query, landmark_reference, match.distance))));
+        CHRONOMETER_STOP(covisibility_selection)
+        if (is_redundant) {
+          continue;
         }
       }
 
+      //ds organize the matches per query landmark
+      _groupMatches(multiple_matches_mixed);
+
       //ds skip further processing if number of matching landmarks is insufficient
-      if (multiple_matches_per_landmark.size() < _parameters->minimum_number_of_matched_landmarks) {
+      if (_match_groups.size() < _parameters->minimum_number_of_matched_landmarks) {
         continue;
       }
 
-      //ds prepare point to point correspondence search
+      //ds prepare point to point correspondence search (a new mask)
       Closure::CorrespondencePointerVector correspondences;
-      _mask_id_references_for_correspondences.clear();
+      ++_mask_stamp;
 
-      //ds compute the best point to point correspondences from multiple match candidates
-      for(const Closure::CandidateMapElement& multiple_matches: multiple_matches_per_landmark) {
+      //ds compute the best point to point correspondences from multiple match candidates (in increasing query landmark identifier order)
+      for (const Index& index_group: _match_group_order) {
 
         //ds retrieve best correspondence for the multiple matches
-        Closure::Correspondence* correspondence = _getCorrespondenceNN(multiple_matches.second);
+        Closure::Correspondence* correspondence = _getCorrespondenceNN(_match_groups[index_group], local_map_query_, local_map_reference);
         if (correspondence) {
           correspondences.push_back(correspondence);
         }
@@ -129,8 +292,8 @@ void Relocalizer::detectClosures(LocalMap* local_map_query_) {
 
       //ds add to closure buffer
       _closures.push_back(new Closure(local_map_query_,
-                                      _added_local_maps[index_reference_local_map],
-                                      multiple_matches_per_landmark.size(),
+                                      local_map_reference,
+                                      _match_groups.size(),
                                       relative_number_of_matches,
                                       correspondences));
     }
@@ -138,32 +301,64 @@ void Relocalizer::detectClosures(LocalMap* local_map_query_) {
 
 #ifdef SRRG_MERGE_DESCRIPTORS
   //ds always check for absorbed matchables (we need to update our bookkeeping) of the last add call (this local map)
-  HBSTTree::MatchableMergeVector merges = _place_database.getMerges();
+  HBSTTree::MatchableMergeVector merges = _place_database->getMerges();
   if (!merges.empty()) {
-
-    //ds evaluate each merge
-    for (HBSTTree::MatchableMerge& merge: merges) {
-
-      //ds the absorbed landmark must be contained in the merged objects for this local map ID by design
-      //ds recall that merge.query is already freed
-      Landmark* landmark = merge.query_object;
-
-      //ds replace the matchable in the landmark list, note that the memory for query is already freed
-      landmark->replace(merge.query, merge.reference);
+    if (!lock_local_maps.owns_lock()) {
+      lock_local_maps.lock();
     }
+    _redirectAppearances(merges);
+    _integrateMerges(merges, &place_query);
     LOG_DEBUG(std::cerr << "Relocalizer::detectClosures|merged appearances: " << merges.size()
                         << " (" << static_cast<real>(merges.size())/number_of_query_matchables << ")" << std::endl)
   }
 #endif
+
+  //ds bound the place database, keep it balanced and free the matchables of culled landmarks
+  if ((_parameters->maximum_number_of_places > 0 && _number_of_places > _parameters->maximum_number_of_places) ||
+      (_parameters->number_of_places_per_rebuild > 0 && _number_of_places_added_since_rebuild >= _parameters->number_of_places_per_rebuild) ||
+      10*_number_of_detached_matchables > numberOfLiveMatchables()) {
+    if (!lock_local_maps.owns_lock()) {
+      lock_local_maps.lock();
+    }
+    _maintainDatabase(lock_local_maps);
+  }
   CHRONOMETER_STOP(overall)
 }
 
 //ds geometric verification and determination of spatial relation between a set of closures
 void Relocalizer::registerClosures() {
+
+  //ds registration reports local map properties
+  std::lock_guard<std::mutex> lock_local_maps(_mutex_local_maps);
   CHRONOMETER_START(overall)
-  for(Closure* closure: _closures) {
-    _aligner->initialize(closure);
-    _aligner->converge();
+  const Count number_of_closures = _closures.size();
+
+  //ds the early exit requires the candidates in rank order (decreasing matching ratio), as provided by detectClosures
+  _is_ranked = std::is_sorted(_closures.begin(), _closures.end(), [](const Closure* a_, const Closure* b_) {
+    return a_->relative_number_of_matches > b_->relative_number_of_matches;
+  });
+  _index_closure_next     = 0;
+  _index_closure_accepted = number_of_closures;
+
+  //ds register with the calling thread and the registration threads
+  if (number_of_closures > 1 && !_registration_threads.empty()) {
+    {
+      std::lock_guard<std::mutex> lock(_mutex_registration);
+      ++_registration_round;
+      _number_of_registering_threads = _registration_threads.size();
+    }
+    _condition_registration.notify_all();
+    _registerCandidates(_aligners.front().get());
+    std::unique_lock<std::mutex> lock(_mutex_registration);
+    _condition_registration.wait(lock, [this]{return _number_of_registering_threads == 0;});
+  } else {
+    _registerCandidates(_aligners.front().get());
+  }
+
+  //ds drop candidates ranked behind the accepted one (also if registered already, results do not depend on scheduling)
+  for (Index index = _index_closure_accepted+1; index < number_of_closures; ++index) {
+    _closures[index]->is_valid = false;
+    ++_number_of_skipped_registrations;
   }
   CHRONOMETER_STOP(overall)
 }
@@ -200,56 +395,723 @@ void Relocalizer::prune() {
   CHRONOMETER_STOP(overall)
 }
 
+const LocalMap* Relocalizer::relocalize(const Frame* frame_, TransformMatrix3D& robot_to_local_map_) {
+  if (!frame_ || frame_->points().empty()) {
+    return nullptr;
+  }
+
+  //ds never wait for the worker: the next lost frame tries again
+  if (!tryLockDatabase()) {
+    ++_number_of_postponed_frame_relocalizations;
+    return nullptr;
+  }
+  if (_number_of_places == 0) {
+    unlockDatabase();
+    return nullptr;
+  }
+  CHRONOMETER_START(frame_relocalization)
+  ++_number_of_frame_relocalization_attempts;
+
+  //ds query matchables of the framepoints (owned by this call, they are not added to the database)
+  //ds sorted lookup: <query matchable, framepoint>
+  const Count number_of_query_matchables = frame_->points().size();
+  HBSTTree::MatchableVector matchables;
+  matchables.reserve(number_of_query_matchables);
+  std::vector<std::pair<const HBSTMatchable*, const FramePoint*>> framepoints_per_matchable;
+  framepoints_per_matchable.reserve(number_of_query_matchables);
+  for (const FramePoint* framepoint: frame_->points()) {
+    matchables.push_back(new HBSTMatchable(nullptr, framepoint->descriptorLeft(), frame_->identifier()));
+    framepoints_per_matchable.push_back(std::make_pair(matchables.back(), framepoint));
+  }
+  std::sort(framepoints_per_matchable.begin(), framepoints_per_matchable.end());
+  HBSTTree::MatchVectorMap matches_per_reference_image;
+  _place_database->match(matchables, matches_per_reference_image, _parameters->maximum_descriptor_distance);
+
+  //ds collect the places with sufficient matching ratio, best matching first: <matching ratio, reference identifier>
+  std::vector<std::pair<real, Index>>& references = _references;
+  references.clear();
+  _masked_references.clear();
+  for (const std::pair<const uint64_t, HBSTTree::MatchVector>& matches: matches_per_reference_image) {
+    if (matches.first >= _places.size() || !_places[matches.first].local_map) {
+      continue;
+    }
+    const real relative_number_of_matches = static_cast<real>(matches.second.size())/number_of_query_matchables;
+    if (relative_number_of_matches >= _parameters->preliminary_minimum_matching_ratio) {
+      references.push_back(std::make_pair(relative_number_of_matches, matches.first));
+    }
+  }
+  std::sort(references.begin(), references.end(), [](const std::pair<real, Index>& a_, const std::pair<real, Index>& b_) {
+    return a_.first > b_.first || (a_.first == b_.first && a_.second < b_.second);
+  });
+  if (references.size() > _parameters->maximum_number_of_frame_relocalization_candidates) {
+    references.resize(_parameters->maximum_number_of_frame_relocalization_candidates);
+  }
+
+  //ds register the frame against the candidate places, keeping the best registration
+  const LocalMap* local_map_relocalized = nullptr;
+  real inlier_ratio_best = 0;
+  for (const std::pair<real, Index>& reference: references) {
+    const LocalMap* local_map_reference = _places[reference.second].local_map;
+
+    //ds unambiguous framepoint to landmark correspondences (each reference landmark is used at most once)
+    Closure::CorrespondencePointerVector correspondences;
+    ++_mask_stamp;
+    for (const HBSTTree::Match& match: matches_per_reference_image[reference.second]) {
+      Landmark* landmark_reference = match.object_references[0];
+      if (!landmark_reference) {
+        continue;
+      }
+      bool has_multiple_landmarks = false;
+      for (Index index_reference = 1; index_reference < match.object_references.size(); ++index_reference) {
+        if (match.object_references[index_reference] != landmark_reference) {
+          has_multiple_landmarks = true;
+          break;
+        }
+      }
+      if (has_multiple_landmarks) {
+        continue;
+      }
+      const std::pair<Index*, bool> entry = _masked_references.insert(landmark_reference->identifier(), _mask_stamp);
+      if (!entry.second && *entry.first == _mask_stamp) {
+        continue;
+      }
+      *entry.first = _mask_stamp;
+
+      //ds retrieve the landmark snapshot in the reference local map - skipping landmarks that are not contained anymore
+      LocalMap::LandmarkStateMap::const_iterator state_reference = local_map_reference->landmarks().find(landmark_reference->identifier());
+      if (state_reference == local_map_reference->landmarks().end()) {
+        continue;
+      }
+      const FramePoint* framepoint = std::lower_bound(framepoints_per_matchable.begin(), framepoints_per_matchable.end(),
+                                                      std::make_pair(match.matchable_query, static_cast<const FramePoint*>(nullptr)))->second;
+      correspondences.push_back(new Closure::Correspondence(landmark_reference, 1, 1,
+                                                            framepoint->robotCoordinates(),
+                                                            state_reference->second.coordinates_in_local_map));
+    }
+
+    //ds skip further processing if number of correspondences is insufficient
+    if (correspondences.size() < _parameters->minimum_number_of_matched_landmarks) {
+      for (const Closure::Correspondence* correspondence: correspondences) {
+        delete correspondence;
+      }
+      continue;
+    }
+
+    //ds geometric verification (the closure frees the correspondences if invalid)
+    Closure closure(nullptr, local_map_reference, correspondences.size(), reference.first, correspondences);
+    _aligners.front()->initialize(&closure);
+    _aligners.front()->converge();
+    if (closure.is_valid && closure.icp_inlier_ratio > inlier_ratio_best) {
+      inlier_ratio_best     = closure.icp_inlier_ratio;
+      local_map_relocalized = local_map_reference;
+      robot_to_local_map_   = closure.query_to_reference;
+    }
+    closure.is_valid = false;
+    if (inlier_ratio_best >= _parameters->minimum_inlier_ratio_for_early_exit) {
+      break;
+    }
+  }
+
+  //ds free the query matchables
+  for (HBSTMatchable* matchable: matchables) {
+    delete matchable;
+  }
+  if (local_map_relocalized) {
+    ++_number_of_frame_relocalizations;
+    LOG_INFO(std::printf("Relocalizer::relocalize|relocalized frame [%06lu] in local map [%06lu] (inlier ratio: %5.3f)\n",
+                         frame_->identifier(), local_map_relocalized->identifier(), inlier_ratio_best))
+  }
+  CHRONOMETER_STOP(frame_relocalization)
+  unlockDatabase();
+  return local_map_relocalized;
+}
+
+void Relocalizer::detachAppearances(const HBSTTree::MatchableVector& appearances_) {
+
+  //ds count the matchables that lost their last landmark (a matchable can be shared by multiple culled landmarks)
+  HBSTTree::MatchableVector appearances(appearances_);
+  std::sort(appearances.begin(), appearances.end());
+  appearances.erase(std::unique(appearances.begin(), appearances.end()), appearances.end());
+  for (const HBSTMatchable* appearance: appearances) {
+    if (_isDetached(appearance)) {
+      ++_number_of_detached_matchables;
+    }
+  }
+}
+
+const Count Relocalizer::numberOfLiveMatchableBytes() {
+  std::lock_guard<std::mutex> lock_database(_mutex_database);
+  typedef decltype(HBSTMatchable::objects) HBSTObjectMap;
+
+  //ds merged matchables are shared by multiple places and counted once
+  std::set<const HBSTMatchable*> matchables_visited;
+  Count number_of_bytes = 0;
+  for (const Place& place: _places) {
+    for (const HBSTMatchable* matchable: place.matchables) {
+      if (matchables_visited.insert(matchable).second) {
+
+        //ds every object is a red-black tree node: color, parent and child links and the element itself
+        number_of_bytes += sizeof(HBSTMatchable)+matchable->objects.size()*(4*sizeof(void*)+sizeof(HBSTObjectMap::value_type));
+      }
+    }
+  }
+  return number_of_bytes;
+}
+
 void Relocalizer::clear() {
-  CHRONOMETER_START(overall)
   for(const Closure* closure: _closures) {
     delete closure;
   }
   _closures.clear();
-  _mask_id_references_for_correspondences.clear();
-  CHRONOMETER_STOP(overall)
+
+  //ds release the worker
+  {
+    std::lock_guard<std::mutex> lock(_mutex_queue);
+    _has_closures = false;
+  }
+  _condition_queue.notify_all();
 }
 
-//ds retrieve correspondences from matches
-Closure::Correspondence* Relocalizer::_getCorrespondenceNN(const Closure::CandidateVector& matches_) {
-  assert(0 < matches_.size());
+void Relocalizer::_registerCandidates(XYZAligner* aligner_) {
+  const Count number_of_closures = _closures.size();
+  const real& minimum_inlier_ratio_for_early_exit = _parameters->minimum_inlier_ratio_for_early_exit;
+
+  //ds candidates are taken in rank order, the lowest rank of a clearly accepted candidate bounds the evaluation
+  for (Index index = _index_closure_next++; index < number_of_closures; index = _index_closure_next++) {
+    if (index > _index_closure_accepted) {
+      continue;
+    }
+    Closure* closure = _closures[index];
+    aligner_->initialize(closure);
+    aligner_->converge();
+
+    //ds update the bound if the candidate is clearly accepted
+    if (_is_ranked && closure->is_valid && closure->icp_inlier_ratio >= minimum_inlier_ratio_for_early_exit) {
+      Index index_accepted_current = _index_closure_accepted;
+      while (index < index_accepted_current && !_index_closure_accepted.compare_exchange_weak(index_accepted_current, index)) {}
+    }
+  }
+}
+
+void Relocalizer::_processRegistrations(XYZAligner* aligner_, Count round_) {
+  while (true) {
+
+    //ds wait for the next registration round
+    {
+      std::unique_lock<std::mutex> lock(_mutex_registration);
+      _condition_registration.wait(lock, [this, &round_]{return !_is_registration_running || _registration_round != round_;});
+      if (!_is_registration_running) {
+        return;
+      }
+      round_ = _registration_round;
+    }
+    _registerCandidates(aligner_);
+
+    //ds report completion to the calling thread
+    {
+      std::lock_guard<std::mutex> lock(_mutex_registration);
+      --_number_of_registering_threads;
+    }
+    _condition_registration.notify_all();
+  }
+}
+
+void Relocalizer::_groupMatches(const HBSTTree::MatchVector& matches_) {
+  _match_groups.clear();
+  _match_group_order.clear();
+  _group_per_match.resize(matches_.size());
+  _group_indices.clear();
+  _group_indices.reserve(matches_.size());
+
+  //ds assign the matches to the groups of their query landmarks and count the group sizes
+  Count number_of_grouped_matches = 0;
+  for (Index index_match = 0; index_match < matches_.size(); ++index_match) {
+    const HBSTTree::Match& match = matches_[index_match];
+    _group_per_match[index_match] = invalid_group;
+
+    //ds skip matches with appearances of culled landmarks
+    if (!match.object_query || !match.object_references[0]) {
+      continue;
+    }
+
+    //ds we skip matches that have multiple candidates (with same distance) belonging to different landmarks due to ambiguity
+    bool has_multiple_landmarks = false;
+    for (Index index_reference = 1; index_reference < match.object_references.size(); ++index_reference) {
+      if (match.object_references[index_reference] != match.object_references[0]) {
+        has_multiple_landmarks = true;
+        break;
+      }
+    }
+    if (has_multiple_landmarks) {
+      continue;
+    }
+
+    //ds retrieve the group of the query landmark (adding a new one if not existing yet)
+    const std::pair<Index*, bool> entry = _group_indices.insert(match.object_query->identifier(), _match_groups.size());
+    if (entry.second) {
+      _match_groups.push_back(MatchGroup(match.object_query->identifier()));
+    }
+    _group_per_match[index_match] = *entry.first;
+    ++_match_groups[*entry.first].size;
+    ++number_of_grouped_matches;
+  }
+
+  //ds lay out the groups contiguously in increasing query landmark identifier order
+  _match_group_order.resize(_match_groups.size());
+  for (Index index_group = 0; index_group < _match_groups.size(); ++index_group) {
+    _match_group_order[index_group] = index_group;
+  }
+  std::sort(_match_group_order.begin(), _match_group_order.end(), [this](const Index& a_, const Index& b_) {
+    return _match_groups[a_].identifier_query < _match_groups[b_].identifier_query;
+  });
+  Index begin = 0;
+  for (const Index& index_group: _match_group_order) {
+    _match_groups[index_group].begin = begin;
+    begin += _match_groups[index_group].size;
+  }
+
+  //ds scatter the matches into their groups (keeping the match order within a group)
+  _grouped_matches.resize(number_of_grouped_matches);
+  for (MatchGroup& group: _match_groups) {
+    group.size = 0;
+  }
+  for (Index index_match = 0; index_match < matches_.size(); ++index_match) {
+    if (_group_per_match[index_match] != invalid_group) {
+      MatchGroup& group = _match_groups[_group_per_match[index_match]];
+      _grouped_matches[group.begin+group.size] = &matches_[index_match];
+      ++group.size;
+    }
+  }
+}
 
-  //ds point counts
-  std::multiset<Count> counts;
+const HBSTTree::Match* Relocalizer::_getBestMatch(const MatchGroup& group_, Count& count_best_) const {
+  assert(0 < group_.size);
+  const HBSTTree::Match* const* matches = &_grouped_matches[group_.begin];
 
   //ds best match and count so far
-  const Closure::Candidate* match_best = nullptr;
-  Count count_best = 0;
+  const HBSTTree::Match* match_best = nullptr;
+  count_best_ = 0;
 
-  //ds loop over the list and count entries
-  for (const Closure::Candidate& match: matches_) {
+  //ds loop over the group and count the matches per reference landmark - groups are small, counting in place is cheaper than any container
+  for (Index u = 0; u < group_.size; ++u) {
+    const Landmark* landmark_reference = matches[u]->object_references[0];
 
-    //ds update count - if not in the mask
-    if (0 == _mask_id_references_for_correspondences.count(match.reference->identifier())) {
-      counts.insert(match.reference->identifier());
-      const Count count_current = counts.count(match.reference->identifier());
+    //ds skip masked references (all matches to the same reference are masked as well)
+    const Index* stamp = _masked_references.find(landmark_reference->identifier());
+    if (stamp && *stamp == _mask_stamp) {
+      continue;
+    }
 
-      //ds if we get a better count
-      if (count_best < count_current) {
-        count_best = count_current;
-        match_best = &match;
+    //ds number of matches to this reference so far
+    Count count_current = 1;
+    for (Index v = 0; v < u; ++v) {
+      if (matches[v]->object_references[0] == landmark_reference) {
+        ++count_current;
       }
     }
+
+    //ds if we get a better count
+    if (count_best_ < count_current) {
+      count_best_ = count_current;
+      match_best  = matches[u];
+    }
   }
+  return match_best;
+}
+
+//ds retrieve correspondences from matches
+Closure::Correspondence* Relocalizer::_getCorrespondenceNN(const MatchGroup& group_,
+                                                           const LocalMap* local_map_query_,
+                                                           const LocalMap* local_map_reference_) {
+  Count count_best = 0;
+  const HBSTTree::Match* match_best = _getBestMatch(group_, count_best);
 
   //ds if a match was found with sufficient confidence
   if (match_best && count_best > _parameters->minimum_matches_per_correspondence) {
+    Landmark* landmark_query     = match_best->object_query;
+    Landmark* landmark_reference = match_best->object_references[0];
+
+    //ds retrieve the landmark snapshots in the local maps - skipping landmarks that are not contained anymore
+    LocalMap::LandmarkStateMap::const_iterator state_query     = local_map_query_->landmarks().find(landmark_query->identifier());
+    LocalMap::LandmarkStateMap::const_iterator state_reference = local_map_reference_->landmarks().find(landmark_reference->identifier());
+    if (state_query == local_map_query_->landmarks().end() || state_reference == local_map_reference_->landmarks().end()) {
+      return nullptr;
+    }
 
     //ds block matching against this point by adding it to the mask
-    _mask_id_references_for_correspondences.insert(match_best->reference->identifier());
+    const std::pair<Index*, bool> entry = _masked_references.insert(landmark_reference->identifier(), _mask_stamp);
+    *entry.first = _mask_stamp;
 
     //ds return the found correspondence
-    return new Closure::Correspondence(match_best->query,
-                                       match_best->reference,
-                                       count_best, static_cast<real>(count_best)/matches_.size());
+    return new Closure::Correspondence(landmark_query,
+                                       landmark_reference,
+                                       count_best, static_cast<real>(count_best)/group_.size,
+                                       state_query->second.coordinates_in_local_map,
+                                       state_reference->second.coordinates_in_local_map);
   }
 
   //ds no match was found
   return nullptr;
 }
+
+void Relocalizer::_redirectAppearances(const HBSTTree::MatchableMergeVector& merges_) {
+  for (const HBSTTree::MatchableMerge& merge: merges_) {
+
+    //ds recall that merge.query is already freed (the pointer is only used as key), the absorbing matchable carries all its objects
+    //ds every landmark of the merged matchable has to be redirected, not only the first one (shared matchables of multiple places)
+    for (const std::pair<const uint64_t, Landmark*>& object: merge.reference->objects) {
+      if (object.second && object.second->appearances().count(const_cast<HBSTMatchable*>(merge.query))) {
+        object.second->replace(merge.query, merge.reference);
+      }
+    }
+  }
+  _number_of_freed_matchables += merges_.size();
+}
+
+void Relocalizer::_integrateMerges(const HBSTTree::MatchableMergeVector& merges_, Place* place_) {
+
+  //ds merged matchables sorted for lookup: <merged (freed) matchable, absorbing matchable>
+  std::vector<std::pair<const HBSTMatchable*, HBSTMatchable*>> replacements;
+  replacements.reserve(merges_.size());
+  for (const HBSTTree::MatchableMerge& merge: merges_) {
+    replacements.push_back(std::make_pair(merge.query, merge.reference));
+  }
+  std::sort(replacements.begin(), replacements.end());
+
+  //ds update the place bookkeeping (the absorbing matchables carry the appearances from now on)
+  auto replace = [&replacements](Place& place_) {
+    bool has_replacements = false;
+    for (HBSTMatchable*& matchable: place_.matchables) {
+      std::vector<std::pair<const HBSTMatchable*, HBSTMatchable*>>::const_iterator replacement =
+        std::lower_bound(replacements.begin(), replacements.end(), std::make_pair(static_cast<const HBSTMatchable*>(matchable), static_cast<HBSTMatchable*>(nullptr)));
+      if (replacement != replacements.end() && replacement->first == matchable) {
+        matchable        = replacement->second;
+        has_replacements = true;
+      }
+    }
+    if (has_replacements) {
+      std::sort(place_.matchables.begin(), place_.matchables.end());
+      place_.matchables.erase(std::unique(place_.matchables.begin(), place_.matchables.end()), place_.matchables.end());
+    }
+  };
+  if (place_) {
+    replace(*place_);
+  } else {
+    for (Place& place: _places) {
+      if (place.local_map) {
+        replace(place);
+      }
+    }
+  }
+}
+
+void Relocalizer::_maintainDatabase(std::unique_lock<std::mutex>& lock_local_maps_) {
+  CHRONOMETER_START(database_rebuild)
+  const Count number_of_places_before = _number_of_places;
+
+  //ds evict places down to a fraction of the capacity (a single rebuild covers multiple added places)
+  const Count& maximum_number_of_places = _parameters->maximum_number_of_places;
+  if (maximum_number_of_places > 0 && _number_of_places > maximum_number_of_places) {
+    const Count number_of_places_target = std::max(maximum_number_of_places-maximum_number_of_places/10, static_cast<Count>(1));
+
+    //ds eviction candidates: places that are in query range (recent places are always kept): <score, addition index>
+    //ds places with the lowest score are evicted first, ties are resolved by age
+    const Count maximum_index_added = _number_of_places_added-std::min(_parameters->preliminary_minimum_interspace_queries, _number_of_places_added);
+    std::vector<std::pair<real, Identifier>> candidates;
+    candidates.reserve(_number_of_places);
+    for (Identifier identifier = 0; identifier < _places.size(); ++identifier) {
+      const Place& place = _places[identifier];
+      if (!place.local_map || place.index_added >= maximum_index_added) {
+        continue;
+      }
+      real score = 0;
+      switch (_eviction_policy) {
+        case EvictionPolicy::Oldest: {
+          score = place.index_added;
+          break;
+        }
+        case EvictionPolicy::LeastMatched: {
+          score = place.number_of_matches;
+          break;
+        }
+        case EvictionPolicy::SpatiallyRedundant: {
+
+          //ds the place is redundant if another remaining place observes most of its landmarks (covisibility)
+          real maximum_shared_ratio = 0;
+          for (const LocalMap::CovisibilityMap::Element& neighbor: place.local_map->covisibleLocalMaps()) {
+            if (neighbor.first->identifier() < _places.size() && _places[neighbor.first->identifier()].local_map) {
+              maximum_shared_ratio = std::max(maximum_shared_ratio, static_cast<real>(neighbor.second)/std::max(place.local_map->landmarks().size(), static_cast<Count>(1)));
+            }
+          }
+          score = -maximum_shared_ratio;
+          break;
+        }
+      }
+      candidates.push_back(std::make_pair(score, place.index_added));
+    }
+    std::sort(candidates.begin(), candidates.end());
+
+    //ds mark the places with the lowest scores for eviction
+    std::vector<bool> is_evicted(_number_of_places_added, false);
+    const Count number_of_evictions = std::min(_number_of_places-number_of_places_target, static_cast<Count>(candidates.size()));
+    for (Index index = 0; index < number_of_evictions; ++index) {
+      is_evicted[candidates[index].second] = true;
+    }
+    for (Place& place: _places) {
+      if (!place.local_map || !is_evicted[place.index_added]) {
+        continue;
+      }
+
+      //ds never evict both of two mutually redundant places (the location would be lost)
+      if (_eviction_policy == EvictionPolicy::SpatiallyRedundant) {
+        bool has_remaining_neighbor = false;
+        for (const LocalMap::CovisibilityMap::Element& neighbor: place.local_map->covisibleLocalMaps()) {
+          const Identifier& identifier_neighbor = neighbor.first->identifier();
+          if (identifier_neighbor < _places.size() && _places[identifier_neighbor].local_map &&
+              !is_evicted[_places[identifier_neighbor].index_added]) {
+            has_remaining_neighbor = true;
+            break;
+          }
+        }
+        if (!has_remaining_neighbor && !place.local_map->covisibleLocalMaps().empty()) {
+          is_evicted[place.index_added] = false;
+          continue;
+        }
+      }
+      _evict(place);
+    }
+  }
+
+  //ds drop the matchables without any landmark left (culled), they are freed once the current database is replaced
+  HBSTTree::MatchableVector matchables_detached;
+  for (Place& place: _places) {
+    if (!place.local_map) {
+      continue;
+    }
+    for (HBSTMatchable* matchable: place.matchables) {
+      if (_isDetached(matchable)) {
+        matchables_detached.push_back(matchable);
+      }
+    }
+    place.matchables.erase(std::remove_if(place.matchables.begin(), place.matchables.end(),
+                                          [this](const HBSTMatchable* matchable_) {return _isDetached(matchable_);}), place.matchables.end());
+  }
+  std::sort(matchables_detached.begin(), matchables_detached.end());
+  matchables_detached.erase(std::unique(matchables_detached.begin(), matchables_detached.end()), matchables_detached.end());
+
+  //ds build a new database from the descriptors of the remaining places, local map creation is blocked only while a place is added
+  //ds the current database is not accessed meanwhile (database guard) and references evicted matchables until it is replaced
+  lock_local_maps_.unlock();
+  BasePlaceDatabase* place_database = _createPlaceDatabase();
+  HBSTTree::MatchableMergeVector merges;
+  std::vector<const HBSTMatchable*> matchables_merged;
+  for (Identifier identifier = 0; identifier < _places.size(); ++identifier) {
+    const Place& place = _places[identifier];
+    if (!place.local_map) {
+      continue;
+    }
+
+    //ds shared matchables are added once, with the oldest remaining place
+    //ds matchables merged (freed) during this rebuild are still listed by later places and must not be accessed
+    HBSTTree::MatchableVector matchables;
+    matchables.reserve(place.matchables.size());
+    for (HBSTMatchable* matchable: place.matchables) {
+      if (!std::binary_search(matchables_merged.begin(), matchables_merged.end(), matchable) &&
+          matchable->objects.begin()->first == identifier) {
+        matchables.push_back(matchable);
+      }
+    }
+    if (matchables.empty()) {
+      continue;
+    }
+
+    //ds merges free matchables that are referenced by landmark appearances: the appearances are redirected before
+    //ds local maps (and with them new matchables, possibly at a freed address) can be created again
+    lock_local_maps_.lock();
+    place_database->add(matchables);
+#ifdef SRRG_MERGE_DESCRIPTORS
+    const HBSTTree::MatchableMergeVector merges_place = place_database->getMerges();
+    if (!merges_place.empty()) {
+      _redirectAppearances(merges_place);
+      merges.insert(merges.end(), merges_place.begin(), merges_place.end());
+      const Count number_of_matchables_merged = matchables_merged.size();
+      for (const HBSTTree::MatchableMerge& merge: merges_place) {
+        matchables_merged.push_back(merge.query);
+      }
+      std::sort(matchables_merged.begin()+number_of_matchables_merged, matchables_merged.end());
+      std::inplace_merge(matchables_merged.begin(), matchables_merged.begin()+number_of_matchables_merged, matchables_merged.end());
+    }
+#endif
+    lock_local_maps_.unlock();
+  }
+
+  //ds swap in the new database
+  lock_local_maps_.lock();
+  if (!merges.empty()) {
+    _integrateMerges(merges, nullptr);
+  }
+  std::swap(_place_database, place_database);
+  place_database->clear(false);
+  delete place_database;
+  for (HBSTMatchable* matchable: matchables_detached) {
+    delete matchable;
+  }
+  _number_of_freed_matchables += matchables_detached.size();
+  _number_of_detached_matchables = 0;
+  _number_of_places_added_since_rebuild = 0;
+  ++_number_of_rebuilds;
+  CHRONOMETER_STOP(database_rebuild)
+  LOG_INFO(std::cerr << "Relocalizer::_maintainDatabase|rebuilt place database with places: " << _number_of_places
+                     << " (evicted: " << number_of_places_before-_number_of_places
+                     << " freed detached matchables: " << matchables_detached.size() << ")" << std::endl)
+}
+
+void Relocalizer::_evict(Place& place_) {
+  const Identifier& identifier = place_.local_map->identifier();
+  for (HBSTMatchable* matchable: place_.matchables) {
+
+    //ds detach the appearance of this place from its landmark (if not culled)
+    std::map<uint64_t, Landmark*>::iterator object = matchable->objects.find(identifier);
+    if (object != matchable->objects.end()) {
+      if (object->second) {
+        object->second->removeAppearance(matchable);
+      }
+      matchable->objects.erase(object);
+    }
+
+    //ds free the matchable if it does not carry appearances of other places
+    if (matchable->objects.empty()) {
+      delete matchable;
+      ++_number_of_freed_matchables;
+    }
+  }
+  HBSTTree::MatchableVector().swap(place_.matchables);
+  place_.local_map = nullptr;
+  --_number_of_places;
+  ++_number_of_evicted_places;
+}
+
+const bool Relocalizer::_isDetached(const HBSTMatchable* matchable_) const {
+  for (const std::pair<const uint64_t, Landmark*>& object: matchable_->objects) {
+    if (object.second) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const bool Relocalizer::_isInsideGate(const Place& reference_, const Place& query_) const {
+  if (_gating == Gating::None || !reference_.is_connected || !query_.is_connected) {
+    return true;
+  }
+
+  //ds the pose uncertainty grows with the distance traveled since the reference (odometry drift)
+  const real radius = _parameters->gating_minimum_radius_meters+
+                      _parameters->gating_drift_ratio*(query_.distance_traveled-reference_.distance_traveled);
+  return (query_.position-reference_.position).squaredNorm() <= radius*radius;
+}
+
+void Relocalizer::_applyPlacePositions() {
+  std::lock_guard<std::mutex> lock(_mutex_queue);
+  for (const std::pair<Identifier, PointCoordinates>& position: _place_positions_pending) {
+    if (position.first < _places.size()) {
+      _places[position.first].position = position.second;
+      if (_are_tracks_connected_pending) {
+        _places[position.first].is_connected = true;
+      }
+    }
+  }
+  _place_positions_pending.clear();
+}
+
+BasePlaceDatabase* Relocalizer::_createPlaceDatabase() const {
+  if (_parameters->place_database_type == "HBST") {
+    return new HBSTPlaceDatabase(_parameters);
+  } else if (_parameters->place_database_type == "BRUTE_FORCE") {
+    return new BruteForcePlaceDatabase(_parameters);
+  } else if (_parameters->place_database_type == "BAG_OF_WORDS") {
+    return new BagOfWordsPlaceDatabase(_parameters);
+  } else {
+    throw std::runtime_error("Relocalizer::_createPlaceDatabase|invalid place database type: " + _parameters->place_database_type);
+  }
+}
+
+void Relocalizer::_clearDatabase() {
+  if (_place_database) {
+    _place_database->clear(true);
+    delete _place_database;
+    _place_database = nullptr;
+  }
+  _places.clear();
+  _number_of_places       = 0;
+  _number_of_places_added = 0;
+  _number_of_places_added_since_rebuild = 0;
+  _number_of_added_matchables = 0;
+  _number_of_freed_matchables = 0;
+  _number_of_detached_matchables = 0;
+  _distance_traveled          = 0;
+  _identifier_last_place      = 0;
+}
+
+void Relocalizer::_processQueue() {
+  while (true) {
+
+    //ds wait for a local map - not taking a new one before the available closures have been integrated
+    Query query(nullptr, PointCoordinates::Zero(), true);
+    {
+      std::unique_lock<std::mutex> lock(_mutex_queue);
+      _condition_queue.wait(lock, [this]{return !_is_running || (!_local_maps_queued.empty() && !_has_closures);});
+      if (!_is_running) {
+        return;
+      }
+      query = _local_maps_queued.front();
+      _local_maps_queued.pop_front();
+      _is_processing = true;
+    }
+
+    //ds the full pipeline for a single local map
+    detectClosures(query.local_map, query.position, query.is_connected);
+    registerClosures();
+
+    //ds publish the closures
+    {
+      std::lock_guard<std::mutex> lock(_mutex_queue);
+      _is_processing = false;
+      _has_closures  = !_closures.empty();
+    }
+    _condition_queue.notify_all();
+  }
+}
+
+void Relocalizer::_stopRegistration() {
+  {
+    std::lock_guard<std::mutex> lock(_mutex_registration);
+    _is_registration_running = false;
+  }
+  _condition_registration.notify_all();
+  for (std::thread& thread: _registration_threads) {
+    thread.join();
+  }
+  _registration_threads.clear();
+}
+
+void Relocalizer::_stop() {
+  if (!_worker.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lock(_mutex_queue);
+    _is_running = false;
+  }
+  _condition_queue.notify_all();
+  _worker.join();
+  LOG_INFO(std::cerr << "Relocalizer::_stop|stopped worker thread (discarded local maps: " << _local_maps_queued.size() << ")" << std::endl)
+
+  //ds closures that were not integrated are freed including their correspondences
+  _local_maps_queued.clear();
+  for (Closure* closure: _closures) {
+    closure->is_valid = false;
+  }
+  clear();
+}
 }
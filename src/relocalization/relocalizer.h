@@ -1,5 +1,13 @@
 #pragma once
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 #include "aligners/xyz_aligner.h"
+#include "hbst_place_database.h"
+#include "brute_force_place_database.h"
+#include "bag_of_words_place_database.h"
 #include "closure.h"
 
 namespace proslam {
@@ -13,10 +21,33 @@ PROSLAM_MAKE_PROCESSING_CLASS(Relocalizer)
 //ds interface
 public:
 
+  //! @brief detects and registers closures for a new local map: immediately or queued for the worker thread (asynchronous processing)
+  //! results are available for integration once hasClosures() is true
+  //! @param[in] local_map_query_ the new local map, containing descriptors for its landmarks
+  //! or a local map that absorbed a folded window, containing descriptors for the absorbed landmarks (its place is extended)
+  //! @param[in] is_connected_ false if the local map belongs to a track segment that is not connected to the map (no spatial gating)
+  void process(LocalMap* local_map_query_, const bool& is_connected_ = true);
+
+  //! @brief refreshes the world positions of the places (spatial gating) after the map has been optimized or a track has been relocalized
+  //! the positions are taken by the calling thread (owning the poses) and applied by the next query
+  //! @param[in] local_maps_ all local maps of the map
+  //! @param[in] are_tracks_connected_ true if all track segments are connected to the map (places of disconnected segments are gated again)
+  void updatePlacePositions(const LocalMapPointerVector& local_maps_, const bool& are_tracks_connected_);
+
+  //! @brief blocks until all queued local maps have been processed (asynchronous processing)
+  void synchronize();
+
+  //! @brief true if closures are available for integration, the worker does not process further local maps until clear() is called
+  const bool hasClosures();
+
   //ds retrieve loop closure candidates for the given local map, containing descriptors for its landmarks
-  void detectClosures(LocalMap* local_map_query_);
+  //! @param[in] local_map_query_ the new local map
+  //! @param[in] position_query_ world position of the query local map at the time it was processed (spatial gating)
+  //! @param[in] is_connected_ false if the query belongs to a track segment that is not connected to the map (no spatial gating)
+  void detectClosures(LocalMap* local_map_query_, const PointCoordinates& position_query_, const bool& is_connected_ = true);
 
-  //ds geometric verification and determination of spatial relation between closure set
+  //! @brief geometric verification and determination of spatial relation between closure set
+  //! candidates are registered in parallel (persistent registration threads), candidates ranked behind a clearly accepted one are skipped
   void registerClosures();
 
   //ds clear currently available closure buffer
@@ -25,38 +56,254 @@ public:
   //! @brief keeps only a single closure, based on the maximum relative number of correspodences TODO add proper constraints
   void prune();
 
+  //! @brief registers a frame against the best matching places of the database (track loss), the database is not modified
+  //! the call returns immediately if the place database is busy (worker thread), such that it can be issued at every lost frame
+  //! @param[in] frame_ the frame to relocalize, described by the descriptors of its framepoints
+  //! @param[out] robot_to_local_map_ the frame pose in the returned local map
+  //! @return the local map the frame was registered against or nullptr if the relocalization failed
+  const LocalMap* relocalize(const Frame* frame_, TransformMatrix3D& robot_to_local_map_);
+
+  //! @brief registers the appearances of culled landmarks (database guard required), matchables without any landmark left
+  //! are dropped and freed at the next database rebuild, which is triggered once they make up a tenth of the live matchables
+  //! @param[in] appearances_ the appearances of the culled landmarks
+  void detachAppearances(const HBSTTree::MatchableVector& appearances_);
+
 //ds getters/setters
 public:
 
   inline const ClosurePointerVector& closures() const {return _closures;}
-  XYZAlignerPtr aligner() {return _aligner;}
+  XYZAlignerPtr aligner() {return _aligners.front();}
+  inline const Count& numberOfSkippedRegistrations() const {return _number_of_skipped_registrations;}
+  inline const Count& numberOfPlaces() const {return _number_of_places;}
+  inline const Count& numberOfEvictedPlaces() const {return _number_of_evicted_places;}
+  inline const Count& numberOfRebuilds() const {return _number_of_rebuilds;}
+  inline const Count& numberOfAddedMatchables() const {return _number_of_added_matchables;}
+  inline const Count& numberOfGatedQueries() const {return _number_of_gated_queries;}
+  inline const Count& numberOfGatedCandidates() const {return _number_of_gated_candidates;}
+  inline const Count& numberOfFrameRelocalizationAttempts() const {return _number_of_frame_relocalization_attempts;}
+  inline const Count& numberOfPostponedFrameRelocalizations() const {return _number_of_postponed_frame_relocalizations;}
+  inline const Count& numberOfFrameRelocalizations() const {return _number_of_frame_relocalizations;}
+  inline const Count& numberOfDetachedMatchables() const {return _number_of_detached_matchables;}
+
+  //! @brief number of matchables (appearances) currently owned by the place database
+  inline const Count numberOfLiveMatchables() const {return _number_of_added_matchables-_number_of_freed_matchables;}
+
+  //! @brief memory of the matchables currently owned by the place database including their object map nodes (excluding tree nodes)
+  //! all place matchables are visited under the database guard, intended for reports
+  const Count numberOfLiveMatchableBytes();
+  inline const bool isAsynchronous() const {return _parameters->enable_asynchronous_processing;}
+
+  //! @brief guards the local map structures read by the worker (landmark snapshots, covisibility), required to create local maps
+  void lockLocalMaps() {_mutex_local_maps.lock();}
+  void unlockLocalMaps() {_mutex_local_maps.unlock();}
+
+  //! @brief guards the place database and the local maps, required to merge or free landmarks
+  void lockDatabase() {std::lock(_mutex_database, _mutex_local_maps);}
+  const bool tryLockDatabase() {return std::try_lock(_mutex_database, _mutex_local_maps) == -1;}
+  void unlockDatabase() {_mutex_local_maps.unlock(); _mutex_database.unlock();}
 
 //ds helpers
 protected:
 
+  //! @brief place eviction policies (RelocalizerParameters::place_eviction_policy)
+  enum class EvictionPolicy {
+    Oldest,
+    LeastMatched,
+    SpatiallyRedundant
+  };
+
+  //! @brief closure query gating modes (RelocalizerParameters::closure_query_gating)
+  enum class Gating {
+    None,
+    Spatial
+  };
+
+  //! @brief bookkeeping of a place (= local map) added to the place database
+  struct Place {
+    const LocalMap* local_map = nullptr; //ds nullptr if the place is not (anymore) in the database
+    Index index_added         = 0;       //ds position in the sequence of added places
+    Count number_of_matches   = 0;       //ds number of times the place qualified as closure candidate
+    PointCoordinates position = PointCoordinates::Zero(); //ds world position, refreshed after optimizations (updatePlacePositions)
+    real distance_traveled    = 0;       //ds distance traveled along the added places until this place
+    bool is_connected         = true;    //ds false if added on a track segment not connected to the map (bypasses spatial gating)
+    HBSTTree::MatchableVector matchables; //ds matchables carrying an appearance of this place (merged matchables are shared)
+  };
+
+  //! @brief a local map queued for the worker thread, with its pose information taken by the calling thread
+  struct Query {
+    Query(LocalMap* local_map_, const PointCoordinates& position_, const bool& is_connected_): local_map(local_map_),
+                                                                                                position(position_),
+                                                                                                is_connected(is_connected_) {}
+    LocalMap* local_map;
+    PointCoordinates position;
+    bool is_connected;
+  };
+
+  //! @brief unambiguous matches of a single query landmark, a contiguous range in _grouped_matches
+  struct MatchGroup {
+    MatchGroup(const Identifier& identifier_query_): identifier_query(identifier_query_) {}
+    Identifier identifier_query;
+    Index begin = 0;
+    Count size  = 0;
+  };
+
+  //! @brief marks matches that are not assigned to any group
+  static constexpr Index invalid_group = std::numeric_limits<Index>::max();
+
+  //! @brief registers closure candidates until none are left (called by the calling thread and each registration thread)
+  //! @param[in] aligner_ the aligner workspace of the thread
+  void _registerCandidates(XYZAligner* aligner_);
+
+  //! @brief registration thread loop: takes part in each registration round until stopped
+  //! @param[in] aligner_ the aligner workspace of the thread
+  //! @param[in] round_ the registration round at launch
+  void _processRegistrations(XYZAligner* aligner_, Count round_);
+
+  //! @brief stops and joins the registration threads
+  void _stopRegistration();
+
+  //! @brief groups the unambiguous matches of a reference per query landmark (no allocations once the buffers are warm)
+  //! fills _match_groups, _match_group_order (increasing query landmark identifier) and _grouped_matches
+  //! @param[in] matches_ HBST matches of the query local map against a single reference
+  void _groupMatches(const HBSTTree::MatchVector& matches_);
+
+  //! @brief selects the match to the reference landmark with the most matches in a group (in place, masked references are skipped)
+  //! @param[in] group_ the match group of a query landmark
+  //! @param[out] count_best_ number of matches to the selected reference landmark
+  //! @return the first match to the selected reference landmark or nullptr if all references are masked
+  const HBSTTree::Match* _getBestMatch(const MatchGroup& group_, Count& count_best_) const;
+
   //ds retrieve correspondences from matches
-  inline Closure::Correspondence* _getCorrespondenceNN(const Closure::CandidateVector& matches_);
+  Closure::Correspondence* _getCorrespondenceNN(const MatchGroup& group_,
+                                                const LocalMap* local_map_query_,
+                                                const LocalMap* local_map_reference_);
+
+  //! @brief replaces merged (freed) matchables by their merge references in the appearances of all landmarks they carried
+  //! must be called before new matchables can be allocated (local map guard), freed addresses might be reused otherwise
+  //! @param[in] merges_ merges of the last HBST add call
+  void _redirectAppearances(const HBSTTree::MatchableMergeVector& merges_);
+
+  //! @brief replaces merged (freed) matchables by their merge references in the place bookkeeping
+  //! @param[in] merges_ merges of the last HBST add call(s)
+  //! @param[in] place_ the place whose matchables were added, nullptr to update all places
+  void _integrateMerges(const HBSTTree::MatchableMergeVector& merges_, Place* place_);
+
+  //! @brief evicts places exceeding the capacity and rebuilds the place database from the remaining descriptors if required
+  //! the new database is built place by place, local map creation is only blocked while a place is added
+  //! @param[in,out] lock_local_maps_ local map guard, owned on call and on return
+  void _maintainDatabase(std::unique_lock<std::mutex>& lock_local_maps_);
+
+  //! @brief removes a place from the bookkeeping: its appearances are detached from the landmarks, unshared matchables are freed
+  //! @param[in,out] place_ the place to evict
+  void _evict(Place& place_);
+
+  //! @brief checks if a matchable carries no landmark anymore (all its landmarks have been culled)
+  const bool _isDetached(const HBSTMatchable* matchable_) const;
+
+  //! @brief checks if a reference place can close a loop with the query place under the configured gating
+  //! @param[in] reference_ the reference place (added before the query)
+  //! @param[in] query_ the query place
+  //! @return true if the reference lies within the pose uncertainty radius of the query
+  //! (always true without gating or if one of the places lies on a track segment not connected to the map)
+  const bool _isInsideGate(const Place& reference_, const Place& query_) const;
+
+  //! @brief applies the place positions refreshed by updatePlacePositions (database guard required)
+  void _applyPlacePositions();
+
+  //! @brief allocates an empty place database of the configured type (RelocalizerParameters::place_database_type)
+  BasePlaceDatabase* _createPlaceDatabase() const;
+
+  //! @brief frees the place database and its matchables
+  void _clearDatabase();
+
+  //! @brief worker thread loop: processes queued local maps until stopped
+  void _processQueue();
+
+  //! @brief stops and joins the worker thread, discarding queued local maps and unconsumed closures
+  void _stop();
 
 protected:
 
   //ds buffer of found closures (last compute call)
   ClosurePointerVector _closures;
 
-  //ds local map to local map alignment
-  XYZAlignerPtr _aligner = nullptr;
+  //ds local map to local map alignment (one aligner workspace per registration thread)
+  std::vector<XYZAlignerPtr> _aligners;
+
+  //ds database of visited places (= local maps), storing a descriptor vector for each place (replaced on rebuild)
+  BasePlaceDatabase* _place_database = nullptr;
+
+  //ds places that have been added to the place database, indexed by local map identifier
+  std::vector<Place> _places;
+  Count _number_of_places       = 0;
+  Count _number_of_places_added = 0;
+  Count _number_of_places_added_since_rebuild = 0;
+  EvictionPolicy _eviction_policy = EvictionPolicy::LeastMatched;
+  Gating _gating = Gating::None;
+  real _distance_traveled = 0;
+  Identifier _identifier_last_place = 0;
+
+  //ds refreshed place positions, applied by the next query: <local map identifier, world position> (guarded by the queue mutex)
+  std::vector<std::pair<Identifier, PointCoordinates>> _place_positions_pending;
+  bool _are_tracks_connected_pending = false;
 
-  //ds database of visited places (= local maps), storing a descriptor vector for each place
-  HBSTTree _place_database;
+  //ds candidate reference buffer: <matching ratio, reference local map identifier>
+  std::vector<std::pair<real, Index>> _references;
 
-  //ds local maps that have been added to the place database (in order of calls)
-  ConstLocalMapPointerVector _added_local_maps;
+  //ds match grouping buffers (reused between references and queries)
+  IdentifierHashMap<Index> _group_indices;
+  std::vector<Index> _group_per_match;
+  std::vector<MatchGroup> _match_groups;
+  std::vector<Index> _match_group_order;
+  std::vector<const HBSTTree::Match*> _grouped_matches;
 
-  //ds correspondence retrieval buffer
-  std::set<Identifier> _mask_id_references_for_correspondences;
+  //ds correspondence retrieval mask: reference landmarks carrying the current stamp are blocked
+  IdentifierHashMap<Index> _masked_references;
+  Index _mask_stamp = 0;
+
+  //ds worker thread and its local map queue (asynchronous processing)
+  std::thread _worker;
+  std::deque<Query> _local_maps_queued;
+  bool _is_running    = false;
+  bool _is_processing = false;
+  bool _has_closures  = false;
+  std::mutex _mutex_queue;
+  std::condition_variable _condition_queue;
+
+  //ds registration threads and the candidate bounds of the current registration round
+  std::vector<std::thread> _registration_threads;
+  std::mutex _mutex_registration;
+  std::condition_variable _condition_registration;
+  Count _registration_round            = 0;
+  Count _number_of_registering_threads = 0;
+  bool _is_registration_running        = false;
+  std::atomic<Index> _index_closure_next{0};
+  std::atomic<Index> _index_closure_accepted{0};
+  bool _is_ranked = true;
+
+  //ds shared data guards (always acquired in this order)
+  std::mutex _mutex_database;
+  std::mutex _mutex_local_maps;
 
 private:
 
+  //ds informative only
+  Count _number_of_skipped_registrations = 0;
+  Count _number_of_evicted_places = 0;
+  Count _number_of_rebuilds = 0;
+  Count _number_of_added_matchables = 0;
+  Count _number_of_freed_matchables = 0;
+  Count _number_of_detached_matchables = 0;
+  Count _number_of_gated_queries = 0;
+  Count _number_of_gated_candidates = 0;
+  Count _number_of_frame_relocalization_attempts = 0;
+  Count _number_of_postponed_frame_relocalizations = 0;
+  Count _number_of_frame_relocalizations = 0;
+
   CREATE_CHRONOMETER(overall)
+  CREATE_CHRONOMETER(covisibility_selection)
+  CREATE_CHRONOMETER(database_rebuild)
+  CREATE_CHRONOMETER(frame_relocalization)
 
 };
 }
@@ -96,6 +96,8 @@ void SLAMAssembly::_createDepthTracker(Camera* camera_left_, Camera* camera_righ
 
   //ds allocate and configure the aligner for motion estimation
   UVDAligner* pose_optimizer = new UVDAligner(_parameters->depth_tracker_parameters->aligner);
+  pose_optimizer->setMaximumDepthNearMeters(_parameters->depth_framepoint_generator_parameters->maximum_depth_near_meters);
+  pose_optimizer->setMaximumDepthFarMeters(_parameters->depth_framepoint_generator_parameters->maximum_depth_far_meters);
   pose_optimizer->configure();
 
   //ds allocate and configure the tracker
@@ -487,6 +489,9 @@ void SLAMAssembly::playbackMessageFile() {
     }
   }
   _message_reader.close();
+
+  //ds complete the pose graph optimizations still running in the background
+  _synchronizeOptimization();
   LOG_INFO(std::cerr << "SLAMAssembly::playbackMessageFile|dataset completed" << std::endl)
 }
 
@@ -530,43 +535,79 @@ void SLAMAssembly::process(const cv::Mat& intensity_image_left_,
     //ds set additional fields
     _world_map->currentFrame()->setTimestampImageLeftSeconds(timestamp_image_left_seconds_);
 
+    //ds register landmarks that lost track for culling
+    _world_map->updateLandmarkVisibility();
+
     //ds if relocalization is not disabled
     if (!_parameters->command_line_parameters->option_disable_relocalization) {
+      const bool is_asynchronous = _relocalizer->isAsynchronous();
+
+      //ds in deterministic mode the closures of the previous local map are always integrated in this frame
+      if (is_asynchronous && _parameters->relocalizer_parameters->enable_deterministic_processing) {
+        _relocalizer->synchronize();
+      }
+
+      //ds while the track is lost: try to register the current frame in the existing map (before the lost segment grows local maps)
+      if (_parameters->relocalizer_parameters->enable_frame_relocalization && _world_map->isTrackLost()) {
+        _relocalizeFrame();
+      }
 
       //ds local map generation - regardless of tracker state
       if (_map_viewer) {_map_viewer->lock();}
+      _relocalizer->lockLocalMaps();
       const bool created_local_map = _world_map->createLocalMap(_parameters->command_line_parameters->option_drop_framepoints);
+
+      //ds refine the most recent local maps before they are used for relocalization (bounded window)
+      if (created_local_map && _parameters->graph_optimizer_parameters->enable_local_bundle_adjustment) {
+        _graph_optimizer->optimizeLocalMaps(_world_map);
+      }
+      _relocalizer->unlockLocalMaps();
       if (_map_viewer) {_map_viewer->unlock();}
 
-      //ds if we successfully created a local map
-      if (created_local_map) {
+      //ds a window folded into an existing local map is queried as part of that local map (a revisit)
+      const bool query_local_map = created_local_map || _world_map->folded();
+
+      //ds if we successfully created a local map - localize in database (not yet optimizing the graph)
+      if (query_local_map && !is_asynchronous) {
+        _relocalizer->process(_world_map->currentLocalMap(), !_world_map->isTrackDisconnected());
+      }
 
-        //ds localize in database (not yet optimizing the graph)
-        _relocalizer->detectClosures(_world_map->currentLocalMap());
-        _relocalizer->registerClosures();
-//        _relocalizer->prune();
+      //ds integrate available closures (in asynchronous mode the query is a previously created local map)
+      LocalMap* local_map_relocalized = nullptr;
+      LocalMap::ClosureConstraintVector closures_added;
+      if (_relocalizer->hasClosures()) {
 
         //ds check the closures
         for(Closure* closure: _relocalizer->closures()) {
           if (closure->is_valid) {
-            assert(_world_map->currentLocalMap() == closure->local_map_query);
+            LocalMap* local_map_query = const_cast<LocalMap*>(closure->local_map_query);
+            local_map_relocalized     = local_map_query;
 
             //ds add loop closure constraint (merging corresponding landmarks)
-            _world_map->addLoopClosure(_world_map->currentLocalMap(),
+            _world_map->addLoopClosure(local_map_query,
                                        closure->local_map_reference,
                                        closure->query_to_reference,
                                        closure->correspondences,
                                        closure->icp_inlier_ratio);
+            closures_added.push_back(local_map_query->closures().back());
+
+            //ds the keyframe of the query might already have been added (asynchronous processing or a folded window)
+            //ds otherwise the closure is added together with the keyframe
+            if (_parameters->command_line_parameters->option_disable_bundle_adjustment) {
+              _graph_optimizer->addLoopClosure(local_map_query, local_map_query->closures().back());
+            }
             if (_parameters->command_line_parameters->option_use_gui) {
               for (const Closure::Correspondence* match: closure->correspondences) {
-                _world_map->landmarks().at(match->query->identifier())->setIsInLoopClosureQuery(true);
-                _world_map->landmarks().at(match->reference->identifier())->setIsInLoopClosureReference(true);
+                Landmark* landmark_query     = _world_map->landmarks().get(match->identifier_query);
+                Landmark* landmark_reference = _world_map->landmarks().get(match->identifier_reference);
+                if (landmark_query) {landmark_query->setIsInLoopClosureQuery(true);}
+                if (landmark_reference) {landmark_reference->setIsInLoopClosureReference(true);}
               }
             }
           }
         }
 
-        //ds clear buffer (automatically purges invalidated closures)
+        //ds clear buffer (automatically purges invalidated closures) - releasing the worker
         _relocalizer->clear();
       }
 
@@ -584,6 +625,11 @@ void SLAMAssembly::process(const cv::Mat& intensity_image_left_,
 
           //ds optimize graph
           _graph_optimizer->optimizeFramesWithLandmarks(_world_map);
+          _world_map->updateLandmarkVoxelHash();
+          _updatePlacePositions();
+
+          //ds cull landmarks (only right after an optimization, the pose graph references landmarks until then)
+          _cullLandmarks();
 
           //ds reenable the GUI
           if (_map_viewer) {_map_viewer->unlock();}
@@ -593,26 +639,40 @@ void SLAMAssembly::process(const cv::Mat& intensity_image_left_,
         //ds just add the frame to the pose graph
         _graph_optimizer->addFrame(_world_map->currentFrame());
 
-        //ds if we closed a local map - otherwise there is no need to optimize the pose graph
-        if (_world_map->relocalized()) {
+        //ds apply a completed background optimization (moving the frames added in the meantime along)
+        _integrateOptimization();
 
-          //ds check if we're running with a GUI and lock the GUI before the critical phase
-          if (_map_viewer) {_map_viewer->lock();}
+        //ds if we closed a local map - otherwise there is no need to optimize the pose graph
+        if (_world_map->relocalized() && local_map_relocalized) {
+          for (const LocalMap::ClosureConstraint& closure: closures_added) {
+            _closures_to_merge.push_back(closure);
+          }
 
-          //ds optimize pose graph with the loop closure constraint
-          _graph_optimizer->optimizeFrames(_world_map);
+          //ds optimize pose graph with the loop closure constraint - postponed while a background optimization is running
+          if (!_graph_optimizer->hasPendingOptimization()) {
+            _optimizeFrames();
+          }
+        }
 
-          //ds merge landmarks for the current local map and its closures
-          _world_map->mergeLandmarks(_world_map->currentLocalMap()->closures());
+        //ds cull landmarks
+        if (_map_viewer) {_map_viewer->lock();}
+        _cullLandmarks();
+        if (_map_viewer) {_map_viewer->unlock();}
+      }
 
-          //ds re-enable the GUI
-          if (_map_viewer) {_map_viewer->unlock();}
-        }
+      //ds queue the new local map once the map has been updated for this frame (no concurrent access in deterministic mode)
+      if (query_local_map && is_asynchronous) {
+        _relocalizer->process(_world_map->currentLocalMap(), !_world_map->isTrackDisconnected());
       }
-    } else if (_parameters->command_line_parameters->option_drop_framepoints) {
+    } else {
+
+      //ds cull landmarks
+      if (_map_viewer) {_map_viewer->lock();}
+      _world_map->cullLandmarks();
+      if (_map_viewer) {_map_viewer->unlock();}
 
       //ds free disconnected framepoints if available: TODO safe window
-      if (_world_map->frames().size() >= 500) {
+      if (_parameters->command_line_parameters->option_drop_framepoints && _world_map->frames().size() >= 500) {
         _world_map->frames().at(_world_map->frames().size()-500)->clear();
       }
     }
@@ -664,16 +724,40 @@ void SLAMAssembly::printReport() const {
   std::cerr << "           mean landmarks per frame: " << _tracker->totalNumberOfLandmarks()/_number_of_processed_frames << std::endl;
   std::cerr << "              mean tracks per frame: " << _tracker->totalNumberOfTrackedPoints()/_number_of_processed_frames << std::endl;
   std::cerr << "             mean tracks per second: " << _tracker->totalNumberOfTrackedPoints()/_processing_time_total_seconds << std::endl;
-  std::cerr << "            number of loop closures: " << _world_map->numberOfClosures() << std::endl;
+  std::cerr << "            number of loop closures: " << _world_map->numberOfClosures()
+            << " (skipped registrations: " << _relocalizer->numberOfSkippedRegistrations() << ")" << std::endl;
+  std::cerr << "    number of gated closure queries: " << _relocalizer->numberOfGatedQueries()
+            << " (gated candidates: " << _relocalizer->numberOfGatedCandidates() << ")" << std::endl;
+  std::cerr << "          number of database places: " << _relocalizer->numberOfPlaces()
+            << " (evicted: " << _relocalizer->numberOfEvictedPlaces() << " rebuilds: " << _relocalizer->numberOfRebuilds() << ")" << std::endl;
+  std::cerr << "     number of database descriptors: " << _relocalizer->numberOfAddedMatchables()
+            << " (per place: " << static_cast<real>(_relocalizer->numberOfAddedMatchables())/std::max(_world_map->localMaps().size(), static_cast<size_t>(1))
+            << " live: " << _relocalizer->numberOfLiveMatchables() << " MB: " << _relocalizer->numberOfLiveMatchableBytes()/1e6
+            << " landmark appearances: " << _world_map->numberOfLandmarkAppearances() << ")" << std::endl;
   std::cerr << "         number of merged landmarks: " << _world_map->numberOfMergedLandmarks()
             << " (of total landmarks: " << static_cast<real>(_world_map->numberOfMergedLandmarks())/_world_map->landmarks().size() <<  ")" << std::endl;
+  std::cerr << "         number of culled landmarks: " << _world_map->numberOfCulledLandmarks()
+            << " (postponed cullings: " << _number_of_postponed_cullings
+            << " detached descriptors: " << _relocalizer->numberOfDetachedMatchables() << ")" << std::endl;
+  std::cerr << "        number of folded local maps: " << _world_map->numberOfFoldedLocalMaps()
+            << " (created local maps: " << _world_map->localMaps().size() << ")" << std::endl;
+  std::cerr << " number of local bundle adjustments: " << _graph_optimizer->numberOfLocalOptimizations()
+            << " (skipped: " << _graph_optimizer->numberOfSkippedLocalOptimizations() << ")" << std::endl;
   std::cerr << "  number of recursive registrations: " << _tracker->numberOfRecursiveRegistrations() << std::endl;
+  std::cerr << "       number of relocalized tracks: " << _world_map->numberOfRelocalizedTracks()
+            << " (attempts: " << _relocalizer->numberOfFrameRelocalizationAttempts()
+            << " postponed: " << _relocalizer->numberOfPostponedFrameRelocalizations() << ")" << std::endl;
+  if (_world_map->numberOfRelocalizedTracks() > 0) {
+    std::cerr << "  mean time to relocalize (frames): " << static_cast<real>(_number_of_frames_to_relocalize)/_world_map->numberOfRelocalizedTracks()
+              << " (seconds: " << _duration_to_relocalize_seconds/_world_map->numberOfRelocalizedTracks() << ")" << std::endl;
+  }
 
   //ds display further information depending on tracking mode
   switch (_parameters->command_line_parameters->tracker_mode){
     case CommandLineParameters::TrackerMode::RGB_STEREO: {
       StereoFramePointGenerator* stereo_framepoint_generator = dynamic_cast<StereoFramePointGenerator*>(_tracker->framepointGenerator());
       std::cerr << "average triangulation success ratio: " << stereo_framepoint_generator->meanTriangulationSuccessRatio() << std::endl;
+      std::cerr << "     number of recovered map points: " << dynamic_cast<StereoTracker*>(_tracker)->totalNumberOfRecoveredMapPoints() << std::endl;
       break;
     }
     case CommandLineParameters::TrackerMode::RGB_DEPTH: {
@@ -705,6 +789,11 @@ void SLAMAssembly::printReport() const {
       break;
     }
     case CommandLineParameters::TrackerMode::RGB_DEPTH: {
+      DepthFramePointGenerator* depth_framepoint_generator = dynamic_cast<DepthFramePointGenerator*>(_tracker->framepointGenerator());
+      std::printf(" depth map registration | %f | %f\n", depth_framepoint_generator->getTimeConsumptionSeconds_depth_map_generation()/_processing_time_total_seconds,
+                                                             depth_framepoint_generator->getTimeConsumptionSeconds_depth_map_generation());
+      std::printf("       depth assignment | %f | %f\n", depth_framepoint_generator->getTimeConsumptionSeconds_depth_assignment()/_processing_time_total_seconds,
+                                                             depth_framepoint_generator->getTimeConsumptionSeconds_depth_assignment());
       break;
     }
     default: {
@@ -717,15 +806,165 @@ void SLAMAssembly::printReport() const {
   std::printf("  landmark optimization | %f | %f\n", _tracker->getTimeConsumptionSeconds_landmark_optimization()/_processing_time_total_seconds, _tracker->getTimeConsumptionSeconds_landmark_optimization());
   std::printf("         point recovery | %f | %f\n", _tracker->getTimeConsumptionSeconds_point_recovery()/_processing_time_total_seconds, _tracker->getTimeConsumptionSeconds_point_recovery());
   std::printf("         relocalization | %f | %f\n", _relocalizer->getTimeConsumptionSeconds_overall()/_processing_time_total_seconds, _relocalizer->getTimeConsumptionSeconds_overall());
+  std::printf("   covisibility queries | %f | %f\n", _relocalizer->getTimeConsumptionSeconds_covisibility_selection()/_processing_time_total_seconds, _relocalizer->getTimeConsumptionSeconds_covisibility_selection());
+  std::printf("       database rebuild | %f | %f\n", _relocalizer->getTimeConsumptionSeconds_database_rebuild()/_processing_time_total_seconds, _relocalizer->getTimeConsumptionSeconds_database_rebuild());
+  std::printf("   frame relocalization | %f | %f\n", _relocalizer->getTimeConsumptionSeconds_frame_relocalization()/_processing_time_total_seconds, _relocalizer->getTimeConsumptionSeconds_frame_relocalization());
   std::printf("    pose graph addition | %f | %f\n", _graph_optimizer->getTimeConsumptionSeconds_addition()/_processing_time_total_seconds, _graph_optimizer->getTimeConsumptionSeconds_addition());
   std::printf("pose graph optimization | %f | %f\n", _graph_optimizer->getTimeConsumptionSeconds_optimization()/_processing_time_total_seconds, _graph_optimizer->getTimeConsumptionSeconds_optimization());
+  std::printf("local bundle adjustment | %f | %f\n", _graph_optimizer->getTimeConsumptionSeconds_local_optimization()/_processing_time_total_seconds, _graph_optimizer->getTimeConsumptionSeconds_local_optimization());
   std::printf("       landmark merging | %f | %f\n", _world_map->getTimeConsumptionSeconds_landmark_merging()/_processing_time_total_seconds, _world_map->getTimeConsumptionSeconds_landmark_merging());
+  std::printf("       landmark culling | %f | %f\n", _world_map->getTimeConsumptionSeconds_landmark_culling()/_processing_time_total_seconds, _world_map->getTimeConsumptionSeconds_landmark_culling());
+  std::printf("  landmark voxel hashing | %f | %f\n", _world_map->getTimeConsumptionSeconds_landmark_voxel_hash_update()/_processing_time_total_seconds, _world_map->getTimeConsumptionSeconds_landmark_voxel_hash_update());
+
+  //ds graph optimization cost as a function of the graph size (vertices, in power of two bins)
+  if (!_graph_optimizer->optimizationStatistics().empty()) {
+    std::vector<std::pair<Count, double>> optimizations_per_bin;
+    for (const GraphOptimizer::OptimizationStatistics& statistics: _graph_optimizer->optimizationStatistics()) {
+      Index bin = 0;
+      while ((static_cast<Count>(2) << bin) <= statistics.number_of_vertices) {
+        ++bin;
+      }
+      if (optimizations_per_bin.size() <= bin) {
+        optimizations_per_bin.resize(bin+1, std::make_pair(0, 0));
+      }
+      ++optimizations_per_bin[bin].first;
+      optimizations_per_bin[bin].second += statistics.duration_seconds;
+    }
+    std::cerr << BAR << std::endl;
+    std::cerr << "graph optimization cost by graph size" << std::endl;
+    std::cerr << BAR << std::endl;
+    std::cerr << "          vertices | optimizations | mean duration (s)" << std::endl;
+    std::cerr << BAR << std::endl;
+    for (Index bin = 0; bin < optimizations_per_bin.size(); ++bin) {
+      if (optimizations_per_bin[bin].first > 0) {
+        std::printf(" %7lu - %7lu | %13lu | %f\n", static_cast<Count>(1) << bin, (static_cast<Count>(2) << bin)-1,
+                    optimizations_per_bin[bin].first, optimizations_per_bin[bin].second/optimizations_per_bin[bin].first);
+      }
+    }
+  }
   std::cerr << DOUBLE_BAR << std::endl;
 }
 
+void SLAMAssembly::_relocalizeFrame() {
+  Frame* frame = _world_map->currentFrame();
+  TransformMatrix3D robot_to_local_map(TransformMatrix3D::Identity());
+  const LocalMap* local_map_reference = _relocalizer->relocalize(frame, robot_to_local_map);
+  if (!local_map_reference) {
+    return;
+  }
+
+  //ds time since the track broke (the root of the lost segment is the frame at which the track broke)
+  const Frame* frame_track_break = _world_map->rootFrame();
+  _number_of_frames_to_relocalize += frame->identifier()-frame_track_break->identifier();
+  _duration_to_relocalize_seconds += frame->timestampImageLeftSeconds()-frame_track_break->timestampImageLeftSeconds();
+
+  //ds the lost track segment is moved below: no optimization result computed before may be applied afterwards
+  _synchronizeOptimization();
+
+  //ds move the lost track segment into the map frame and continue tracking from the registered pose
+  if (_map_viewer) {_map_viewer->lock();}
+  _world_map->relocalizeTrack(local_map_reference->localMapToWorld()*robot_to_local_map);
+  _graph_optimizer->updateEstimates();
+  _graph_optimizer->addFrameRelocalization(frame, local_map_reference, robot_to_local_map);
+  _updatePlacePositions();
+  if (_map_viewer) {_map_viewer->unlock();}
+}
+
+void SLAMAssembly::_optimizeFrames() {
+  if (_closures_to_merge.empty()) {
+    return;
+  }
+  _closures_in_optimization.clear();
+  _closures_in_optimization.swap(_closures_to_merge);
+
+  //ds check if we're running with a GUI and lock the GUI before the critical phase
+  if (_map_viewer) {_map_viewer->lock();}
+  _graph_optimizer->optimizeFrames(_world_map);
+
+  //ds in synchronous mode the optimization has already been applied
+  if (!_graph_optimizer->isAsynchronous()) {
+    _mergeLandmarks();
+  }
+  if (_map_viewer) {_map_viewer->unlock();}
+}
+
+void SLAMAssembly::_integrateOptimization() {
+  if (!_graph_optimizer->isAsynchronous()) {
+    return;
+  }
+  if (_map_viewer) {_map_viewer->lock();}
+  const bool applied = _graph_optimizer->integrateOptimization(_world_map);
+  if (applied) {
+    _mergeLandmarks();
+  }
+  if (_map_viewer) {_map_viewer->unlock();}
+
+  //ds closures that arrived during the optimization are handled by the next one
+  if (applied) {
+    _optimizeFrames();
+  }
+}
+
+void SLAMAssembly::_synchronizeOptimization() {
+  while (_graph_optimizer->hasPendingOptimization()) {
+    _graph_optimizer->synchronize();
+    _integrateOptimization();
+  }
+}
+
+void SLAMAssembly::_mergeLandmarks() {
+
+  //ds merge landmarks for the closures of the optimization (earlier closures of the query local maps have been merged already)
+  _relocalizer->lockDatabase();
+  _world_map->mergeLandmarks(_closures_in_optimization);
+  _relocalizer->unlockDatabase();
+  _closures_in_optimization.clear();
+
+  //ds landmark coordinates have been moved with their local maps
+  _world_map->updateLandmarkVoxelHash();
+  _updatePlacePositions();
+}
+
+void SLAMAssembly::_updatePlacePositions() {
+  if (!_parameters->command_line_parameters->option_disable_relocalization) {
+    _relocalizer->updatePlacePositions(_world_map->localMaps(), !_world_map->isTrackDisconnected());
+  }
+}
+
+void SLAMAssembly::_cullLandmarks() {
+
+  //ds landmarks referenced by the place database cannot be freed while the worker is matching - culling is postponed
+  //ds a continuously busy worker would postpone it indefinitely, hence we wait for the worker after a bounded number of postponements
+  if (_relocalizer->isAsynchronous()                                        &&
+      !_parameters->relocalizer_parameters->enable_deterministic_processing &&
+      _number_of_consecutive_postponed_cullings < _parameters->relocalizer_parameters->maximum_number_of_postponed_cullings) {
+    if (_relocalizer->tryLockDatabase()) {
+      _world_map->cullLandmarks();
+      _relocalizer->detachAppearances(_world_map->appearancesCulledLastCall());
+      _relocalizer->unlockDatabase();
+      _number_of_consecutive_postponed_cullings = 0;
+    } else {
+      ++_number_of_postponed_cullings;
+      ++_number_of_consecutive_postponed_cullings;
+    }
+  } else {
+    _relocalizer->lockDatabase();
+    _world_map->cullLandmarks();
+    _relocalizer->detachAppearances(_world_map->appearancesCulledLastCall());
+    _relocalizer->unlockDatabase();
+    _number_of_consecutive_postponed_cullings = 0;
+  }
+}
+
 void SLAMAssembly::reset() {
   _synchronizer.reset();
   _processing_times_seconds.clear();
+
+  //ds stop the relocalization and optimizer workers before freeing the local maps they might process
+  _relocalizer->configure();
+  _graph_optimizer->configure();
+  _closures_to_merge.clear();
+  _closures_in_optimization.clear();
   _world_map->clear();
 }
 }
@@ -106,6 +106,27 @@ protected:
 
   void _createDepthTracker(Camera* camera_left_, Camera* camera_right_);
 
+  //! @brief culls landmarks while the relocalization worker is not accessing them (postponed if busy in asynchronous mode)
+  void _cullLandmarks();
+
+  //! @brief registers the current frame of a lost track in the existing map and resumes the track on success
+  void _relocalizeFrame();
+
+  //! @brief starts a pose graph optimization for the closed local maps (merged once the optimization has been applied)
+  void _optimizeFrames();
+
+  //! @brief applies a completed background pose graph optimization and starts the one postponed by it (if any)
+  void _integrateOptimization();
+
+  //! @brief blocks until all started and postponed pose graph optimizations have been applied
+  void _synchronizeOptimization();
+
+  //! @brief merges the landmarks of the closures contained in the last applied pose graph optimization
+  void _mergeLandmarks();
+
+  //! @brief hands the optimized local map positions over to the relocalizer (spatial gating)
+  void _updatePlacePositions();
+
 //ds SLAM modules
 protected:
 
@@ -172,5 +193,19 @@ protected:
 
   //! @brief current average fps
   double _current_fps = 0;
+
+  //! @brief number of landmark culling calls postponed due to a busy relocalization worker
+  Count _number_of_postponed_cullings = 0;
+
+  //! @brief number of landmark culling calls postponed since the last culling (bounded by maximum_number_of_postponed_cullings)
+  Count _number_of_consecutive_postponed_cullings = 0;
+
+  //! @brief closures awaiting a pose graph optimization and those contained in the running one (landmarks merged afterwards)
+  LocalMap::ClosureConstraintVector _closures_to_merge;
+  LocalMap::ClosureConstraintVector _closures_in_optimization;
+
+  //! @brief accumulated time from track loss to frame relocalization (frames and seconds)
+  Count _number_of_frames_to_relocalize = 0;
+  double _duration_to_relocalize_seconds = 0;
 };
 }
@@ -0,0 +1,372 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <limits>
+#include <cassert>
+#include "definitions.h"
+
+namespace proslam {
+
+//! @class sorted set of pointers with inline storage for the first elements (no heap allocation for small sets)
+//! replaces std::set for per-object bookkeeping of only a handful of entries (e.g. landmark to local map links)
+//! iteration yields the elements in the same order as std::set (increasing pointer values)
+template<typename PointerType_, uint32_t inline_capacity_>
+class SmallPointerSet {
+
+//ds exported types
+public:
+
+  typedef PointerType_ const* const_iterator;
+  typedef PointerType_ const* iterator;
+
+//ds object handling
+public:
+
+  SmallPointerSet(): _data(_inline) {}
+
+  SmallPointerSet(const SmallPointerSet& other_): _data(_inline) {
+    insert(other_.begin(), other_.end());
+  }
+
+  SmallPointerSet& operator=(const SmallPointerSet& other_) {
+    if (this != &other_) {
+      clear();
+      insert(other_.begin(), other_.end());
+    }
+    return *this;
+  }
+
+  ~SmallPointerSet() {
+    if (_data != _inline) {
+      delete[] _data;
+    }
+  }
+
+//ds functionality
+public:
+
+  //! @brief inserts an element at its sorted position
+  //! @param[in] element_ the element to insert
+  //! @return true if the element was not present yet
+  bool insert(const PointerType_& element_) {
+    PointerType_* position = std::lower_bound(_data, _data+_size, element_, std::less<PointerType_>());
+    if (position != _data+_size && *position == element_) {
+      return false;
+    }
+
+    //ds grow storage if required (moving from inline to heap storage)
+    const uint32_t index = position-_data;
+    if (_size == _capacity) {
+      _capacity *= 2;
+      PointerType_* data = new PointerType_[_capacity];
+      std::memcpy(data, _data, _size*sizeof(PointerType_));
+      if (_data != _inline) {
+        delete[] _data;
+      }
+      _data = data;
+    }
+
+    //ds shift subsequent elements and insert
+    std::memmove(_data+index+1, _data+index, (_size-index)*sizeof(PointerType_));
+    _data[index] = element_;
+    ++_size;
+    return true;
+  }
+
+  //! @brief inserts a range of elements
+  template<typename IteratorType_>
+  void insert(IteratorType_ begin_, IteratorType_ end_) {
+    for (IteratorType_ iterator = begin_; iterator != end_; ++iterator) {
+      insert(*iterator);
+    }
+  }
+
+  //! @brief removes an element
+  //! @param[in] element_ the element to erase
+  //! @return number of erased elements (0 or 1)
+  Count erase(const PointerType_& element_) {
+    PointerType_* position = std::lower_bound(_data, _data+_size, element_, std::less<PointerType_>());
+    if (position == _data+_size || *position != element_) {
+      return 0;
+    }
+    std::memmove(position, position+1, (_data+_size-position-1)*sizeof(PointerType_));
+    --_size;
+    return 1;
+  }
+
+  inline Count count(const PointerType_& element_) const {return std::binary_search(_data, _data+_size, element_, std::less<PointerType_>());}
+  inline Count size() const {return _size;}
+  inline bool empty() const {return _size == 0;}
+
+  //! @brief removes all elements, releasing heap storage
+  void clear() {
+    if (_data != _inline) {
+      delete[] _data;
+      _data     = _inline;
+      _capacity = inline_capacity_;
+    }
+    _size = 0;
+  }
+
+  inline const_iterator begin() const {return _data;}
+  inline const_iterator end() const {return _data+_size;}
+
+//ds attributes
+protected:
+
+  //ds active storage (inline or heap)
+  PointerType_* _data;
+
+  //ds fill level and storage size
+  uint32_t _size     = 0;
+  uint32_t _capacity = inline_capacity_;
+
+  //ds inline storage
+  PointerType_ _inline[inline_capacity_];
+};
+
+//! @class map with sorted, contiguous storage (binary search lookup, cache friendly iteration)
+//! replaces std::map for per-object bookkeeping where lookups dominate over insertions
+//! iteration yields key-value pairs in increasing key order (as std::map)
+template<typename KeyType_, typename ValueType_, typename AllocatorType_ = std::allocator<std::pair<KeyType_, ValueType_>>>
+class FlatMap {
+
+//ds exported types
+public:
+
+  typedef std::pair<KeyType_, ValueType_> Element;
+  typedef std::vector<Element, AllocatorType_> ElementVector;
+  typedef typename ElementVector::iterator iterator;
+  typedef typename ElementVector::const_iterator const_iterator;
+
+//ds functionality
+public:
+
+  //! @brief element lookup
+  //! @param[in] key_ the key of the element
+  //! @return iterator to the element or end() if not present
+  iterator find(const KeyType_& key_) {
+    iterator position = _lowerBound(key_);
+    return (position != _elements.end() && position->first == key_)? position: _elements.end();
+  }
+  const_iterator find(const KeyType_& key_) const {
+    const_iterator position = std::lower_bound(_elements.begin(), _elements.end(), key_, _compare);
+    return (position != _elements.end() && position->first == key_)? position: _elements.end();
+  }
+
+  //! @brief inserts an element at its sorted position, existing elements are not overwritten (as std::map)
+  //! @param[in] element_ key-value pair
+  //! @return iterator to the element with the key and true if the element was inserted
+  std::pair<iterator, bool> insert(const Element& element_) {
+    iterator position = _lowerBound(element_.first);
+    if (position != _elements.end() && position->first == element_.first) {
+      return std::make_pair(position, false);
+    }
+    return std::make_pair(_elements.insert(position, element_), true);
+  }
+
+  //! @brief replaces the complete content with the provided elements (bulk insertion, sorted once)
+  //! @param[in,out] elements_ elements with unique keys, emptied after the call
+  void assign(ElementVector& elements_) {
+    _elements.swap(elements_);
+    elements_.clear();
+    std::sort(_elements.begin(), _elements.end(), [](const Element& a_, const Element& b_){return a_.first < b_.first;});
+  }
+
+  //! @brief removes an element
+  //! @param[in] key_ the key of the element
+  //! @return number of erased elements (0 or 1)
+  Count erase(const KeyType_& key_) {
+    iterator position = find(key_);
+    if (position == _elements.end()) {
+      return 0;
+    }
+    _elements.erase(position);
+    return 1;
+  }
+
+  ValueType_& at(const KeyType_& key_) {
+    iterator position = find(key_);
+    if (position == _elements.end()) {
+      throw std::out_of_range("FlatMap::at|key not present");
+    }
+    return position->second;
+  }
+
+  inline Count count(const KeyType_& key_) const {return find(key_) != _elements.end();}
+  inline Count size() const {return _elements.size();}
+  inline bool empty() const {return _elements.empty();}
+  inline void clear() {_elements.clear();}
+  inline void reserve(const Count& size_) {_elements.reserve(size_);}
+
+  inline iterator begin() {return _elements.begin();}
+  inline iterator end() {return _elements.end();}
+  inline const_iterator begin() const {return _elements.begin();}
+  inline const_iterator end() const {return _elements.end();}
+
+//ds helpers
+protected:
+
+  static bool _compare(const Element& element_, const KeyType_& key_) {return element_.first < key_;}
+  inline iterator _lowerBound(const KeyType_& key_) {return std::lower_bound(_elements.begin(), _elements.end(), key_, _compare);}
+
+//ds attributes
+protected:
+
+  //ds elements sorted by key
+  ElementVector _elements;
+};
+
+//! @class open addressing hash map with identifier keys (linear probing, power of two capacity)
+//! all elements are stored in a single contiguous table, lookups do not allocate nor throw
+template<typename ValueType_>
+class IdentifierHashMap {
+
+//ds exported types
+public:
+
+  //ds reserved key marking a free slot
+  static constexpr Identifier free_key = std::numeric_limits<Identifier>::max();
+
+  struct Slot {
+    Identifier key = free_key;
+    ValueType_ value;
+  };
+
+//ds object handling
+public:
+
+  IdentifierHashMap(const Count& expected_number_of_elements_ = 16) {reserve(expected_number_of_elements_);}
+
+//ds functionality
+public:
+
+  //! @brief prepares the table for the expected number of elements (keeps the load factor below 0.5)
+  //! @param[in] expected_number_of_elements_ number of elements to be inserted
+  void reserve(const Count& expected_number_of_elements_) {
+    Count capacity = 16;
+    while (capacity < 2*expected_number_of_elements_) {
+      capacity *= 2;
+    }
+    if (capacity > _slots.size()) {
+      _rehash(capacity);
+    }
+  }
+
+  //! @brief element lookup
+  //! @param[in] key_ the key of the element
+  //! @return pointer to the value or nullptr if not present
+  inline ValueType_* find(const Identifier& key_) {
+    for (Index index = _hash(key_);; index = (index+1)&_mask) {
+      if (_slots[index].key == key_) {
+        return &_slots[index].value;
+      }
+      if (_slots[index].key == free_key) {
+        return nullptr;
+      }
+    }
+  }
+  inline const ValueType_* find(const Identifier& key_) const {
+    return const_cast<IdentifierHashMap*>(this)->find(key_);
+  }
+
+  //! @brief inserts an element if the key is not present yet (as std::map)
+  //! @param[in] key_ the key of the element
+  //! @param[in] value_ the value of the element
+  //! @return pointer to the value stored for the key and true if the element was inserted
+  std::pair<ValueType_*, bool> insert(const Identifier& key_, const ValueType_& value_) {
+    assert(key_ != free_key);
+    if (2*(_number_of_elements+1) > _slots.size()) {
+      _rehash(2*_slots.size());
+    }
+    Index index = _hash(key_);
+    while (_slots[index].key != free_key) {
+      if (_slots[index].key == key_) {
+        return std::make_pair(&_slots[index].value, false);
+      }
+      index = (index+1)&_mask;
+    }
+    _slots[index].key   = key_;
+    _slots[index].value = value_;
+    ++_number_of_elements;
+    return std::make_pair(&_slots[index].value, true);
+  }
+
+  //! @brief removes an element (backward shift deletion, no tombstones)
+  //! @param[in] key_ the key of the element
+  //! @return number of erased elements (0 or 1)
+  Count erase(const Identifier& key_) {
+    Index index = _hash(key_);
+    while (_slots[index].key != key_) {
+      if (_slots[index].key == free_key) {
+        return 0;
+      }
+      index = (index+1)&_mask;
+    }
+
+    //ds close the gap by moving subsequent elements of the probe sequence
+    Index index_next = (index+1)&_mask;
+    while (_slots[index_next].key != free_key) {
+      const Index index_desired = _hash(_slots[index_next].key);
+
+      //ds move the element if its desired slot is not located in (index, index_next] (cyclic)
+      if (((index_next-index_desired)&_mask) >= ((index_next-index)&_mask)) {
+        _slots[index] = _slots[index_next];
+        index = index_next;
+      }
+      index_next = (index_next+1)&_mask;
+    }
+    _slots[index].key = free_key;
+    --_number_of_elements;
+    return 1;
+  }
+
+  //! @brief removes all elements (keeps the table size)
+  void clear() {
+    for (Slot& slot: _slots) {
+      slot.key = free_key;
+    }
+    _number_of_elements = 0;
+  }
+
+  inline Count size() const {return _number_of_elements;}
+  inline bool empty() const {return _number_of_elements == 0;}
+
+  //! @brief raw table access for iteration (free slots carry free_key)
+  inline const std::vector<Slot>& slots() const {return _slots;}
+
+//ds helpers
+protected:
+
+  //ds fibonacci hashing, sequential identifiers are spread over the complete table
+  inline Index _hash(const Identifier& key_) const {return (key_*11400714819323198485ull) >> _shift;}
+
+  void _rehash(const Count& capacity_) {
+    std::vector<Slot> slots(capacity_);
+    _slots.swap(slots);
+    _mask  = capacity_-1;
+    _shift = 64;
+    for (Count capacity = capacity_; capacity > 1; capacity >>= 1) {
+      --_shift;
+    }
+    _number_of_elements = 0;
+    for (const Slot& slot: slots) {
+      if (slot.key != free_key) {
+        insert(slot.key, slot.value);
+      }
+    }
+  }
+
+//ds attributes
+protected:
+
+  std::vector<Slot> _slots;
+  Index _mask    = 0;
+  uint32_t _shift = 64;
+  Count _number_of_elements = 0;
+};
+
+template<typename ValueType_>
+constexpr Identifier IdentifierHashMap<ValueType_>::free_key;
+}
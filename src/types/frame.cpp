@@ -129,7 +129,12 @@ FramePoint* Frame::createFramepoint(const IntensityFeature* feature_left_,
 }
 
 void Frame::clear() {
-  for (const FramePoint* frame_point: _created_points) {
+  for (FramePoint* frame_point: _created_points) {
+
+    //ds the landmark must not refer to freed framepoints
+    if (frame_point->landmark()) {
+      frame_point->landmark()->detach(frame_point);
+    }
     delete frame_point;
   }
   _created_points.clear();
@@ -2,6 +2,7 @@
 #include "parameters.h"
 #include "camera.h"
 #include "frame_point.h"
+#include "identifier_pointer_map.h"
 
 namespace proslam {
   
@@ -202,6 +203,6 @@ protected:
 };
 
 typedef std::vector<Frame*> FramePointerVector;
-typedef std::pair<const Identifier, Frame*> FramePointerMapElement;
-typedef std::map<const Identifier, Frame*> FramePointerMap;
+typedef IdentifierPointerMap<Frame> FramePointerMap;
+typedef FramePointerMap::Element FramePointerMapElement;
 }
@@ -33,6 +33,14 @@ FramePoint::FramePoint(const IntensityFeature* feature_left_,
 FramePoint::~FramePoint() {
   delete _feature_left;
   delete _feature_right;
+
+  //ds detach from the track (neighboring framepoints must not point to freed memory)
+  if (_previous && _previous->_next == this) {
+    _previous->_next = nullptr;
+  }
+  if (_next && _next->_previous == this) {
+    _next->_previous = nullptr;
+  }
 }
 
 void FramePoint::setPrevious(FramePoint* previous_) {
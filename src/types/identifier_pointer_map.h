@@ -0,0 +1,112 @@
+#pragma once
+#include <stdexcept>
+#include "definitions.h"
+
+namespace proslam {
+
+//! @class dense, identifier indexed pointer storage for objects with sequentially assigned identifiers (e.g. frames, landmarks)
+//! insertion and lookup are constant in time, erased entries leave a tombstone (nullptr) in their slot
+//! the interface mirrors the used subset of std::map<const Identifier, ObjectType*> (iteration yields identifier-pointer pairs in increasing order)
+template<typename ObjectType_>
+class IdentifierPointerMap {
+
+//ds exported types
+public:
+
+  typedef std::pair<const Identifier, ObjectType_*> Element;
+  typedef std::vector<ObjectType_*> SlotVector;
+
+  //! @class forward iterator skipping tombstones
+  class ConstIterator {
+  public:
+
+    ConstIterator(const SlotVector* slots_, const Index& index_): _slots(slots_), _index(index_) {_skipTombstones();}
+    inline Element operator*() const {return Element(_index, (*_slots)[_index]);}
+    inline ConstIterator& operator++() {++_index; _skipTombstones(); return *this;}
+    inline bool operator==(const ConstIterator& other_) const {return _index == other_._index;}
+    inline bool operator!=(const ConstIterator& other_) const {return _index != other_._index;}
+
+  protected:
+
+    inline void _skipTombstones() {while (_index < _slots->size() && (*_slots)[_index] == nullptr) {++_index;}}
+    const SlotVector* _slots;
+    Index _index;
+  };
+
+  typedef ConstIterator const_iterator;
+  typedef ConstIterator iterator;
+
+//ds functionality
+public:
+
+  //! @brief inserts an element at the slot of its identifier (the slot must be free)
+  //! @param[in] element_ identifier-pointer pair
+  //! @return true if the element was inserted
+  bool insert(const Element& element_) {
+    if (element_.first >= _slots.size()) {
+
+      //ds grow geometrically to keep insertion amortized constant
+      if (element_.first >= _slots.capacity()) {
+        _slots.reserve(std::max(2*_slots.capacity(), static_cast<size_t>(element_.first+1)));
+      }
+      _slots.resize(element_.first+1, nullptr);
+    }
+    if (_slots[element_.first]) {
+      return false;
+    }
+    _slots[element_.first] = element_.second;
+    ++_number_of_elements;
+    return true;
+  }
+
+  //! @brief replaces the slot content by a tombstone
+  //! @param[in] identifier_ identifier of the element to erase
+  //! @return number of erased elements (0 or 1)
+  Count erase(const Identifier& identifier_) {
+    if (identifier_ >= _slots.size() || _slots[identifier_] == nullptr) {
+      return 0;
+    }
+    _slots[identifier_] = nullptr;
+    --_number_of_elements;
+    return 1;
+  }
+
+  //! @brief element lookup without exceptions
+  //! @param[in] identifier_ identifier of the desired element
+  //! @return the element or nullptr if not present (never inserted or erased)
+  inline ObjectType_* get(const Identifier& identifier_) const {
+    return (identifier_ < _slots.size())? _slots[identifier_]: nullptr;
+  }
+
+  //! @brief element lookup (std::map semantics)
+  //! @param[in] identifier_ identifier of the desired element
+  //! @return the element, throws std::out_of_range if not present
+  inline ObjectType_* at(const Identifier& identifier_) const {
+    ObjectType_* object = get(identifier_);
+    if (!object) {
+      throw std::out_of_range("IdentifierPointerMap::at|no element with identifier: " + std::to_string(identifier_));
+    }
+    return object;
+  }
+
+  inline Count count(const Identifier& identifier_) const {return (get(identifier_) != nullptr);}
+  inline Count size() const {return _number_of_elements;}
+  inline bool empty() const {return _number_of_elements == 0;}
+  void clear() {_slots.clear(); _number_of_elements = 0;}
+
+  //! @brief the slot vector, including tombstones
+  inline const SlotVector& slots() const {return _slots;}
+
+  inline ConstIterator begin() const {return ConstIterator(&_slots, 0);}
+  inline ConstIterator end() const {return ConstIterator(&_slots, _slots.size());}
+
+//ds attributes
+protected:
+
+  //ds object pointers indexed by identifier, nullptr for free or erased slots
+  SlotVector _slots;
+
+  //ds number of valid (non tombstone) elements
+  Count _number_of_elements = 0;
+};
+}
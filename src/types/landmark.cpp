@@ -10,7 +10,7 @@ Landmark::Landmark(FramePoint* origin_, const LandmarkParameters* parameters_):
                                                                                 _parameters(parameters_) {
   ++_instances;
   _measurements.clear();
-  _appearance_map.clear();
+  _appearances.clear();
   _descriptors.clear();
   _local_maps.clear();
 
@@ -31,7 +31,7 @@ Landmark::Landmark(FramePoint* origin_, const LandmarkParameters* parameters_):
 }
 
 Landmark::~Landmark() {
-  _appearance_map.clear();
+  _appearances.clear();
   _measurements.clear();
   _descriptors.clear();
   _local_maps.clear();
@@ -39,19 +39,22 @@ Landmark::~Landmark() {
 
 void Landmark::replace(const HBSTMatchable* matchable_old_, HBSTMatchable* matchable_new_) {
 
-  //ds remove the old matchable and check for failure
-  if (_appearance_map.erase(matchable_old_) != 1) {
+  //ds remove the old matchable and check for failure (the pointer is only used as key, its memory might already be freed)
+  if (_appearances.erase(const_cast<HBSTMatchable*>(matchable_old_)) != 1) {
     LOG_WARNING(std::cerr << "Landmark::replace|" << _identifier << "|unable to erase old HBSTMatchable: " << matchable_old_ << std::endl)
   }
 
   //ds insert new matchable - not critical if already present (same landmark in subsequent local maps)
-  _appearance_map.insert(std::make_pair(matchable_new_, matchable_new_));
+  _appearances.insert(matchable_new_);
 }
 
 void Landmark::update(FramePoint* point_) {
   _last_update = point_;
 
-  //ds update appearance history (left descriptors only)
+  //ds update appearance history (left descriptors only) - bounded since landmarks pruned from local maps are never converted into appearances
+  if (_descriptors.size() >= _parameters->maximum_number_of_descriptors && !_descriptors.empty()) {
+    _descriptors.erase(_descriptors.begin());
+  }
   _descriptors.push_back(point_->descriptorLeft());
   _measurements.push_back(Measurement(point_));
 
@@ -151,11 +154,11 @@ void Landmark::merge(Landmark* landmark_) {
   }
 
   //ds merge landmark appearances
-  for (auto& appearance: landmark_->_appearance_map) {
-    appearance.second->setObjects(this);
+  for (HBSTMatchable* appearance: landmark_->_appearances) {
+    appearance->setObjects(this);
   }
-  _appearance_map.insert(landmark_->_appearance_map.begin(), landmark_->_appearance_map.end());
-  landmark_->_appearance_map.clear();
+  _appearances.insert(landmark_->_appearances.begin(), landmark_->_appearances.end());
+  landmark_->_appearances.clear();
 
   //ds merge landmark local maps
   for (LocalMap* local_map: landmark_->_local_maps) {
@@ -167,6 +170,9 @@ void Landmark::merge(Landmark* landmark_) {
   //ds merge descriptors
   _descriptors.insert(_descriptors.end(), landmark_->_descriptors.begin(), landmark_->_descriptors.end());
   landmark_->_descriptors.clear();
+  if (_descriptors.size() > _parameters->maximum_number_of_descriptors) {
+    _descriptors.erase(_descriptors.begin(), _descriptors.end()-_parameters->maximum_number_of_descriptors);
+  }
 
   //ds compute new merged world coordinates
   _world_coordinates = (_number_of_updates*_world_coordinates+
@@ -179,16 +185,108 @@ void Landmark::merge(Landmark* landmark_) {
   _measurements.insert(_measurements.end(), landmark_->_measurements.begin(), landmark_->_measurements.end());
   landmark_->_measurements.clear();
 
-  //ds connect framepoint history (last update of this with origin of absorbed landmark)
-  landmark_->_origin->setPrevious(_last_update);
+  //ds connect framepoint history (last update of this with origin of absorbed landmark) if both framepoints are still available
+  if (_last_update && landmark_->_origin) {
+    landmark_->_origin->setPrevious(_last_update);
+
+    //ds update track lengths and landmark references until we arrive in the last framepoint of the absorbed landmark
+    //ds which will replace the _last_update of this landmark
+    while (_last_update->next()) {
+      _last_update = _last_update->next();
+      _last_update->setLandmark(this);
+      _last_update->setTrackLength(_last_update->previous()->trackLength()+1);
+      _last_update->setOrigin(_origin);
+    }
+  } else {
+
+    //ds parts of the history have been freed - only relink the remaining framepoints of the absorbed landmark
+    for (FramePoint* framepoint = landmark_->_last_update; framepoint && framepoint->landmark() == landmark_; framepoint = framepoint->previous()) {
+      framepoint->setLandmark(this);
+    }
+    if (landmark_->_last_update) {
+      _last_update = landmark_->_last_update;
+    }
+    if (!_origin) {
+      _origin = landmark_->_origin;
+    }
+  }
+}
+
+const real Landmark::averageRelativeResidual() const {
+  if (_measurements.empty()) {
+    return 0;
+  }
+  real residual = 0;
+  for (const Measurement& measurement: _measurements) {
+    residual += (measurement.world_to_camera*_world_coordinates-measurement.camera_coordinates).norm()*measurement.inverse_depth_meters;
+  }
+  return residual/_measurements.size();
+}
 
-  //ds update track lengths and landmark references until we arrive in the last framepoint of the absorbed landmark
-  //ds which will replace the _last_update of this landmark
-  while (_last_update->next()) {
-    _last_update = _last_update->next();
-    _last_update->setLandmark(this);
-    _last_update->setTrackLength(_last_update->previous()->trackLength()+1);
-    _last_update->setOrigin(_origin);
+cv::Mat Landmark::majorityDescriptor(const std::vector<cv::Mat>& descriptors_) {
+  assert(!descriptors_.empty());
+  if (descriptors_.size() == 1) {
+    return descriptors_.front();
+  }
+
+  //ds count the set bits over all descriptors
+  std::vector<Count> bit_counts(SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS, 0);
+  for (const cv::Mat& descriptor: descriptors_) {
+    const uint8_t* bytes = descriptor.ptr<uint8_t>(0);
+    for (Index index_byte = 0; index_byte < DESCRIPTOR_SIZE_BYTES; ++index_byte) {
+      for (Index index_bit = 0; index_bit < 8; ++index_bit) {
+        bit_counts[8*index_byte+index_bit] += (bytes[index_byte] >> index_bit) & 1;
+      }
+    }
+  }
+
+  //ds set the bits that are set in the majority of descriptors
+  cv::Mat descriptor_majority(1, DESCRIPTOR_SIZE_BYTES, CV_8UC1, cv::Scalar(0));
+  uint8_t* bytes = descriptor_majority.ptr<uint8_t>(0);
+  for (Index index_byte = 0; index_byte < DESCRIPTOR_SIZE_BYTES; ++index_byte) {
+    for (Index index_bit = 0; index_bit < 8; ++index_bit) {
+      if (2*bit_counts[8*index_byte+index_bit] > descriptors_.size()) {
+        bytes[index_byte] |= (1 << index_bit);
+      }
+    }
+  }
+  return descriptor_majority;
+}
+
+const cv::Mat& Landmark::medoidDescriptor(const std::vector<cv::Mat>& descriptors_) {
+  assert(!descriptors_.empty());
+
+  //ds pairwise distances are symmetric, the number of descriptors per local map is small
+  std::vector<real> total_distances(descriptors_.size(), 0);
+  for (Index u = 0; u < descriptors_.size(); ++u) {
+    for (Index v = u+1; v < descriptors_.size(); ++v) {
+      const real distance = cv::norm(descriptors_[u], descriptors_[v], SRRG_PROSLAM_DESCRIPTOR_NORM);
+      total_distances[u] += distance;
+      total_distances[v] += distance;
+    }
+  }
+  return descriptors_[std::min_element(total_distances.begin(), total_distances.end())-total_distances.begin()];
+}
+
+void Landmark::transform(const TransformMatrix3D& transform_) {
+  _world_coordinates = transform_*_world_coordinates;
+
+  //ds the measurements keep their camera coordinates, their world references move along
+  const TransformMatrix3D inverse = transform_.inverse();
+  for (Measurement& measurement: _measurements) {
+    measurement.world_to_camera   = measurement.world_to_camera*inverse;
+    measurement.world_coordinates = transform_*measurement.world_coordinates;
+  }
+}
+
+void Landmark::detach(const FramePoint* framepoint_) {
+
+  //ds move the track ends to the neighboring framepoints (nullptr if not available)
+  if (_origin == framepoint_) {
+    _origin = framepoint_->next();
+  }
+  if (_last_update == framepoint_) {
+    _last_update = framepoint_->previous();
   }
 }
 }
@@ -1,5 +1,6 @@
 #pragma once
 #include "frame.h"
+#include "voxel_hash.h"
 
 namespace proslam {
 
@@ -14,7 +15,11 @@ public: EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 //ds exported types
 public:
 
-  typedef std::map<const HBSTMatchable*, HBSTMatchable*> HBSTMatchableMemoryMap;
+  //ds appearances of a landmark (usually only a few, stored inline)
+  typedef SmallPointerSet<HBSTMatchable*, 4> HBSTMatchablePointerSet;
+
+  //ds local maps containing a landmark (usually one or two, stored inline)
+  typedef SmallPointerSet<LocalMap*, 2> LocalMapPointerSet;
 
   //ds a landmark measurement (used for position optimization)
   struct Measurement {
@@ -58,17 +63,52 @@ public:
   //ds framepoint in an image at the time when the landmark was created
   inline FramePoint* origin() const {return _origin;}
 
+  //ds framepoint of the most recent landmark update
+  inline FramePoint* lastUpdate() const {return _last_update;}
+
   inline const PointCoordinates& coordinates() const {return _world_coordinates;}
   void setCoordinates(const PointCoordinates& coordinates_) {_world_coordinates = coordinates_;}
 
+  //! @brief moves the landmark and its measurements rigidly (e.g. when a lost track is relocalized)
+  //! @param[in] transform_ the correction applied in the world frame
+  void transform(const TransformMatrix3D& transform_);
+
   //! @brief replaces a matchable in the appearance map
   void replace(const HBSTMatchable* matchable_old_, HBSTMatchable* matchable_new_);
 
-  const HBSTMatchableMemoryMap& appearances() const {return _appearance_map;}
+  //! @brief removes a matchable from the appearance map (the place it belongs to was evicted from the place database)
+  void removeAppearance(const HBSTMatchable* matchable_) {_appearances.erase(const_cast<HBSTMatchable*>(matchable_));}
+
+  const HBSTMatchablePointerSet& appearances() const {return _appearances;}
 
   //ds position related
   const Count numberOfUpdates() const {return _number_of_updates;}
 
+  //! @brief average residual of the measurements with respect to the current landmark estimate, relative to the measurement depth
+  const real averageRelativeResidual() const;
+
+  //! @brief bitwise majority vote over the descriptors not yet converted to appearances (at least one required)
+  //! @return descriptor with each bit set if it is set in more than half of the descriptors
+  cv::Mat majorityDescriptor() const {return majorityDescriptor(_descriptors);}
+
+  //! @brief medoid of the descriptors not yet converted to appearances (at least one required)
+  //! @return the descriptor with the minimum total distance to all others
+  const cv::Mat& medoidDescriptor() const {return medoidDescriptor(_descriptors);}
+
+  //! @brief bitwise majority vote over a set of descriptors (at least one required)
+  //! @param[in] descriptors_ descriptors of a single landmark
+  //! @return descriptor with each bit set if it is set in more than half of the descriptors
+  static cv::Mat majorityDescriptor(const std::vector<cv::Mat>& descriptors_);
+
+  //! @brief medoid of a set of descriptors (at least one required)
+  //! @param[in] descriptors_ descriptors of a single landmark
+  //! @return the descriptor with the minimum total distance to all others
+  static const cv::Mat& medoidDescriptor(const std::vector<cv::Mat>& descriptors_);
+
+  //! @brief releases all references to a framepoint of this landmark (e.g. before the framepoint is freed)
+  //! @param[in] framepoint_ the framepoint to release
+  void detach(const FramePoint* framepoint_);
+
   //ds information about whether the landmark is visible in the current image
   inline const bool isCurrentlyTracked() const {return _is_currently_tracked;}
   inline void setIsCurrentlyTracked(const bool& is_currently_tracked_) {_is_currently_tracked = is_currently_tracked_;}
@@ -93,7 +133,7 @@ public:
   inline void setIsInLoopClosureQuery(const bool& is_in_loop_closure_query_) {_is_in_loop_closure_query = is_in_loop_closure_query_;}
   inline void setIsInLoopClosureReference(const bool& is_in_loop_closure_reference_) {_is_in_loop_closure_reference = is_in_loop_closure_reference_;}
 
-  const std::set<LocalMap*>& localMaps() const {return _local_maps;}
+  const LocalMapPointerSet& localMaps() const {return _local_maps;}
 
 //ds attributes
 protected:
@@ -112,14 +152,17 @@ protected:
   std::vector<cv::Mat> _descriptors;
 
   //ds appearances of this landmark that are captured in a local map (previously contained in _descriptors)
-  HBSTMatchableMemoryMap _appearance_map;
+  HBSTMatchablePointerSet _appearances;
 
   //ds connected local maps
-  std::set<LocalMap*> _local_maps;
+  LocalMapPointerSet _local_maps;
 
   //ds flags
   bool _is_currently_tracked = false; //ds set if the landmark is visible (=tracked) in the current image
 
+  //ds identifier of the frame in which the landmark was lost the last time (culling bookkeeping)
+  Identifier _identifier_frame_lost = 0;
+
   //ds landmark coordinates optimization
   MeasurementVector _measurements;
   Count _number_of_updates    = 0;
@@ -145,8 +188,9 @@ private:
 };
 
 typedef std::vector<Landmark*> LandmarkPointerVector;
-typedef std::pair<const Identifier, Landmark*> LandmarkPointerMapElement;
-typedef std::map<const Identifier, Landmark*> LandmarkPointerMap;
+typedef IdentifierPointerMap<Landmark> LandmarkPointerMap;
+typedef LandmarkPointerMap::Element LandmarkPointerMapElement;
 typedef std::set<const Landmark*> LandmarkPointerSet;
+typedef VoxelHash<Landmark> LandmarkVoxelHash;
 
 }
@@ -33,11 +33,13 @@ LocalMap::LocalMap(FramePointerVector& frames_,
   //ds define local map position relative in the world (currently using last frame's pose)
   setLocalMapToWorld(_keyframe->robotToWorld(), false);
 
-  //ds keep track of added landmarks in order to add them only once
-  std::set<Identifier> landmarks_added;
+  //ds landmark budget (0: all landmarks in the window are kept)
+  const Count maximum_number_of_landmarks = (_parameters->maximum_number_of_landmarks > 0? _parameters->maximum_number_of_landmarks:
+                                                                                           std::numeric_limits<Count>::max());
 
-  //ds preallocate bookkeeping with maximum allowed landmarks
-  const Count maximum_number_of_landmarks = _parameters->maximum_number_of_landmarks;
+  //ds collect landmark candidates once per landmark (keeping the latest measurement in the window)
+  std::vector<LandmarkCandidate> candidates;
+  IdentifierHashMap<Index> candidate_indices(std::min(maximum_number_of_landmarks, static_cast<Count>(1000)));
 
   //ds create item context for this local map: loop over all frames
   for (Frame* frame: frames_) {
@@ -50,44 +52,59 @@ LocalMap::LocalMap(FramePointerVector& frames_,
 
       //ds check for landmark
       Landmark* landmark = frame_point->landmark();
-
-      //ds if we have a landmark and it has not been added yet
-      if (landmark && landmarks_added.count(landmark->identifier()) == 0) {
-
-        //ds create HBST matchables based on available landmark descriptors TODO move this operation into a method of the landmark
-        HBSTTree::MatchableVector matchables(landmark->_descriptors.size());
-        for (Count u = 0; u < matchables.size(); ++u) {
-          HBSTMatchable* matchable = new HBSTMatchable(landmark, landmark->_descriptors[u], _identifier);
-          matchables[u]            = matchable;
-          landmark->_appearance_map.insert(std::make_pair(matchable, matchable));
+      if (landmark) {
+
+        //ds add the landmark only once, updating its latest measurement
+        const std::pair<Index*, bool> insertion = candidate_indices.insert(landmark->identifier(), candidates.size());
+        if (insertion.second) {
+          candidates.push_back(LandmarkCandidate(landmark, frame_point));
+        } else {
+          candidates[*insertion.first].framepoint = frame_point;
         }
-        landmark->_descriptors.clear();
-        landmark->_local_maps.insert(this);
-
-        //ds create a landmark snapshot and add it to the local map
-        const PointCoordinates coordinates_in_local_map = _world_to_local_map*landmark->coordinates();
-        _landmarks.insert(std::make_pair(landmark->identifier(), LandmarkState(landmark, coordinates_in_local_map)));
-
-        //ds we're only interested in the appearances generated in this local map
-        _appearances.insert(_appearances.end(), matchables.begin(), matchables.end());
-
-        //ds block further additions of this landmark
-        landmarks_added.insert(landmark->identifier());
       }
     }
   }
 
-  //ds check if we have to sparsify the landmarks TODO implement, check how to trim appearance vector as well
-  if (_landmarks.size() > maximum_number_of_landmarks) {
+  //ds check if we have to sparsify the landmarks
+  const Count number_of_candidates = candidates.size();
+  if (number_of_candidates > maximum_number_of_landmarks) {
+    _selectLandmarks(candidates);
     LOG_INFO(std::cerr << "LocalMap::LocalMap|" << _identifier
-                       << "|pruning landmarks from: " << landmarks_added.size() << " to: " << maximum_number_of_landmarks << std::endl)
+                       << "|pruned landmarks from: " << number_of_candidates << " to: " << candidates.size() << std::endl)
+  }
+
+  //ds landmark snapshots are collected first and sorted once into the flat landmark map
+  LandmarkStateMap::ElementVector landmark_states;
+  landmark_states.reserve(candidates.size());
 
-    //ds TODO free unused landmark states
+  //ds landmark appearances: all descriptors or a single representative descriptor per landmark
+  const bool use_representative = (_parameters->landmark_appearance_mode != LocalMapParameters::AppearanceMode::ALL);
+
+  //ds appearances are allocated in a single pass without intermediate buffers
+  Count number_of_appearances = 0;
+  for (const LandmarkCandidate& candidate: candidates) {
+    number_of_appearances += use_representative? std::min(candidate.landmark->_descriptors.size(), static_cast<size_t>(1)):
+                                                 candidate.landmark->_descriptors.size();
   }
+  _appearances.reserve(number_of_appearances);
+
+  //ds add the selected landmarks
+  for (const LandmarkCandidate& candidate: candidates) {
+    Landmark* landmark = candidate.landmark;
+
+    //ds create HBST matchables based on available landmark descriptors
+    _addAppearances(landmark);
+    _link(landmark);
+
+    //ds create a landmark snapshot and add it to the local map
+    const PointCoordinates coordinates_in_local_map = _world_to_local_map*landmark->coordinates();
+    landmark_states.push_back(std::make_pair(landmark->identifier(), LandmarkState(landmark, coordinates_in_local_map)));
+  }
+  _landmarks.assign(landmark_states);
 
   //ds check for low item counts
-  if (_parameters->minimum_number_of_landmarks > landmarks_added.size()) {
-    LOG_WARNING(std::cerr << "LocalMap::LocalMap|creating local map with low landmark number: " << landmarks_added.size() << std::endl)
+  if (_parameters->minimum_number_of_landmarks > _landmarks.size()) {
+    LOG_WARNING(std::cerr << "LocalMap::LocalMap|creating local map with low landmark number: " << _landmarks.size() << std::endl)
   }
 }
 
@@ -98,6 +115,7 @@ LocalMap::~LocalMap() {
 void LocalMap::clear() {
   _landmarks.clear();
   _closures.clear();
+  _covisible_local_maps.clear();
   _frames.clear();
   _appearances.clear();
 }
@@ -126,11 +144,120 @@ void LocalMap::replace(Landmark* landmark_old_, Landmark* landmark_new_) {
     iterator->second.coordinates_in_local_map = _world_to_local_map*landmark_new_->coordinates();
   } else {
 
+    //ds covisibility with the local maps of the new landmark (links already shared through the old landmark are kept)
+    for (LocalMap* local_map: landmark_new_->_local_maps) {
+      if (local_map != this && landmark_old_->_local_maps.count(local_map) == 0) {
+        _updateCovisibility(local_map, 1);
+        local_map->_updateCovisibility(this, 1);
+      }
+    }
+
     //ds create a new entry with updated landmark coordinates
     _landmarks.insert(std::make_pair(landmark_new_->identifier(), LandmarkState(landmark_new_, _world_to_local_map*landmark_new_->coordinates())));
   }
 }
 
+void LocalMap::absorb(const FramePointerVector& frames_) {
+  const Count maximum_number_of_landmarks = (_parameters->maximum_number_of_landmarks > 0? _parameters->maximum_number_of_landmarks:
+                                                                                           std::numeric_limits<Count>::max());
+
+  //ds the landmark map is rebuilt once with the added landmarks
+  LandmarkStateMap::ElementVector landmark_states(_landmarks.begin(), _landmarks.end());
+  for (Frame* frame: frames_) {
+    frame->setLocalMap(this);
+    frame->setFrameToLocalMap(_world_to_local_map*frame->robotToWorld());
+    _frames.push_back(frame);
+
+    //ds link landmarks within the budget - their pending descriptors describe the window (the other landmarks keep them)
+    for (FramePoint* frame_point: frame->points()) {
+      Landmark* landmark = frame_point->landmark();
+      if (landmark) {
+        if (landmark_states.size() < maximum_number_of_landmarks && landmark->_local_maps.count(this) == 0) {
+          _addAppearances(landmark);
+          _link(landmark);
+          landmark_states.push_back(std::make_pair(landmark->identifier(), LandmarkState(landmark, _world_to_local_map*landmark->coordinates())));
+        }
+      }
+    }
+  }
+  _landmarks.assign(landmark_states);
+}
+
+void LocalMap::getCovisibleLocalMaps(std::vector<LocalMap*>& local_maps_,
+                                     const Count& minimum_number_of_shared_landmarks_,
+                                     const Count& maximum_number_of_local_maps_) const {
+  std::vector<std::pair<Count, LocalMap*>> neighbors;
+  neighbors.reserve(_covisible_local_maps.size());
+  for (const std::pair<LocalMap*, Count>& edge: _covisible_local_maps) {
+    if (edge.second >= minimum_number_of_shared_landmarks_) {
+      neighbors.push_back(std::make_pair(edge.second, edge.first));
+    }
+  }
+
+  //ds strongest edges first, ties broken by local map identifier for determinism
+  std::sort(neighbors.begin(), neighbors.end(), [](const std::pair<Count, LocalMap*>& a_, const std::pair<Count, LocalMap*>& b_) {
+    return a_.first > b_.first || (a_.first == b_.first && a_.second->identifier() < b_.second->identifier());
+  });
+  local_maps_.clear();
+  for (Index index = 0; index < neighbors.size() && index < maximum_number_of_local_maps_; ++index) {
+    local_maps_.push_back(neighbors[index].second);
+  }
+}
+
+const Count LocalMap::numberOfSharedLandmarks(const LocalMap* local_map_) const {
+  CovisibilityMap::const_iterator iterator = _covisible_local_maps.find(const_cast<LocalMap*>(local_map_));
+  return (iterator != _covisible_local_maps.end())? iterator->second: 0;
+}
+
+void LocalMap::remove(const Landmark* landmark_) {
+  if (_landmarks.erase(landmark_->identifier()) != 1) {
+    LOG_WARNING(std::cerr << "LocalMap::remove|" << _identifier << "|unable to erase landmark with ID: " << landmark_->identifier() << std::endl)
+    return;
+  }
+
+  //ds update covisibility from this side (the other local maps of the landmark update their side upon their removal call)
+  for (LocalMap* local_map: landmark_->_local_maps) {
+    if (local_map != this) {
+      _updateCovisibility(local_map, -1);
+    }
+  }
+}
+
+void LocalMap::_addAppearances(Landmark* landmark_) {
+  const LocalMapParameters::AppearanceMode& appearance_mode = _parameters->landmark_appearance_mode;
+
+  //ds matchables are allocated individually: HBST frees them with plain delete (on merges and tree clears), possibly after this local map
+  if (!landmark_->_descriptors.empty() && appearance_mode != LocalMapParameters::AppearanceMode::ALL) {
+    _appearances.push_back(new HBSTMatchable(landmark_, appearance_mode == LocalMapParameters::AppearanceMode::MAJORITY? landmark_->majorityDescriptor():
+                                                                                                                       landmark_->medoidDescriptor(), _identifier));
+    landmark_->_appearances.insert(_appearances.back());
+  } else {
+    for (const cv::Mat& descriptor: landmark_->_descriptors) {
+      _appearances.push_back(new HBSTMatchable(landmark_, descriptor, _identifier));
+      landmark_->_appearances.insert(_appearances.back());
+    }
+  }
+  landmark_->_descriptors.clear();
+}
+
+void LocalMap::_link(Landmark* landmark_) {
+  for (LocalMap* local_map: landmark_->_local_maps) {
+    if (local_map != this) {
+      _updateCovisibility(local_map, 1);
+      local_map->_updateCovisibility(this, 1);
+    }
+  }
+  landmark_->_local_maps.insert(this);
+}
+
+void LocalMap::_updateCovisibility(LocalMap* local_map_, const int64_t& delta_) {
+  CovisibilityMap::iterator iterator = _covisible_local_maps.insert(std::make_pair(local_map_, 0)).first;
+  iterator->second += delta_;
+  if (iterator->second == 0) {
+    _covisible_local_maps.erase(local_map_);
+  }
+}
+
 void LocalMap::setLocalMapToWorld(const TransformMatrix3D& local_map_to_world_, const bool update_landmark_world_coordinates_) {
   _local_map_to_world = local_map_to_world_;
   _world_to_local_map = _local_map_to_world.inverse();
@@ -142,4 +269,56 @@ void LocalMap::setLocalMapToWorld(const TransformMatrix3D& local_map_to_world_,
     }
   }
 }
+
+void LocalMap::_selectLandmarks(std::vector<LandmarkCandidate>& candidates_) const {
+
+  //ds spatial spread: occupancy of a coarse image grid (landmarks in crowded regions are less valuable)
+  const Count number_of_cells_per_dimension = 16;
+  std::vector<Count> cell_occupancy(number_of_cells_per_dimension*number_of_cells_per_dimension, 0);
+  std::vector<Index> cell_indices(candidates_.size());
+  for (Index index = 0; index < candidates_.size(); ++index) {
+    const FramePoint* framepoint = candidates_[index].framepoint;
+    const Camera* camera         = framepoint->frame()->cameraLeft();
+    const Index row = std::min(static_cast<Index>(std::max(framepoint->imageCoordinatesLeft().y(), 0.0)*number_of_cells_per_dimension/camera->numberOfImageRows()),
+                               number_of_cells_per_dimension-1);
+    const Index col = std::min(static_cast<Index>(std::max(framepoint->imageCoordinatesLeft().x(), 0.0)*number_of_cells_per_dimension/camera->numberOfImageCols()),
+                               number_of_cells_per_dimension-1);
+    cell_indices[index] = row*number_of_cells_per_dimension+col;
+    ++cell_occupancy[cell_indices[index]];
+  }
+
+  //ds compute landmark quality
+  for (Index index = 0; index < candidates_.size(); ++index) {
+    LandmarkCandidate& candidate = candidates_[index];
+
+    //ds observation count: long tracks are more reliable, with diminishing returns
+    const real observation_score = 1+std::log(static_cast<real>(candidate.landmark->numberOfUpdates()));
+
+    //ds depth certainty: the triangulation error grows with the depth
+    const real depth_score = 1/(1+std::max(candidate.framepoint->cameraCoordinatesLeft().z(), 0.0));
+
+    //ds descriptor distinctiveness: balanced bit patterns discriminate better than uniform ones (low texture)
+    const cv::Mat& descriptor = candidate.framepoint->descriptorLeft();
+    Count number_of_set_bits  = 0;
+    for (int32_t u = 0; u < descriptor.cols; ++u) {
+      number_of_set_bits += __builtin_popcount(descriptor.at<uint8_t>(0, u));
+    }
+    const real bit_ratio             = static_cast<real>(number_of_set_bits)/(8*std::max(descriptor.cols, 1));
+    const real distinctiveness_score = 1-std::fabs(2*bit_ratio-1);
+
+    //ds spatial spread
+    const real spread_score = 1/std::sqrt(static_cast<real>(cell_occupancy[cell_indices[index]]));
+    candidate.quality       = observation_score*depth_score*(0.1+distinctiveness_score)*spread_score;
+  }
+
+  //ds keep the best candidates (restoring the insertion order afterwards)
+  for (Index index = 0; index < candidates_.size(); ++index) {
+    candidates_[index].index = index;
+  }
+  std::nth_element(candidates_.begin(), candidates_.begin()+_parameters->maximum_number_of_landmarks, candidates_.end(),
+                   [](const LandmarkCandidate& a_, const LandmarkCandidate& b_){return a_.quality > b_.quality;});
+  candidates_.resize(_parameters->maximum_number_of_landmarks, LandmarkCandidate(nullptr, nullptr));
+  std::sort(candidates_.begin(), candidates_.end(),
+            [](const LandmarkCandidate& a_, const LandmarkCandidate& b_){return a_.index < b_.index;});
+}
 }
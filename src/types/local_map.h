@@ -44,8 +44,11 @@ public: EIGEN_MAKE_ALIGNED_OPERATOR_NEW
     PointCoordinates coordinates_in_local_map;
   };
 
-  typedef std::pair<const Identifier, LandmarkState> LandmarkStateMapElement;
-  typedef std::map<const Identifier, LandmarkState, std::less<Identifier>, Eigen::aligned_allocator<LandmarkStateMapElement> > LandmarkStateMap;
+  typedef std::pair<Identifier, LandmarkState> LandmarkStateMapElement;
+  typedef FlatMap<Identifier, LandmarkState, Eigen::aligned_allocator<LandmarkStateMapElement> > LandmarkStateMap;
+
+  //ds covisibility graph edges: neighboring local map and number of shared landmarks
+  typedef FlatMap<LocalMap*, Count> CovisibilityMap;
 
 //ds object handling
 protected:
@@ -91,6 +94,26 @@ public:
   //! @param[in] landmark_new_ landmark to replace the currently present landmark_old_ in this local map
   void replace(Landmark* landmark_old_, Landmark* landmark_new_);
 
+  //! @brief absorbs frames into this local map instead of creating a new, redundant local map
+  //! landmarks of the frames that are linked to this local map get appearances from their pending descriptors (to be queried as part of this local map)
+  //! @param[in] frames_ the frames to absorb, expressed relative to this local map
+  void absorb(const FramePointerVector& frames_);
+
+  //! @brief retrieves the covisible local maps (covisibility graph neighbors), sorted by decreasing number of shared landmarks
+  //! @param[out] local_maps_ the covisible local maps
+  //! @param[in] minimum_number_of_shared_landmarks_ minimum edge weight
+  //! @param[in] maximum_number_of_local_maps_ maximum number of returned neighbors
+  void getCovisibleLocalMaps(std::vector<LocalMap*>& local_maps_,
+                             const Count& minimum_number_of_shared_landmarks_ = 1,
+                             const Count& maximum_number_of_local_maps_ = std::numeric_limits<Count>::max()) const;
+
+  //! @brief number of landmarks shared with another local map (covisibility graph edge weight)
+  const Count numberOfSharedLandmarks(const LocalMap* local_map_) const;
+
+  //! @brief removes a landmark from this local map (e.g. culled)
+  //! @param[in] landmark_ landmark currently in this local map
+  void remove(const Landmark* landmark_);
+
 //ds getters/setters
 public:
 
@@ -109,6 +132,8 @@ public:
   inline Frame* keyframe() const {return _keyframe;}
   inline const FramePointerVector& frames() const {return _frames;}
   inline LandmarkStateMap& landmarks() {return _landmarks;}
+  inline const LandmarkStateMap& landmarks() const {return _landmarks;}
+  inline const CovisibilityMap& covisibleLocalMaps() const {return _covisible_local_maps;}
   inline AppearanceVector& appearances() {return _appearances;}
   inline const AppearanceVector& appearances() const {return _appearances;}
 
@@ -118,6 +143,34 @@ public:
   //ds reset allocated object counter
   static void reset() {_instances = 0;}
 
+//ds helpers
+protected:
+
+  //! @brief landmark selection candidate with its latest measurement in the local map window
+  struct LandmarkCandidate {
+    LandmarkCandidate(Landmark* landmark_, const FramePoint* framepoint_): landmark(landmark_), framepoint(framepoint_) {}
+    Landmark* landmark;
+    const FramePoint* framepoint;
+    real quality = 0;
+    Index index  = 0;
+  };
+
+  //! @brief ranks the candidates by observation count, depth certainty, spatial spread and descriptor distinctiveness
+  //! and keeps the best maximum_number_of_landmarks of them
+  //! @param[in,out] candidates_ landmark candidates, reduced to the selected ones
+  void _selectLandmarks(std::vector<LandmarkCandidate>& candidates_) const;
+
+  //! @brief converts the pending descriptors of a landmark into appearances of this local map (LocalMapParameters::landmark_appearance_mode)
+  //! @param[in] landmark_ landmark to describe
+  void _addAppearances(Landmark* landmark_);
+
+  //! @brief links a landmark to this local map, updating the covisibility graph with all local maps already containing the landmark
+  //! @param[in] landmark_ landmark to link, not yet contained in this local map
+  void _link(Landmark* landmark_);
+
+  //! @brief adjusts the covisibility edge weight towards another local map (the edge is removed if no landmarks are shared anymore)
+  void _updateCovisibility(LocalMap* local_map_, const int64_t& delta_);
+
 //ds attributes
 protected:
 
@@ -152,6 +205,9 @@ protected:
   //ds loop closures for the local map
   ClosureConstraintVector _closures;
 
+  //ds covisibility graph: local maps sharing landmarks with this local map (updated incrementally)
+  CovisibilityMap _covisible_local_maps;
+
   //ds grant access to local map producer
   friend WorldMap;
 
@@ -80,16 +80,30 @@ void AlignerParameters::print() const {
 
 void LandmarkParameters::print() const {
   std::cerr << "LandmarkParameters::print|minimum_number_of_forced_updates: " << minimum_number_of_forced_updates << std::endl;
+  std::cerr << "LandmarkParameters::print|enable_culling: " << enable_culling << std::endl;
+  std::cerr << "LandmarkParameters::print|minimum_number_of_frames_invisible_for_culling: " << minimum_number_of_frames_invisible_for_culling << std::endl;
+  std::cerr << "LandmarkParameters::print|minimum_number_of_updates_for_survival: " << minimum_number_of_updates_for_survival << std::endl;
+  std::cerr << "LandmarkParameters::print|maximum_relative_residual_for_survival: " << maximum_relative_residual_for_survival << std::endl;
+  std::cerr << "LandmarkParameters::print|maximum_number_of_frames_invisible: " << maximum_number_of_frames_invisible << std::endl;
+  std::cerr << "LandmarkParameters::print|maximum_number_of_descriptors: " << maximum_number_of_descriptors << std::endl;
 }
 
 void LocalMapParameters::print() const {
   std::cerr << "LocalMapParameters::print|minimum_number_of_landmarks: " << minimum_number_of_landmarks << std::endl;
+  std::cerr << "LocalMapParameters::print|maximum_number_of_landmarks: " << maximum_number_of_landmarks << std::endl;
+  std::cerr << "LocalMapParameters::print|landmark_appearance_mode: "
+            << (landmark_appearance_mode == ALL? "ALL": (landmark_appearance_mode == MAJORITY? "MAJORITY": "MEDOID")) << std::endl;
 }
 
 void WorldMapParameters::print() const {
   std::cerr << "WorldMapParameters::print|minimum_distance_traveled_for_local_map: " << minimum_distance_traveled_for_local_map << std::endl;
   std::cerr << "WorldMapParameters::print|minimum_degrees_rotated_for_local_map: " << minimum_degrees_rotated_for_local_map << std::endl;
   std::cerr << "WorldMapParameters::print|minimum_number_of_frames_for_local_map: " << minimum_number_of_frames_for_local_map << std::endl;
+  std::cerr << "WorldMapParameters::print|enable_local_map_folding: " << enable_local_map_folding << std::endl;
+  std::cerr << "WorldMapParameters::print|minimum_landmark_coverage_for_folding: " << minimum_landmark_coverage_for_folding << std::endl;
+  std::cerr << "WorldMapParameters::print|maximum_distance_for_folding_meters: " << maximum_distance_for_folding_meters << std::endl;
+  std::cerr << "WorldMapParameters::print|maximum_degrees_rotated_for_folding: " << maximum_degrees_rotated_for_folding << std::endl;
+  std::cerr << "WorldMapParameters::print|landmark_voxel_size_meters: " << landmark_voxel_size_meters << std::endl;
   landmark->print();
   local_map->print();
 }
@@ -110,6 +124,10 @@ void StereoFramePointGeneratorParameters::print() const {
 }
 
 void DepthFramePointGeneratorParameters::print() const {
+  std::cerr << "DepthFramePointGeneratorParameters::print|depth_registration_mode: " << depth_registration_mode << std::endl;
+  std::cerr << "DepthFramePointGeneratorParameters::print|sparse_registration_radius_pixels: " << sparse_registration_radius_pixels << std::endl;
+  std::cerr << "DepthFramePointGeneratorParameters::print|sparse_registration_minimum_depth_meters: " << sparse_registration_minimum_depth_meters << std::endl;
+  std::cerr << "DepthFramePointGeneratorParameters::print|number_of_registration_threads: " << number_of_registration_threads << std::endl;
   BaseFramePointGeneratorParameters::print();
 }
 
@@ -130,6 +148,9 @@ void BaseTrackerParameters::print() const {
 
 void StereoTrackerParameters::print() const {
   BaseTrackerParameters::print();
+  std::cerr << "StereoTrackerParameters::print|enable_map_point_recovery: " << enable_map_point_recovery << std::endl;
+  std::cerr << "StereoTrackerParameters::print|map_point_recovery_search_distance_pixels: " << map_point_recovery_search_distance_pixels << std::endl;
+  std::cerr << "StereoTrackerParameters::print|maximum_depth_for_map_point_recovery_meters: " << maximum_depth_for_map_point_recovery_meters << std::endl;
 }
 
 void DepthTrackerParameters::print() const {
@@ -141,6 +162,26 @@ void RelocalizerParameters::print() const {
   std::cerr << "RelocalizerParameters::print|preliminary_minimum_matching_ratio: " << preliminary_minimum_matching_ratio << std::endl;
   std::cerr << "RelocalizerParameters::print|minimum_number_of_matches_per_landmark: " << minimum_number_of_matched_landmarks << std::endl;
   std::cerr << "RelocalizerParameters::print|minimum_matches_per_correspondence: " << minimum_matches_per_correspondence << std::endl;
+  std::cerr << "RelocalizerParameters::print|enable_covisibility_candidate_selection: " << enable_covisibility_candidate_selection << std::endl;
+  std::cerr << "RelocalizerParameters::print|enable_asynchronous_processing: " << enable_asynchronous_processing << std::endl;
+  std::cerr << "RelocalizerParameters::print|enable_deterministic_processing: " << enable_deterministic_processing << std::endl;
+  std::cerr << "RelocalizerParameters::print|maximum_number_of_postponed_cullings: " << maximum_number_of_postponed_cullings << std::endl;
+  std::cerr << "RelocalizerParameters::print|number_of_registration_threads: " << number_of_registration_threads << std::endl;
+  std::cerr << "RelocalizerParameters::print|minimum_inlier_ratio_for_early_exit: " << minimum_inlier_ratio_for_early_exit << std::endl;
+  std::cerr << "RelocalizerParameters::print|place_database_type: " << place_database_type << std::endl;
+  std::cerr << "RelocalizerParameters::print|bag_of_words_maximum_number_of_words: " << bag_of_words_maximum_number_of_words << std::endl;
+  std::cerr << "RelocalizerParameters::print|bag_of_words_word_radius: " << bag_of_words_word_radius << std::endl;
+  std::cerr << "RelocalizerParameters::print|bag_of_words_branching_factor: " << bag_of_words_branching_factor << std::endl;
+  std::cerr << "RelocalizerParameters::print|bag_of_words_depth: " << bag_of_words_depth << std::endl;
+  std::cerr << "RelocalizerParameters::print|bag_of_words_maximum_number_of_candidates: " << bag_of_words_maximum_number_of_candidates << std::endl;
+  std::cerr << "RelocalizerParameters::print|maximum_number_of_places: " << maximum_number_of_places << std::endl;
+  std::cerr << "RelocalizerParameters::print|place_eviction_policy: " << place_eviction_policy << std::endl;
+  std::cerr << "RelocalizerParameters::print|number_of_places_per_rebuild: " << number_of_places_per_rebuild << std::endl;
+  std::cerr << "RelocalizerParameters::print|closure_query_gating: " << closure_query_gating << std::endl;
+  std::cerr << "RelocalizerParameters::print|gating_minimum_radius_meters: " << gating_minimum_radius_meters << std::endl;
+  std::cerr << "RelocalizerParameters::print|gating_drift_ratio: " << gating_drift_ratio << std::endl;
+  std::cerr << "RelocalizerParameters::print|enable_frame_relocalization: " << enable_frame_relocalization << std::endl;
+  std::cerr << "RelocalizerParameters::print|maximum_number_of_frame_relocalization_candidates: " << maximum_number_of_frame_relocalization_candidates << std::endl;
   aligner->print();
 }
 
@@ -149,6 +190,17 @@ void GraphOptimizerParameters::print() const {
   std::cerr << "GraphOptimizerParameters::print|number_of_frames_per_bundle_adjustment: " << number_of_frames_per_bundle_adjustment << std::endl;
   std::cerr << "GraphOptimizerParameters::print|base_information_frame: " << base_information_frame << std::endl;
   std::cerr << "GraphOptimizerParameters::print|enable_robust_kernel_for_landmark_measurements: " << enable_robust_kernel_for_landmarks << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|enable_incremental_optimization: " << enable_incremental_optimization << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|minimum_relative_gain_for_termination: " << minimum_relative_gain_for_termination << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|enable_asynchronous_optimization: " << enable_asynchronous_optimization << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|enable_local_bundle_adjustment: " << enable_local_bundle_adjustment << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|number_of_local_maps_for_local_bundle_adjustment: " << number_of_local_maps_for_local_bundle_adjustment << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|number_of_iterations_for_local_bundle_adjustment: " << number_of_iterations_for_local_bundle_adjustment << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|maximum_number_of_fixed_local_maps_for_local_bundle_adjustment: " << maximum_number_of_fixed_local_maps_for_local_bundle_adjustment << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|pose_graph_solver: " << pose_graph_solver << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|enable_keyframe_pose_graph: " << enable_keyframe_pose_graph << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|minimum_keyframe_translation_correction_for_update: " << minimum_keyframe_translation_correction_for_update << std::endl;
+  std::cerr << "GraphOptimizerParameters::print|minimum_keyframe_rotation_correction_for_update: " << minimum_keyframe_rotation_correction_for_update << std::endl;
 }
 
 void ImageViewerParameters::print() const {
@@ -329,8 +381,35 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, world_map, world_map_parameters, minimum_distance_traveled_for_local_map, real)
     PARSE_PARAMETER(configuration, world_map, world_map_parameters, minimum_degrees_rotated_for_local_map, real)
     PARSE_PARAMETER(configuration, world_map, world_map_parameters, minimum_number_of_frames_for_local_map, Count)
+    PARSE_PARAMETER(configuration, world_map, world_map_parameters, enable_local_map_folding, bool)
+    PARSE_PARAMETER(configuration, world_map, world_map_parameters, minimum_landmark_coverage_for_folding, real)
+    PARSE_PARAMETER(configuration, world_map, world_map_parameters, maximum_distance_for_folding_meters, real)
+    PARSE_PARAMETER(configuration, world_map, world_map_parameters, maximum_degrees_rotated_for_folding, real)
+    PARSE_PARAMETER(configuration, world_map, world_map_parameters, landmark_voxel_size_meters, real)
     PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, minimum_number_of_forced_updates, Count)
+    PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, enable_culling, bool)
+    PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, minimum_number_of_frames_invisible_for_culling, Count)
+    PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, minimum_number_of_updates_for_survival, Count)
+    PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, maximum_relative_residual_for_survival, real)
+    PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, maximum_number_of_frames_invisible, Count)
+    PARSE_PARAMETER(configuration, landmark, world_map_parameters->landmark, maximum_number_of_descriptors, Count)
     PARSE_PARAMETER(configuration, local_map, world_map_parameters->local_map, minimum_number_of_landmarks, Count)
+    PARSE_PARAMETER(configuration, local_map, world_map_parameters->local_map, maximum_number_of_landmarks, Count)
+
+    //ds parse the landmark appearance mode as string (once for all local maps)
+    const std::string& landmark_appearance_mode = configuration["local_map"]["landmark_appearance_mode"].as<std::string>();
+    ++number_of_parameters_detected;
+    if (landmark_appearance_mode == "ALL") {
+      world_map_parameters->local_map->landmark_appearance_mode = LocalMapParameters::AppearanceMode::ALL;
+    } else if (landmark_appearance_mode == "MAJORITY") {
+      world_map_parameters->local_map->landmark_appearance_mode = LocalMapParameters::AppearanceMode::MAJORITY;
+    } else if (landmark_appearance_mode == "MEDOID") {
+      world_map_parameters->local_map->landmark_appearance_mode = LocalMapParameters::AppearanceMode::MEDOID;
+    } else {
+      LOG_ERROR(std::cerr << "ParameterCollection::parseFromFile|invalid landmark appearance mode: " << landmark_appearance_mode << std::endl)
+      throw std::runtime_error("invalid landmark appearance mode");
+    }
+    ++number_of_parameters_parsed;
 
     //ds mode specific parameters
     BaseFramePointGeneratorParameters* framepoint_generation_parameters = 0;
@@ -344,6 +423,11 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
         PARSE_PARAMETER(configuration, stereo_framepoint_generation, stereo_framepoint_generator_parameters, maximum_matching_distance_triangulation, int32_t)
         PARSE_PARAMETER(configuration, stereo_framepoint_generation, stereo_framepoint_generator_parameters, minimum_disparity_pixels, real)
         PARSE_PARAMETER(configuration, stereo_framepoint_generation, stereo_framepoint_generator_parameters, maximum_epipolar_search_offset_pixels, int32_t)
+
+        //MotionEstimation (SPECIFIC)
+        PARSE_PARAMETER(configuration, base_tracking, stereo_tracker_parameters, enable_map_point_recovery, bool)
+        PARSE_PARAMETER(configuration, base_tracking, stereo_tracker_parameters, map_point_recovery_search_distance_pixels, int32_t)
+        PARSE_PARAMETER(configuration, base_tracking, stereo_tracker_parameters, maximum_depth_for_map_point_recovery_meters, real)
         break;
       }
       case CommandLineParameters::TrackerMode::RGB_DEPTH: {
@@ -353,6 +437,10 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
         //FramepointGeneration (SPECIFIC)
         PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, maximum_depth_near_meters, real)
         PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, maximum_depth_far_meters, real)
+        PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, depth_registration_mode, std::string)
+        PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, sparse_registration_radius_pixels, int32_t)
+        PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, sparse_registration_minimum_depth_meters, real)
+        PARSE_PARAMETER(configuration, depth_framepoint_generation, depth_framepoint_generator_parameters, number_of_registration_threads, Count)
         break;
       }
       default: {
@@ -409,6 +497,26 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, preliminary_minimum_matching_ratio, real)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, minimum_number_of_matched_landmarks, Count)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, minimum_matches_per_correspondence, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, enable_covisibility_candidate_selection, bool)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, enable_asynchronous_processing, bool)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, enable_deterministic_processing, bool)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, maximum_number_of_postponed_cullings, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, number_of_registration_threads, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, minimum_inlier_ratio_for_early_exit, real)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, place_database_type, std::string)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, bag_of_words_maximum_number_of_words, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, bag_of_words_word_radius, real)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, bag_of_words_branching_factor, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, bag_of_words_depth, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, bag_of_words_maximum_number_of_candidates, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, maximum_number_of_places, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, place_eviction_policy, std::string)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, number_of_places_per_rebuild, Count)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, closure_query_gating, std::string)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, gating_minimum_radius_meters, real)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, gating_drift_ratio, real)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, enable_frame_relocalization, bool)
+    PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, maximum_number_of_frame_relocalization_candidates, Count)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, aligner->error_delta_for_convergence, real)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, aligner->maximum_error_kernel, real)
     PARSE_PARAMETER(configuration, relocalization, relocalizer_parameters, aligner->damping, real)
@@ -428,6 +536,17 @@ void ParameterCollection::parseFromFile(const std::string& filename_) {
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, base_information_frame_factor_for_translation, real)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_robust_kernel_for_poses, bool)
     PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_robust_kernel_for_landmarks, bool)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_incremental_optimization, bool)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, minimum_relative_gain_for_termination, real)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_asynchronous_optimization, bool)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_local_bundle_adjustment, bool)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, number_of_local_maps_for_local_bundle_adjustment, Count)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, number_of_iterations_for_local_bundle_adjustment, Count)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, maximum_number_of_fixed_local_maps_for_local_bundle_adjustment, Count)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, pose_graph_solver, std::string)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, enable_keyframe_pose_graph, bool)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, minimum_keyframe_translation_correction_for_update, real)
+    PARSE_PARAMETER(configuration, graph_optimization, graph_optimizer_parameters, minimum_keyframe_rotation_correction_for_update, real)
 
     //ds done
     LOG_INFO(std::cerr << "ParameterCollection::parseFromFile|successfully loaded configuration from file: " << filename_ << std::endl)
@@ -110,10 +110,37 @@ public:
 
   //! @brief minimum number of measurements before optimization is filtering
   Count minimum_number_of_forced_updates = 2;
+
+  //! @brief enables removal of unreliable landmarks once they are not tracked anymore
+  bool enable_culling = false;
+
+  //! @brief number of frames a landmark has to be invisible before it is evaluated for culling
+  Count minimum_number_of_frames_invisible_for_culling = 10;
+
+  //! @brief landmarks with fewer updates are culled
+  Count minimum_number_of_updates_for_survival = 3;
+
+  //! @brief landmarks with a higher average measurement residual (relative to the measurement depth) are culled
+  real maximum_relative_residual_for_survival = 0.1;
+
+  //! @brief landmarks invisible for more frames are culled regardless of their quality (0: disabled)
+  Count maximum_number_of_frames_invisible = 0;
+
+  //! @brief maximum number of descriptors buffered per landmark until they are converted into appearances (oldest are dropped)
+  Count maximum_number_of_descriptors = 100;
 };
 
 //! @class local map parameters
 class LocalMapParameters: public Parameters {
+
+//ds exported types
+public:
+
+  //! @brief descriptors added to the place database per landmark
+  enum AppearanceMode {ALL,      //ds every appearance in the local map
+                       MAJORITY, //ds a single representative: bitwise majority vote
+                       MEDOID};  //ds a single representative: appearance closest to all others
+
 public:
 
   //! @brief constructor
@@ -125,8 +152,12 @@ public:
   //! @brief target minimum number of landmarks for local map creation
   Count minimum_number_of_landmarks = 50;
 
-  //! @brief target maximum number of landmarks for local map creation
-  Count maximum_number_of_landmarks = 1000;
+  //! @brief maximum number of landmarks for local map creation, the best ranked landmarks are kept (0: no limit)
+  Count maximum_number_of_landmarks = 0;
+
+  //! @brief descriptors added to the place database per landmark: ALL (every appearance in the local map) or
+  //! a single representative: MAJORITY (bitwise majority vote) or MEDOID (appearance closest to all others)
+  AppearanceMode landmark_appearance_mode = AppearanceMode::ALL;
 };
 
 //! @class world map parameters
@@ -149,6 +180,15 @@ public:
   real minimum_degrees_rotated_for_local_map   = 0.5;
   Count minimum_number_of_frames_for_local_map = 4;
 
+  //! @brief local map folding: windows covered by an existing local map are absorbed by it instead of creating a new local map
+  bool enable_local_map_folding                  = false;
+  real minimum_landmark_coverage_for_folding     = 0.7;
+  real maximum_distance_for_folding_meters       = 2.0;
+  real maximum_degrees_rotated_for_folding       = 0.5;
+
+  //! @brief edge length of the voxels of the spatial landmark index
+  real landmark_voxel_size_meters = 4.0;
+
   //! @brief landmark generation parameters
   LandmarkParameters* landmark;
 
@@ -230,6 +270,18 @@ public:
   //! @brief depth sensor configuration
   real maximum_depth_near_meters = 5;
   real maximum_depth_far_meters  = 20;
+
+  //! @brief depth registration mode: FULL (complete depth image), SPARSE (keypoint neighborhoods only)
+  std::string depth_registration_mode = "FULL";
+
+  //! @brief registered neighborhood radius around each keypoint in SPARSE mode
+  int32_t sparse_registration_radius_pixels = 2;
+
+  //! @brief closest expected depth measurement in SPARSE mode (bounds the parallax between the depth and the intensity image)
+  real sparse_registration_minimum_depth_meters = 0.5;
+
+  //! @brief number of threads registering the depth image in FULL mode (row bands, including the calling thread)
+  Count number_of_registration_threads = 2;
 };
 
 //! @class base tracker parameters
@@ -280,6 +332,11 @@ public:
 
   //! @brief parameter printing function
   virtual void print() const;
+
+  //! @brief map point recovery: landmarks in the camera frustum without track in the current frame are matched against unassigned keypoints around their projection
+  bool enable_map_point_recovery                    = false;
+  int32_t map_point_recovery_search_distance_pixels = 5;
+  real maximum_depth_for_map_point_recovery_meters  = 30;
 };
 
 //! @class depth tracker parameters
@@ -322,6 +379,66 @@ public:
   //! @brief correspondence retrieval
   Count minimum_matches_per_correspondence = 0;
 
+  //! @brief skip candidate references that share at least minimum_number_of_matched_landmarks with a better candidate (covisibility graph)
+  bool enable_covisibility_candidate_selection = false;
+
+  //! @brief detect and register closures in a worker thread, accepted closures are integrated by the tracking thread at the next safe point
+  bool enable_asynchronous_processing = false;
+
+  //! @brief asynchronous processing only: integrate the closures of a local map always at the subsequent frame (reproducible results)
+  bool enable_deterministic_processing = false;
+
+  //! @brief asynchronous processing only: landmark culling waits for the busy worker after this many consecutively postponed cullings
+  Count maximum_number_of_postponed_cullings = 10;
+
+  //! @brief number of threads registering closure candidates in parallel (each with its own aligner)
+  Count number_of_registration_threads = 4;
+
+  //! @brief candidates ranked behind a closure registered with at least this inlier ratio are skipped (early exit)
+  real minimum_inlier_ratio_for_early_exit = 0.9;
+
+  //! @brief place database backend: HBST (binary search tree), BRUTE_FORCE (exact) or BAG_OF_WORDS (inverted index)
+  std::string place_database_type = "HBST";
+
+  //! @brief bag of words backend: maximum vocabulary size (the vocabulary is learned online)
+  Count bag_of_words_maximum_number_of_words = 4096;
+
+  //! @brief bag of words backend: descriptors farther than this distance from all words (leaves) found a new word
+  real bag_of_words_word_radius = 0.2*SRRG_PROSLAM_DESCRIPTOR_SIZE_BITS;
+
+  //! @brief bag of words backend: maximum number of children per vocabulary tree node
+  Count bag_of_words_branching_factor = 8;
+
+  //! @brief bag of words backend: number of vocabulary tree levels (the leaves are the words)
+  Count bag_of_words_depth = 4;
+
+  //! @brief bag of words backend: number of best scoring places (tf-idf) for which descriptor matches are retrieved
+  Count bag_of_words_maximum_number_of_candidates = 10;
+
+  //! @brief maximum number of places (local maps) kept in the place database, exceeding places are evicted (0: unbounded)
+  Count maximum_number_of_places = 0;
+
+  //! @brief place eviction policy: OLDEST, LEAST_MATCHED (fewest closure candidacies) or SPATIALLY_REDUNDANT (covisibility)
+  std::string place_eviction_policy = "LEAST_MATCHED";
+
+  //! @brief the place database is rebuilt (rebalanced) from its descriptors after this number of added places (0: only on eviction)
+  Count number_of_places_per_rebuild = 0;
+
+  //! @brief closure query gating: NONE (global query) or SPATIAL (only places within the pose uncertainty radius of the query)
+  std::string closure_query_gating = "NONE";
+
+  //! @brief spatial gating: uncertainty radius at zero traveled distance between reference and query
+  real gating_minimum_radius_meters = 10;
+
+  //! @brief spatial gating: growth of the uncertainty radius per meter traveled between reference and query (odometry drift)
+  real gating_drift_ratio = 0.1;
+
+  //! @brief query the place database with the current frame while the track is lost, resuming the existing track on success
+  bool enable_frame_relocalization = false;
+
+  //! @brief frame relocalization: maximum number of best matching places registered per frame (bounds the cost per lost frame)
+  Count maximum_number_of_frame_relocalization_candidates = 3;
+
   //! @brief parameters of aligner unit
   AlignerParameters* aligner;
 };
@@ -371,6 +488,38 @@ public:
 
   //! @brief enable robust kernel for landmark measurements
   bool enable_robust_kernel_for_landmarks = false;
+
+  //! @brief pose graph only: keep the graph alive across optimizations, adding only new vertices and edges (warm started, the g2o structure is rebuilt)
+  bool enable_incremental_optimization = false;
+
+  //! @brief incremental optimization: iterations stop once the relative chi2 gain drops below this threshold
+  real minimum_relative_gain_for_termination = 1e-5;
+
+  //! @brief pose graph only: optimize in a dedicated thread, the result is applied to the map at the next frame after completion
+  bool enable_asynchronous_optimization = false;
+
+  //! @brief local bundle adjustment of the most recent local maps and their landmarks at each local map creation
+  bool enable_local_bundle_adjustment = false;
+
+  //! @brief local bundle adjustment: number of most recent local maps adjusted (local maps outside observing their landmarks are fixed)
+  Count number_of_local_maps_for_local_bundle_adjustment = 5;
+
+  //! @brief local bundle adjustment: fixed number of iterations per call
+  Count number_of_iterations_for_local_bundle_adjustment = 5;
+
+  //! @brief local bundle adjustment: maximum number of fixed local maps outside of the window (the ones sharing most landmarks are kept)
+  Count maximum_number_of_fixed_local_maps_for_local_bundle_adjustment = 10;
+
+  //! @brief pose graph only: solver backend: NATIVE (specialized SE(3) pose graph solver), G2O (optimization_algorithm and linear_solver_type)
+  std::string pose_graph_solver = "G2O";
+
+  //! @brief pose graph only: optimize the local map keyframes only, the other frames are moved rigidly with their keyframe
+  bool enable_keyframe_pose_graph = false;
+
+  //! @brief local maps (their frames and landmarks) are moved after an optimization only if their keyframe was corrected by more than
+  //! one of these (translation in meters, rotation in radians), measured against the last applied pose (skipped corrections accumulate)
+  real minimum_keyframe_translation_correction_for_update = 1e-3;
+  real minimum_keyframe_rotation_correction_for_update    = 1e-4;
 };
 
 //! @class image viewer parameters
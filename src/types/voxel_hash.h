@@ -0,0 +1,330 @@
+#pragma once
+#include "flat_containers.h"
+
+namespace proslam {
+
+//! @class incrementally maintained spatial hash of objects with world coordinates (e.g. landmarks), bucketed in cubic voxels
+//! the object type must provide identifier() and coordinates(), objects have to be updated after their coordinates changed
+template<typename ObjectType_>
+class VoxelHash {
+
+//ds exported types
+public:
+
+  typedef std::vector<ObjectType_*> ObjectPointerVector;
+
+  //ds voxel grid coordinates
+  typedef Eigen::Matrix<int64_t, 3, 1> VoxelCoordinates;
+
+//ds object handling
+public:
+
+  VoxelHash(const real& voxel_size_meters_ = 1) {setVoxelSize(voxel_size_meters_);}
+
+//ds functionality
+public:
+
+  //! @brief sets the voxel size, rebucketing all contained objects
+  //! @param[in] voxel_size_meters_ voxel edge length
+  void setVoxelSize(const real& voxel_size_meters_) {
+    if (voxel_size_meters_ <= 0) {
+      throw std::runtime_error("VoxelHash::setVoxelSize|invalid voxel size: " + std::to_string(voxel_size_meters_));
+    }
+    ObjectPointerVector objects;
+    for (const Voxel& voxel: _voxels) {
+      objects.insert(objects.end(), voxel.objects.begin(), voxel.objects.end());
+    }
+    clear();
+    _voxel_size_meters          = voxel_size_meters_;
+    _inverse_voxel_size_meters  = 1/voxel_size_meters_;
+    _half_voxel_diagonal_meters = std::sqrt(3)*voxel_size_meters_/2;
+    for (ObjectType_* object: objects) {
+      insert(object);
+    }
+  }
+
+  //! @brief adds an object at its current coordinates
+  //! @param[in] object_ object not yet contained in the hash
+  void insert(ObjectType_* object_) {
+    const Identifier key = _getKey(object_->coordinates());
+    if (!_object_keys.insert(object_->identifier(), key).second) {
+      return;
+    }
+    _getVoxel(key, object_->coordinates()).objects.push_back(object_);
+  }
+
+  //! @brief removes an object
+  //! @param[in] object_ object to remove
+  void remove(const ObjectType_* object_) {
+    const Identifier* key = _object_keys.find(object_->identifier());
+    if (key) {
+      _removeFromVoxel(object_, *key);
+      _object_keys.erase(object_->identifier());
+    }
+  }
+
+  //! @brief moves an object to the voxel of its current coordinates (the object is added if not yet contained)
+  //! @param[in] object_ object with possibly changed coordinates
+  void update(ObjectType_* object_) {
+    const Identifier key_new = _getKey(object_->coordinates());
+    const std::pair<Identifier*, bool> entry = _object_keys.insert(object_->identifier(), key_new);
+    if (!entry.second) {
+
+      //ds nothing to do if the object remains in its voxel
+      if (*entry.first == key_new) {
+        return;
+      }
+      _removeFromVoxel(object_, *entry.first);
+      *entry.first = key_new;
+    }
+    _getVoxel(key_new, object_->coordinates()).objects.push_back(object_);
+  }
+
+  //! @brief removes all objects
+  void clear() {
+    _voxels.clear();
+    _free_voxels.clear();
+    _voxel_slots.clear();
+    _object_keys.clear();
+  }
+
+  //! @brief retrieves all objects within a sphere
+  //! @param[in] center_ sphere center in world coordinates
+  //! @param[in] radius_meters_ sphere radius
+  //! @param[out] objects_ objects with coordinates inside the sphere
+  void getObjectsInRadius(const PointCoordinates& center_, const real& radius_meters_, ObjectPointerVector& objects_) const {
+    objects_.clear();
+    const real radius_squared = radius_meters_*radius_meters_;
+    const real radius_voxel_squared = std::pow(radius_meters_+_half_voxel_diagonal_meters, 2);
+    _forEachCandidate(center_-PointCoordinates::Constant(radius_meters_),
+                      center_+PointCoordinates::Constant(radius_meters_),
+                      [&](const PointCoordinates& voxel_center_) {
+      return (voxel_center_-center_).squaredNorm() <= radius_voxel_squared;
+    },
+                      [&](ObjectType_* object_) {
+      if ((object_->coordinates()-center_).squaredNorm() <= radius_squared) {
+        objects_.push_back(object_);
+      }
+    });
+  }
+
+  //! @brief retrieves all objects within a pinhole camera frustum
+  //! @param[in] world_to_camera_ camera pose
+  //! @param[in] camera_matrix_ pinhole camera matrix
+  //! @param[in] number_of_image_rows_ image height in pixels
+  //! @param[in] number_of_image_cols_ image width in pixels
+  //! @param[in] minimum_depth_meters_ near plane
+  //! @param[in] maximum_depth_meters_ far plane
+  //! @param[out] objects_ objects projecting into the image within the depth range
+  void getObjectsInFrustum(const TransformMatrix3D& world_to_camera_,
+                           const CameraMatrix& camera_matrix_,
+                           const Count& number_of_image_rows_,
+                           const Count& number_of_image_cols_,
+                           const real& minimum_depth_meters_,
+                           const real& maximum_depth_meters_,
+                           ObjectPointerVector& objects_) const {
+    objects_.clear();
+    const TransformMatrix3D camera_to_world(world_to_camera_.inverse());
+    const CameraMatrix inverse_camera_matrix(camera_matrix_.inverse());
+
+    //ds bounding box of the frustum corners in world coordinates
+    PointCoordinates minimum(PointCoordinates::Constant(std::numeric_limits<real>::max()));
+    PointCoordinates maximum(PointCoordinates::Constant(-std::numeric_limits<real>::max()));
+    for (const real& depth: {minimum_depth_meters_, maximum_depth_meters_}) {
+      for (const real& u: {static_cast<real>(0), static_cast<real>(number_of_image_cols_)}) {
+        for (const real& v: {static_cast<real>(0), static_cast<real>(number_of_image_rows_)}) {
+          const PointCoordinates corner = camera_to_world*(depth*inverse_camera_matrix*PointCoordinates(u, v, 1));
+          minimum = minimum.cwiseMin(corner);
+          maximum = maximum.cwiseMax(corner);
+        }
+      }
+    }
+
+    //ds frustum planes in world coordinates (inside for non-negative signed distance): left, right, top, bottom, near, far
+    const real& f_u = camera_matrix_(0, 0);
+    const real& f_v = camera_matrix_(1, 1);
+    const real& c_u = camera_matrix_(0, 2);
+    const real& c_v = camera_matrix_(1, 2);
+    std::vector<Vector3> normals = {Vector3(f_u, 0, c_u),
+                                    Vector3(-f_u, 0, number_of_image_cols_-c_u),
+                                    Vector3(0, f_v, c_v),
+                                    Vector3(0, -f_v, number_of_image_rows_-c_v),
+                                    Vector3(0, 0, 1),
+                                    Vector3(0, 0, -1)};
+    std::vector<real> offsets = {0, 0, 0, 0, -minimum_depth_meters_, maximum_depth_meters_};
+    for (Index index = 0; index < normals.size(); ++index) {
+      const Vector3 normal_in_camera = normals[index].normalized();
+      normals[index]  = world_to_camera_.linear().transpose()*normal_in_camera;
+      offsets[index] += normal_in_camera.dot(world_to_camera_.translation());
+    }
+
+    //ds coarse check of voxels against the frustum planes, precise check of objects by projection
+    _forEachCandidate(minimum, maximum, [&](const PointCoordinates& voxel_center_) {
+      for (Index index = 0; index < normals.size(); ++index) {
+        if (normals[index].dot(voxel_center_)+offsets[index] < -_half_voxel_diagonal_meters) {
+          return false;
+        }
+      }
+      return true;
+    },
+                      [&](ObjectType_* object_) {
+      const PointCoordinates point_in_camera = world_to_camera_*object_->coordinates();
+      if (point_in_camera.z() < minimum_depth_meters_ || point_in_camera.z() > maximum_depth_meters_) {
+        return;
+      }
+      const PointCoordinates point_in_image = camera_matrix_*point_in_camera/point_in_camera.z();
+      if (point_in_image.x() >= 0 && point_in_image.x() <= number_of_image_cols_ &&
+          point_in_image.y() >= 0 && point_in_image.y() <= number_of_image_rows_) {
+        objects_.push_back(object_);
+      }
+    });
+  }
+
+//ds getters/setters
+public:
+
+  inline const real& voxelSizeMeters() const {return _voxel_size_meters;}
+  inline Count size() const {return _object_keys.size();}
+  inline Count numberOfVoxels() const {return _voxel_slots.size();}
+
+//ds helpers
+protected:
+
+  //ds voxel with contained objects
+  struct Voxel {
+    Identifier key = 0;
+    VoxelCoordinates coordinates = VoxelCoordinates::Zero();
+    ObjectPointerVector objects;
+  };
+
+  //ds voxel coordinates are packed into 21 bits per dimension (the resulting key never equals the hash map free key)
+  static constexpr int64_t _offset = int64_t(1) << 20;
+  static constexpr Identifier _mask = (Identifier(1) << 21)-1;
+
+  inline VoxelCoordinates _getVoxelCoordinates(const PointCoordinates& coordinates_) const {
+    return VoxelCoordinates(static_cast<int64_t>(std::floor(coordinates_.x()*_inverse_voxel_size_meters)),
+                            static_cast<int64_t>(std::floor(coordinates_.y()*_inverse_voxel_size_meters)),
+                            static_cast<int64_t>(std::floor(coordinates_.z()*_inverse_voxel_size_meters)));
+  }
+
+  inline static Identifier _getKey(const VoxelCoordinates& voxel_) {
+    return ((static_cast<Identifier>(voxel_.x()+_offset)&_mask) << 42) |
+           ((static_cast<Identifier>(voxel_.y()+_offset)&_mask) << 21) |
+            (static_cast<Identifier>(voxel_.z()+_offset)&_mask);
+  }
+
+  inline Identifier _getKey(const PointCoordinates& coordinates_) const {return _getKey(_getVoxelCoordinates(coordinates_));}
+
+  //ds retrieves the voxel for a key, allocating it if not existing
+  Voxel& _getVoxel(const Identifier& key_, const PointCoordinates& coordinates_) {
+    Index slot = _voxels.size();
+    if (!_free_voxels.empty()) {
+      slot = _free_voxels.back();
+    }
+    const std::pair<Index*, bool> entry = _voxel_slots.insert(key_, slot);
+    if (entry.second) {
+      if (slot == _voxels.size()) {
+        _voxels.push_back(Voxel());
+      } else {
+        _free_voxels.pop_back();
+      }
+      _voxels[slot].key         = key_;
+      _voxels[slot].coordinates = _getVoxelCoordinates(coordinates_);
+    }
+    return _voxels[*entry.first];
+  }
+
+  //ds removes an object from its voxel, releasing the voxel if empty
+  void _removeFromVoxel(const ObjectType_* object_, const Identifier& key_) {
+    const Index* slot = _voxel_slots.find(key_);
+    if (!slot) {
+      return;
+    }
+    const Index slot_voxel = *slot;
+    ObjectPointerVector& objects = _voxels[slot_voxel].objects;
+    for (Index index = 0; index < objects.size(); ++index) {
+      if (objects[index] == object_) {
+        objects[index] = objects.back();
+        objects.pop_back();
+        break;
+      }
+    }
+    if (objects.empty()) {
+      _voxel_slots.erase(key_);
+      _free_voxels.push_back(slot_voxel);
+    }
+  }
+
+  inline PointCoordinates _getVoxelCenter(const VoxelCoordinates& voxel_) const {
+    return (voxel_.cast<real>()+PointCoordinates::Constant(0.5))*_voxel_size_meters;
+  }
+
+  //ds calls function_ for every object in the voxels overlapping the axis aligned box, for which voxel_filter_ holds (evaluated on the voxel center)
+  template<typename VoxelFilterType_, typename FunctionType_>
+  void _forEachCandidate(const PointCoordinates& minimum_,
+                         const PointCoordinates& maximum_,
+                         const VoxelFilterType_& voxel_filter_,
+                         const FunctionType_& function_) const {
+    const VoxelCoordinates voxel_minimum = _getVoxelCoordinates(minimum_);
+    const VoxelCoordinates voxel_maximum = _getVoxelCoordinates(maximum_);
+    const VoxelCoordinates extent        = voxel_maximum-voxel_minimum+VoxelCoordinates::Ones();
+
+    //ds if the box covers more voxels than are occupied, scanning the occupied voxels is cheaper
+    const real number_of_voxels_in_box = static_cast<real>(extent.x())*extent.y()*extent.z();
+    if (number_of_voxels_in_box > _voxel_slots.size()) {
+      for (const typename IdentifierHashMap<Index>::Slot& slot: _voxel_slots.slots()) {
+        if (slot.key == IdentifierHashMap<Index>::free_key) {
+          continue;
+        }
+        const Voxel& voxel = _voxels[slot.value];
+        if ((voxel.coordinates.array() >= voxel_minimum.array()).all() &&
+            (voxel.coordinates.array() <= voxel_maximum.array()).all() &&
+            voxel_filter_(_getVoxelCenter(voxel.coordinates))) {
+          for (ObjectType_* object: voxel.objects) {
+            function_(object);
+          }
+        }
+      }
+      return;
+    }
+
+    //ds visit the voxels in the box
+    for (int64_t x = voxel_minimum.x(); x <= voxel_maximum.x(); ++x) {
+      for (int64_t y = voxel_minimum.y(); y <= voxel_maximum.y(); ++y) {
+        for (int64_t z = voxel_minimum.z(); z <= voxel_maximum.z(); ++z) {
+          const VoxelCoordinates voxel(x, y, z);
+          if (!voxel_filter_(_getVoxelCenter(voxel))) {
+            continue;
+          }
+          const Index* slot = _voxel_slots.find(_getKey(voxel));
+          if (slot) {
+            for (ObjectType_* object: _voxels[*slot].objects) {
+              function_(object);
+            }
+          }
+        }
+      }
+    }
+  }
+
+//ds attributes
+protected:
+
+  real _voxel_size_meters          = 1;
+  real _inverse_voxel_size_meters  = 1;
+  real _half_voxel_diagonal_meters = 0.5*std::sqrt(3);
+
+  //ds voxel storage, voxel key to voxel slot and released slots for reuse
+  std::vector<Voxel> _voxels;
+  IdentifierHashMap<Index> _voxel_slots;
+  std::vector<Index> _free_voxels;
+
+  //ds object identifier to key of the containing voxel
+  IdentifierHashMap<Identifier> _object_keys;
+};
+
+template<typename ObjectType_>
+constexpr int64_t VoxelHash<ObjectType_>::_offset;
+template<typename ObjectType_>
+constexpr Identifier VoxelHash<ObjectType_>::_mask;
+}
@@ -8,6 +8,7 @@ using namespace srrg_core;
 
 WorldMap::WorldMap(const WorldMapParameters* parameters_): _parameters(parameters_) {
   LOG_INFO(std::cerr << "WorldMap::WorldMap|constructing" << std::endl)
+  _landmark_voxel_hash.setVoxelSize(_parameters->landmark_voxel_size_meters);
   clear();
   LOG_INFO(std::cerr << "WorldMap::WorldMap|constructed" << std::endl)
 }
@@ -21,16 +22,16 @@ WorldMap::~WorldMap() {
 //ds clears all internal structures
 void WorldMap::clear() {
 
-  //ds free landmarks
-  LOG_INFO(std::cerr << "WorldMap::clear|deleting landmarks: " << _landmarks.size() << std::endl)
-  for(LandmarkPointerMap::iterator it = _landmarks.begin(); it != _landmarks.end(); ++it) {
-    delete it->second;
+  //ds free all frames (before the landmarks, which are notified about freed framepoints)
+  LOG_INFO(std::cerr << "WorldMap::clear|deleting frames: " << _frames.size() << std::endl)
+  for (const FramePointerMapElement& frame: _frames) {
+    delete frame.second;
   }
 
-  //ds free all frames
-  LOG_INFO(std::cerr << "WorldMap::clear|deleting frames: " << _frames.size() << std::endl)
-  for(FramePointerMap::iterator it = _frames.begin(); it != _frames.end(); ++it) {
-    delete it->second;
+  //ds free landmarks
+  LOG_INFO(std::cerr << "WorldMap::clear|deleting landmarks: " << _landmarks.size() << std::endl)
+  for (const LandmarkPointerMapElement& landmark: _landmarks) {
+    delete landmark.second;
   }
 
   //ds free all local maps
@@ -45,6 +46,10 @@ void WorldMap::clear() {
   _frames.clear();
   _local_maps.clear();
   _currently_tracked_landmarks.clear();
+  _previously_tracked_landmark_identifiers.clear();
+  _landmarks_to_evaluate.clear();
+  _landmarks_invisible.clear();
+  _landmark_voxel_hash.clear();
 }
 
 Frame* WorldMap::createFrame(const TransformMatrix3D& robot_to_world_,
@@ -75,6 +80,7 @@ Frame* WorldMap::createFrame(const TransformMatrix3D& robot_to_world_,
 Landmark* WorldMap::createLandmark(FramePoint* origin_) {
   Landmark* landmark = new Landmark(origin_, _parameters->landmark);
   _landmarks.insert(std::make_pair(landmark->identifier(), landmark));
+  _landmark_voxel_hash.insert(landmark);
   return landmark;
 }
 
@@ -83,8 +89,9 @@ const bool WorldMap::createLocalMap(const bool& drop_framepoints_) {
     return false;
   }
 
-  //ds reset closure status
+  //ds reset closure and folding status
   _relocalized = false;
+  _folded      = false;
 
   //ds update distance traveled and last pose
   const TransformMatrix3D robot_pose_last_to_current = _previous_frame->worldToRobot()*_current_frame->robotToWorld();
@@ -97,12 +104,29 @@ const bool WorldMap::createLocalMap(const bool& drop_framepoints_) {
       _frame_queue_for_local_map.size() > _parameters->minimum_number_of_frames_for_local_map)                          ||
      (_frame_queue_for_local_map.size() > _parameters->minimum_number_of_frames_for_local_map && _local_maps.size() < 5)) {
 
+    //ds if the window is redundant with an existing local map - fold it into the existing one instead of growing the map
+    LocalMap* local_map_covering = _getCoveringLocalMap();
+    if (local_map_covering) {
+      LOG_DEBUG(std::cerr << "WorldMap::createLocalMap|folding frames: " << _frame_queue_for_local_map.size()
+                          << " into local map: " << local_map_covering->identifier() << std::endl)
+      local_map_covering->absorb(_frame_queue_for_local_map);
+      ++_number_of_folded_local_maps;
+
+      //ds the robot continues in the covering local map (subsequent local maps succeed it)
+      _current_local_map             = local_map_covering;
+      _is_current_local_map_covering = true;
+      _folded                        = true;
+      resetWindowForLocalMapCreation(drop_framepoints_);
+      return false;
+    }
+
     //ds create the new keyframe and add it to the keyframe database
     _current_local_map = new LocalMap(_frame_queue_for_local_map,
                                       _parameters->local_map,
                                       _root_local_map,
                                       _current_local_map);
     _local_maps.push_back(_current_local_map);
+    _is_current_local_map_covering = false;
     assert(_current_frame->isKeyframe());
     assert(_current_frame->localMap() == _current_local_map);
 
@@ -152,12 +176,14 @@ void WorldMap::addLoopClosure(LocalMap* query_,
                               const Closure::CorrespondencePointerVector& landmark_correspondences_,
                               const real& information_) {
 
-  //ds check if we relocalized after a lost track
-  if (_frames.at(0)->root() != _current_frame->root()) {
-    assert(_current_frame->localMap() == query_);
+  //ds check if we relocalized after a lost track (in the current track segment)
+  if (_frames.at(0)->root() != _current_frame->root() && query_->keyframe()->root() == _current_frame->root()) {
 
-    //ds rudely link the current frame into the list (proper map merging will be coming soon!)
-    setTrack(_current_frame);
+    //ds rudely link the query keyframe into the list (proper map merging will be coming soon!)
+    setTrack(query_->keyframe());
+
+    //ds if closures are integrated asynchronously, the current frame already succeeds the query keyframe
+    _current_frame->setRoot(_root_frame);
   }
 
   //ds add loop closure information to the world map
@@ -289,20 +315,74 @@ void WorldMap::setTrack(Frame* frame_) {
   _last_local_map_before_track_break = 0;
 }
 
+void WorldMap::relocalizeTrack(const TransformMatrix3D& robot_to_world_) {
+  assert(isTrackLost());
+  const Frame* root_segment = _root_frame;
+  LOG_INFO(std::printf("WorldMap::relocalizeTrack|RELOCALIZED - resuming track of [Frame] < [LocalMap]: [%06lu] < [%06lu] at [%06lu]\n",
+              _last_frame_before_track_break->identifier(), _last_local_map_before_track_break->identifier(), _current_frame->identifier()))
+
+  //ds rigid correction of the current track segment (which has been tracked in an arbitrary frame since the break)
+  const TransformMatrix3D correction = robot_to_world_*_current_frame->worldToRobot();
+
+  //ds collect the landmarks created in the current track segment (before the frames are moved to the original root)
+  LandmarkPointerVector landmarks_segment;
+  for (Frame* frame = _current_frame; frame; frame = frame->previous()) {
+    for (FramePoint* framepoint: frame->points()) {
+      Landmark* landmark = framepoint->landmark();
+      if (landmark && landmark->origin() &&
+          (landmark->origin()->frame() == root_segment || landmark->origin()->frame()->root() == root_segment)) {
+        landmarks_segment.push_back(landmark);
+      }
+    }
+    if (frame == root_segment) {
+      break;
+    }
+  }
+  std::sort(landmarks_segment.begin(), landmarks_segment.end());
+  landmarks_segment.erase(std::unique(landmarks_segment.begin(), landmarks_segment.end()), landmarks_segment.end());
+  for (Landmark* landmark: landmarks_segment) {
+    landmark->transform(correction);
+    _landmark_voxel_hash.update(landmark);
+  }
+
+  //ds move the frames of the segment and return to the original root
+  _root_frame = _last_frame_before_track_break->root();
+  for (Frame* frame = _current_frame; frame; frame = frame->previous()) {
+    frame->setRobotToWorld(correction*frame->robotToWorld());
+    frame->setRoot(_root_frame);
+    if (frame == root_segment) {
+      break;
+    }
+  }
+  _root_local_map = _last_local_map_before_track_break->root();
+  setRobotToWorld(_current_frame->robotToWorld());
+
+  //ds the frame chain has never been cut, local maps created from here on continue the previous local map chain
+  _last_frame_before_track_break     = nullptr;
+  _last_local_map_before_track_break = nullptr;
+  ++_number_of_relocalized_tracks;
+}
+
 void WorldMap::mergeLandmarks(const LocalMap::ClosureConstraintVector& closures_) {
   CHRONOMETER_START(landmark_merging)
 
+  //ds size the filter tables for the total number of correspondences
+  Count number_of_correspondences = 0;
+  for (const LocalMap::ClosureConstraint& closure: closures_) {
+    number_of_correspondences += closure.landmark_correspondences.size();
+  }
+
   //ds keep track of the best merged references
   //ds we need to do this since we're processing multiple closures here,
   //ds which possibly contain different query-reference correspondences
-  std::map<Identifier, std::pair<Identifier, Count>> landmark_queries_to_references_filtered;
-  std::map<Identifier, std::pair<Identifier, Count>> landmark_references_to_queries_filtered;
+  IdentifierHashMap<std::pair<Identifier, Count>> landmark_queries_to_references_filtered(number_of_correspondences);
+  IdentifierHashMap<std::pair<Identifier, Count>> landmark_references_to_queries_filtered(number_of_correspondences);
 
   //ds determine landmark merge configuration
   for (const LocalMap::ClosureConstraint& closure: closures_) {
     for (const Closure::Correspondence* correspondence: closure.landmark_correspondences) {
-      Identifier identifier_query     = correspondence->query->identifier();
-      Identifier identifier_reference = correspondence->reference->identifier();
+      Identifier identifier_query     = correspondence->identifier_query;
+      Identifier identifier_reference = correspondence->identifier_reference;
 
       //ds query is always greater than reference (merging into old landmarks)
       if (identifier_query < identifier_reference) {
@@ -314,121 +394,109 @@ void WorldMap::mergeLandmarks(const LocalMap::ClosureConstraintVector& closures_
 
         //ds potential correspondance candidates
         const Count& matching_count = correspondence->matching_count;
-        std::pair<Identifier, Count> candidate_query(identifier_query, matching_count);
-        std::pair<Identifier, Count> candidate_reference(identifier_reference, matching_count);
+        const std::pair<Identifier, Count> candidate_query(identifier_query, matching_count);
+        const std::pair<Identifier, Count> candidate_reference(identifier_reference, matching_count);
 
         //ds evaluate current situation for the proposed query-reference pair
-        std::map<Identifier, std::pair<Identifier, Count>>::iterator iterator_query     = landmark_queries_to_references_filtered.find(identifier_query);
-        std::map<Identifier, std::pair<Identifier, Count>>::iterator iterator_reference = landmark_references_to_queries_filtered.find(identifier_reference);
+        std::pair<Identifier, Count>* entry_query     = landmark_queries_to_references_filtered.find(identifier_query);
+        std::pair<Identifier, Count>* entry_reference = landmark_references_to_queries_filtered.find(identifier_reference);
 
         //ds if there is not entry for the query nor the reference
-        if (iterator_query == landmark_queries_to_references_filtered.end() &&
-            iterator_reference == landmark_references_to_queries_filtered.end()) {
+        if (!entry_query && !entry_reference) {
 
           //ds we add new entries
-          landmark_queries_to_references_filtered.insert(std::make_pair(identifier_query, candidate_reference));
-          landmark_references_to_queries_filtered.insert(std::make_pair(identifier_reference, candidate_query));
+          landmark_queries_to_references_filtered.insert(identifier_query, candidate_reference);
+          landmark_references_to_queries_filtered.insert(identifier_reference, candidate_query);
         }
 
         //ds if we have a new reference for an already added query
-        else if (iterator_query != landmark_queries_to_references_filtered.end() &&
-                 iterator_reference == landmark_references_to_queries_filtered.end()) {
+        else if (entry_query && !entry_reference) {
 
           //ds check if the reference is better than the added one
-          if (matching_count > iterator_query->second.second) {
+          if (matching_count > entry_query->second) {
 
             //ds remove previous entry
-            landmark_references_to_queries_filtered.erase(iterator_query->second.first);
+            landmark_references_to_queries_filtered.erase(entry_query->first);
 
             //ds update entries
-            iterator_query->second = candidate_query;
-            landmark_references_to_queries_filtered.insert(std::make_pair(identifier_reference, candidate_query));
+            *entry_query = candidate_reference;
+            landmark_references_to_queries_filtered.insert(identifier_reference, candidate_query);
           }
         }
 
         //ds if we have a new query for and already added reference
-        else if (iterator_query == landmark_queries_to_references_filtered.end() &&
-                 iterator_reference != landmark_references_to_queries_filtered.end()) {
+        else if (!entry_query && entry_reference) {
 
           //ds check if the query is better than the added one
-          if (matching_count > iterator_reference->second.second) {
+          if (matching_count > entry_reference->second) {
 
             //ds remove previous entry
-            landmark_queries_to_references_filtered.erase(iterator_reference->second.first);
+            landmark_queries_to_references_filtered.erase(entry_reference->first);
 
             //ds update entries
-            iterator_reference->second = candidate_reference;
-            landmark_queries_to_references_filtered.insert(std::make_pair(identifier_query, candidate_reference));
+            *entry_reference = candidate_query;
+            landmark_queries_to_references_filtered.insert(identifier_query, candidate_reference);
           }
         }
       }
     }
   }
 
-  //ds map of merged landmark identfiers in case of multi-merges
-  std::map<Identifier, Identifier> merged_landmark_identifiers;
+  //ds collect the filtered merges: <query, reference>, processed in increasing query order
+  std::vector<std::pair<Identifier, Identifier>> merges;
+  merges.reserve(landmark_queries_to_references_filtered.size());
+  for (const IdentifierHashMap<std::pair<Identifier, Count>>::Slot& slot: landmark_queries_to_references_filtered.slots()) {
+    if (slot.key != IdentifierHashMap<std::pair<Identifier, Count>>::free_key) {
+      merges.push_back(std::make_pair(slot.key, slot.value.first));
+    }
+  }
+  std::sort(merges.begin(), merges.end());
+
+  //ds snapshot the identifiers of the currently tracked landmarks (absorbed landmarks are freed during merging)
+  std::vector<Identifier> tracked_identifiers(_currently_tracked_landmarks.size());
+  for (Index index = 0; index < _currently_tracked_landmarks.size(); ++index) {
+    tracked_identifiers[index] = _currently_tracked_landmarks[index]->identifier();
+  }
+
+  //ds merge chains of this call: absorbed landmark identifier to absorbing landmark identifier
+  //ds tracked landmarks are routed below, local maps and HBST appearances upon merging - no reference to an absorbed landmark survives the call
+  IdentifierHashMap<Identifier> merged_landmark_identifiers(merges.size());
 
   //ds for each entry: <query, reference>
-  for (const std::pair<Identifier, std::pair<Identifier, Count>>& pair: landmark_queries_to_references_filtered) {
-    Landmark* landmark_query     = nullptr;
-    Landmark* landmark_reference = nullptr;
+  Count number_of_merged_landmarks = 0;
+  for (const std::pair<Identifier, Identifier>& merge: merges) {
 
-    //ds try to retrieve landmarks from map, ignoring queries that have been merged already
-    try {
-      landmark_query = _landmarks.at(pair.first);
-    } catch (const std::out_of_range& /*ex*/) {
+    //ds retrieve landmarks from map, ignoring queries that have been merged already (tombstone)
+    Landmark* landmark_query = _landmarks.get(merge.first);
+    if (!landmark_query) {
 
       //ds this means the query has already been merged, we skip further processing
-      LOG_WARNING(std::cerr << "WorldMap::mergeLandmarks|already merged landmark ID: " << landmark_query->identifier() << std::endl)
+      LOG_WARNING(std::cerr << "WorldMap::mergeLandmarks|already merged landmark ID: " << merge.first << std::endl)
       continue;
     }
 
-    //ds check for reference landmark, route to absorbing one if the reference has been a query earlier
-    try {
-      landmark_reference = _landmarks.at(pair.second.first);
-    } catch (const std::out_of_range& /*ex*/) {
-      landmark_reference = _landmarks.at(merged_landmark_identifiers.at(pair.second.first));
-    }
+    //ds check for reference landmark, route to absorbing one if the reference has been merged earlier
+    Landmark* landmark_reference = _landmarks.get(_getAbsorbingLandmarkIdentifier(merge.second, merged_landmark_identifiers));
 
     //ds skip processing for identical calls
-    if (landmark_query->identifier() == landmark_reference->identifier()) {
+    if (!landmark_reference || landmark_query == landmark_reference) {
       continue;
     }
 
     //ds if the landmarks share a local map, we cannot merge them (this has to be done within the local map)
     //ds TODO perform merge and handle colliding framepoints
-    bool shared_local_map = false;
-    for (const LocalMap* local_map_query: landmark_query->_local_maps) {
-      for (const LocalMap* local_map_reference: landmark_reference->_local_maps) {
-        if (local_map_query == local_map_reference) {
-          shared_local_map = true;
-          break;
-        }
-      }
-      if (shared_local_map) {
-        break;
-      }
-    }
-
-    //ds skip merging
-    if (shared_local_map) {
+    if (_haveSharedLocalMap(landmark_query, landmark_reference)) {
       continue;
     }
 
-    //ds check if the landmark is in the currently tracked ones and update it accordingly
-    for (Index index = 0; index < _currently_tracked_landmarks.size(); ++index) {
-      const Identifier& tracked_identifier = _currently_tracked_landmarks[index]->identifier();
-      if (tracked_identifier == landmark_query->identifier()    ||
-          tracked_identifier == landmark_reference->identifier()) {
-        _currently_tracked_landmarks[index] = landmark_reference;
-      }
-    }
-
     //ds perform merge (does not free landmark memory)
     landmark_reference->merge(landmark_query);
+    _landmark_voxel_hash.remove(landmark_query);
+    _landmark_voxel_hash.update(landmark_reference);
 
     //ds update bookkeeping and free absorbed landmark
-    merged_landmark_identifiers.insert(std::make_pair(landmark_query->identifier(), landmark_reference->identifier()));
+    merged_landmark_identifiers.insert(landmark_query->identifier(), landmark_reference->identifier());
+    ++number_of_merged_landmarks;
     if (1 != _landmarks.erase(landmark_query->identifier())) {
 
       //ds do not free landmark memory
@@ -439,8 +507,242 @@ void WorldMap::mergeLandmarks(const LocalMap::ClosureConstraintVector& closures_
       delete landmark_query;
     }
   }
-  LOG_DEBUG(std::cerr << "WorldMap::mergeLandmarks|merged landmarks: " << merged_landmark_identifiers.size() << std::endl)
-  _number_of_merged_landmarks += merged_landmark_identifiers.size();
+
+  //ds route currently tracked landmarks to their absorbing landmarks
+  if (number_of_merged_landmarks > 0) {
+    for (Index index = 0; index < _currently_tracked_landmarks.size(); ++index) {
+      const Identifier identifier_absorbing = _getAbsorbingLandmarkIdentifier(tracked_identifiers[index], merged_landmark_identifiers);
+      if (identifier_absorbing != tracked_identifiers[index]) {
+        _currently_tracked_landmarks[index] = _landmarks.get(identifier_absorbing);
+      }
+    }
+  }
+  LOG_DEBUG(std::cerr << "WorldMap::mergeLandmarks|merged landmarks: " << number_of_merged_landmarks << std::endl)
+  _number_of_merged_landmarks += number_of_merged_landmarks;
   CHRONOMETER_STOP(landmark_merging)
 }
+
+Identifier WorldMap::_getAbsorbingLandmarkIdentifier(const Identifier& identifier_, IdentifierHashMap<Identifier>& merged_landmark_identifiers_) {
+
+  //ds follow the merge chain until we arrive at a landmark that has not been absorbed
+  Identifier identifier_absorbing = identifier_;
+  const Identifier* identifier_parent = merged_landmark_identifiers_.find(identifier_absorbing);
+  while (identifier_parent) {
+    identifier_absorbing = *identifier_parent;
+    identifier_parent    = merged_landmark_identifiers_.find(identifier_absorbing);
+  }
+
+  //ds compress the chain: link all visited landmarks directly to the absorbing one
+  Identifier identifier = identifier_;
+  Identifier* identifier_parent_compressed = merged_landmark_identifiers_.find(identifier);
+  while (identifier_parent_compressed && *identifier_parent_compressed != identifier_absorbing) {
+    identifier                    = *identifier_parent_compressed;
+    *identifier_parent_compressed = identifier_absorbing;
+    identifier_parent_compressed  = merged_landmark_identifiers_.find(identifier);
+  }
+  return identifier_absorbing;
+}
+
+bool WorldMap::_haveSharedLocalMap(const Landmark* landmark_a_, const Landmark* landmark_b_) const {
+
+  //ds both local map sets are sorted - linear intersection check
+  Landmark::LocalMapPointerSet::const_iterator iterator_a = landmark_a_->_local_maps.begin();
+  Landmark::LocalMapPointerSet::const_iterator iterator_b = landmark_b_->_local_maps.begin();
+  while (iterator_a != landmark_a_->_local_maps.end() && iterator_b != landmark_b_->_local_maps.end()) {
+    if (*iterator_a == *iterator_b) {
+      return true;
+    } else if (std::less<LocalMap*>()(*iterator_a, *iterator_b)) {
+      ++iterator_a;
+    } else {
+      ++iterator_b;
+    }
+  }
+  return false;
+}
+
+LocalMap* WorldMap::_getCoveringLocalMap() const {
+  if (!_parameters->enable_local_map_folding || !_current_local_map) {
+    return nullptr;
+  }
+
+  //ds count the landmarks of the current frame per containing local map (the last created local map is the natural predecessor,
+  //ds unless it absorbed the preceding windows already)
+  FlatMap<LocalMap*, Count> landmarks_per_local_map;
+  Count number_of_landmarks = 0;
+  for (const FramePoint* frame_point: _current_frame->points()) {
+    const Landmark* landmark = frame_point->landmark();
+    if (landmark) {
+      ++number_of_landmarks;
+      for (LocalMap* local_map: landmark->localMaps()) {
+        if (local_map != _current_local_map || _is_current_local_map_covering) {
+          ++landmarks_per_local_map.insert(std::make_pair(local_map, 0)).first->second;
+        }
+      }
+    }
+  }
+  if (number_of_landmarks == 0) {
+    return nullptr;
+  }
+
+  //ds select the local map with the best coverage
+  LocalMap* local_map_covering = nullptr;
+  Count number_of_covered_landmarks = 0;
+  for (const std::pair<LocalMap*, Count>& entry: landmarks_per_local_map) {
+    if (entry.second > number_of_covered_landmarks) {
+      local_map_covering          = entry.first;
+      number_of_covered_landmarks = entry.second;
+    }
+  }
+  if (static_cast<real>(number_of_covered_landmarks)/number_of_landmarks < _parameters->minimum_landmark_coverage_for_folding) {
+    return nullptr;
+  }
+
+  //ds the current frame must be close to the covering local map
+  const TransformMatrix3D current_to_local_map = local_map_covering->worldToLocalMap()*_current_frame->robotToWorld();
+  if (current_to_local_map.translation().norm() > _parameters->maximum_distance_for_folding_meters ||
+      toOrientationRodrigues(current_to_local_map.linear()).norm() > _parameters->maximum_degrees_rotated_for_folding) {
+    return nullptr;
+  }
+  return local_map_covering;
+}
+
+void WorldMap::updateLandmarkVisibility() {
+  if (!_current_frame) {
+    return;
+  }
+
+  //ds reset the tracking state of the previously tracked landmarks and set it for the current ones
+  for (const Identifier& identifier: _previously_tracked_landmark_identifiers) {
+    Landmark* landmark = _landmarks.get(identifier);
+    if (landmark) {
+      landmark->setIsCurrentlyTracked(false);
+    }
+  }
+  for (Landmark* landmark: _currently_tracked_landmarks) {
+    landmark->setIsCurrentlyTracked(true);
+
+    //ds tracked landmarks have been updated with new measurements
+    _landmark_voxel_hash.update(landmark);
+  }
+
+  //ds previously tracked landmarks that are not tracked anymore are queued for culling
+  if (_parameters->landmark->enable_culling) {
+    for (const Identifier& identifier: _previously_tracked_landmark_identifiers) {
+      Landmark* landmark = _landmarks.get(identifier);
+      if (landmark && !landmark->isCurrentlyTracked()) {
+        landmark->_identifier_frame_lost = _current_frame->identifier();
+        _landmarks_to_evaluate.push_back(std::make_pair(identifier, _current_frame->identifier()));
+      }
+    }
+  }
+
+  //ds bookkeep current landmarks for the next call
+  _previously_tracked_landmark_identifiers.resize(_currently_tracked_landmarks.size());
+  for (Index index = 0; index < _currently_tracked_landmarks.size(); ++index) {
+    _previously_tracked_landmark_identifiers[index] = _currently_tracked_landmarks[index]->identifier();
+  }
+}
+
+void WorldMap::cullLandmarks() {
+  _number_of_culled_landmarks_last_call = 0;
+  _appearances_culled_last_call.clear();
+  if (!_parameters->landmark->enable_culling || !_current_frame) {
+    return;
+  }
+  CHRONOMETER_START(landmark_culling)
+  const LandmarkParameters* parameters = _parameters->landmark;
+  const Identifier& identifier_frame   = _current_frame->identifier();
+
+  //ds evaluate the landmarks that have been invisible for a sufficient number of frames
+  while (!_landmarks_to_evaluate.empty() &&
+         _landmarks_to_evaluate.front().second+parameters->minimum_number_of_frames_invisible_for_culling <= identifier_frame) {
+    const std::pair<Identifier, Identifier> entry = _landmarks_to_evaluate.front();
+    _landmarks_to_evaluate.pop_front();
+
+    //ds skip landmarks that have been merged or tracked again in the meantime
+    Landmark* landmark = _landmarks.get(entry.first);
+    if (!landmark || landmark->isCurrentlyTracked() || landmark->_identifier_frame_lost != entry.second) {
+      continue;
+    }
+
+    //ds cull landmarks with insufficient support or inconsistent measurements
+    if (landmark->numberOfUpdates() < parameters->minimum_number_of_updates_for_survival ||
+        landmark->averageRelativeResidual() > parameters->maximum_relative_residual_for_survival) {
+      _cullLandmark(landmark);
+    } else if (parameters->maximum_number_of_frames_invisible > 0) {
+
+      //ds keep observing the landmark for long invisibility
+      _landmarks_invisible.push_back(entry);
+    }
+  }
+
+  //ds cull landmarks that have not been seen for a long time
+  while (!_landmarks_invisible.empty() &&
+         _landmarks_invisible.front().second+parameters->maximum_number_of_frames_invisible <= identifier_frame) {
+    const std::pair<Identifier, Identifier> entry = _landmarks_invisible.front();
+    _landmarks_invisible.pop_front();
+    Landmark* landmark = _landmarks.get(entry.first);
+    if (landmark && !landmark->isCurrentlyTracked() && landmark->_identifier_frame_lost == entry.second) {
+      _cullLandmark(landmark);
+    }
+  }
+  LOG_DEBUG(std::cerr << "WorldMap::cullLandmarks|frame: " << identifier_frame
+                      << " culled landmarks: " << _number_of_culled_landmarks_last_call << std::endl)
+  CHRONOMETER_STOP(landmark_culling)
+}
+
+void WorldMap::_cullLandmark(Landmark* landmark_) {
+
+  //ds detach from local maps
+  for (LocalMap* local_map: landmark_->_local_maps) {
+    local_map->remove(landmark_);
+  }
+
+  //ds detach from the place database: only the entries of this landmark are cleared, a merged matchable might carry other landmarks
+  //ds the matchables remain in the database until the relocalizer frees the ones without any landmark left
+  for (HBSTMatchable* appearance: landmark_->_appearances) {
+    for (std::pair<const uint64_t, Landmark*>& object: appearance->objects) {
+      if (object.second == landmark_) {
+        object.second = nullptr;
+      }
+    }
+    _appearances_culled_last_call.push_back(appearance);
+  }
+
+  //ds detach from the framepoint history
+  for (FramePoint* framepoint = landmark_->_last_update; framepoint && framepoint->landmark() == landmark_; framepoint = framepoint->previous()) {
+    framepoint->setLandmark(nullptr);
+  }
+
+  //ds free landmark
+  _landmark_voxel_hash.remove(landmark_);
+  _landmarks.erase(landmark_->identifier());
+  delete landmark_;
+  ++_number_of_culled_landmarks;
+  ++_number_of_culled_landmarks_last_call;
+}
+
+const Count WorldMap::numberOfLandmarkAppearances() const {
+  Count number_of_appearances = 0;
+  for (const LandmarkPointerMapElement& landmark: _landmarks) {
+    number_of_appearances += landmark.second->appearances().size();
+  }
+  return number_of_appearances;
+}
+
+void WorldMap::updateLandmarkVoxelHash() {
+  CHRONOMETER_START(landmark_voxel_hash_update)
+  for (const LandmarkPointerMapElement& landmark: _landmarks) {
+    _landmark_voxel_hash.update(landmark.second);
+  }
+  CHRONOMETER_STOP(landmark_voxel_hash_update)
+}
+
+void WorldMap::updateLandmarkVoxelHash(const LandmarkPointerVector& landmarks_) {
+  CHRONOMETER_START(landmark_voxel_hash_update)
+  for (Landmark* landmark: landmarks_) {
+    _landmark_voxel_hash.update(landmark);
+  }
+  CHRONOMETER_STOP(landmark_voxel_hash_update)
+}
 }
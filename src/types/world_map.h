@@ -1,4 +1,5 @@
 #pragma once
+#include <deque>
 #include "local_map.h"
 
 namespace proslam {
@@ -30,6 +31,7 @@ public:
   Landmark* createLandmark(FramePoint* origin_);
 
   //ds attempts to create a new local map if the generation criteria are met (returns true if a local map was generated)
+  //ds a redundant window is folded into the covering local map instead, which becomes the current local map (see folded())
   const bool createLocalMap(const bool& drop_framepoints_ = false);
 
   //ds resets the window for the local map generation
@@ -96,6 +98,16 @@ public:
   //! @param[in] frame_ frame at which the track was found again
   void setTrack(Frame* frame_);
 
+  //! @brief true if the track is lost and the current track segment has no local map yet (frame relocalization is possible)
+  const bool isTrackLost() const {return _last_frame_before_track_break && _last_local_map_before_track_break && !_root_local_map;}
+
+  //! @brief true if the current track segment is not connected to the map (since a track break until it is relocalized)
+  const bool isTrackDisconnected() const {return _last_local_map_before_track_break;}
+
+  //! @brief resumes the track before the break: moves the current track segment (frames, landmarks) into the existing map frame
+  //! @param[in] robot_to_world_ the registered pose of the current frame in the existing map
+  void relocalizeTrack(const TransformMatrix3D& robot_to_world_);
+
 //ds getters/setters
 public:
 
@@ -111,6 +123,20 @@ public:
   const LandmarkPointerVector& currentlyTrackedLandmarks() const {return _currently_tracked_landmarks;}
   void mergeLandmarks(const LocalMap::ClosureConstraintVector& closures_);
 
+  //! @brief updates the tracking state of the landmarks and registers landmarks which lost track for culling (to be called once per frame)
+  void updateLandmarkVisibility();
+
+  //! @brief removes unreliable or long invisible landmarks from the map, detaching them from local maps, framepoints and the place database
+  //! must only be called when no other module holds landmark references (e.g. the graph optimizer between optimizations)
+  //! the appearances of the culled landmarks are available in appearancesCulledLastCall (to be released by the relocalizer)
+  void cullLandmarks();
+
+  //! @brief moves all landmarks to the voxels of their current coordinates (to be called after landmark coordinates changed globally, e.g. after optimization)
+  void updateLandmarkVoxelHash();
+
+  //! @brief moves the provided landmarks to the voxels of their current coordinates (to be called after a local optimization)
+  void updateLandmarkVoxelHash(const LandmarkPointerVector& landmarks_);
+
   LocalMap* currentLocalMap() {return _current_local_map;}
   const LocalMapPointerVector& localMaps() const {return _local_maps;}
 
@@ -118,8 +144,20 @@ public:
   const TransformMatrix3D robotToWorld() const {return robot_to_world;}
 
   const bool relocalized() const {return _relocalized;}
+
+  //! @brief true if the window of the last createLocalMap call was folded into the current local map (which has to be queried again)
+  const bool folded() const {return _folded;}
   const Count& numberOfClosures() const {return _number_of_closures;}
   const Count& numberOfMergedLandmarks() const {return _number_of_merged_landmarks;}
+  const Count& numberOfCulledLandmarks() const {return _number_of_culled_landmarks;}
+  const Count& numberOfFoldedLocalMaps() const {return _number_of_folded_local_maps;}
+  const Count& numberOfRelocalizedTracks() const {return _number_of_relocalized_tracks;}
+
+  //! @brief number of HBST appearances referenced by the landmarks (visits all landmarks, intended for reports)
+  const Count numberOfLandmarkAppearances() const;
+  const LandmarkVoxelHash& landmarkVoxelHash() const {return _landmark_voxel_hash;}
+  const Count& numberOfCulledLandmarksLastCall() const {return _number_of_culled_landmarks_last_call;}
+  const HBSTTree::MatchableVector& appearancesCulledLastCall() const {return _appearances_culled_last_call;}
 
   //ds visualization only
   const FramePointerMap& frames() const {return _frames;}
@@ -148,6 +186,9 @@ protected:
   //ds all permanent landmarks in the map
   LandmarkPointerMap _landmarks;
 
+  //ds spatial index over the world coordinates of all permanent landmarks
+  LandmarkVoxelHash _landmark_voxel_hash;
+
   //ds currently tracked landmarks (=visible in the current image)
   LandmarkPointerVector _currently_tracked_landmarks;
 
@@ -158,6 +199,10 @@ protected:
   TransformMatrix3D robot_to_world = TransformMatrix3D::Identity();
   bool _relocalized = false;
 
+  //ds local map folding: window folded in the last call, current local map absorbed the window (instead of preceding it)
+  bool _folded = false;
+  bool _is_current_local_map_covering = false;
+
   //ds current frame window buffer for local map generation
   real _distance_traveled_window = 0;
   real _degrees_rotated_window   = 0;
@@ -172,9 +217,42 @@ protected:
   LocalMap* _last_local_map_before_track_break = nullptr;
   LocalMap* _root_local_map                    = nullptr;
 
+  //! @brief retrieves the landmark that absorbed the given landmark (union-find with path compression)
+  //! @param[in] identifier_ identifier of a (possibly merged) landmark
+  //! @param[in,out] merged_landmark_identifiers_ merge chains: absorbed landmark identifier to absorbing landmark identifier
+  //! @return identifier of the absorbing landmark, identifier_ itself if the landmark has not been merged
+  static Identifier _getAbsorbingLandmarkIdentifier(const Identifier& identifier_, IdentifierHashMap<Identifier>& merged_landmark_identifiers_);
+
+  //! @brief checks if two landmarks are contained in a common local map
+  bool _haveSharedLocalMap(const Landmark* landmark_a_, const Landmark* landmark_b_) const;
+
+  //! @brief retrieves an existing local map that covers the current window (landmark coverage and relative pose)
+  //! @return the covering local map, nullptr if the current window is not redundant
+  LocalMap* _getCoveringLocalMap() const;
+
+  //! @brief detaches a landmark from all structures and frees it
+  //! @param[in] landmark_ the landmark to remove
+  void _cullLandmark(Landmark* landmark_);
+
+  //ds landmarks tracked in the last visibility update
+  std::vector<Identifier> _previously_tracked_landmark_identifiers;
+
+  //ds culling queues: <landmark identifier, frame identifier at track loss>, ordered by frame
+  std::deque<std::pair<Identifier, Identifier>> _landmarks_to_evaluate;
+  std::deque<std::pair<Identifier, Identifier>> _landmarks_invisible;
+
+  //ds appearances of the landmarks culled in the last call (the matchables might still carry appearances of other landmarks)
+  HBSTTree::MatchableVector _appearances_culled_last_call;
+
   //ds informative only
   CREATE_CHRONOMETER(landmark_merging)
-  Count _number_of_merged_landmarks = 0;
+  CREATE_CHRONOMETER(landmark_culling)
+  CREATE_CHRONOMETER(landmark_voxel_hash_update)
+  Count _number_of_merged_landmarks           = 0;
+  Count _number_of_culled_landmarks           = 0;
+  Count _number_of_culled_landmarks_last_call = 0;
+  Count _number_of_folded_local_maps          = 0;
+  Count _number_of_relocalized_tracks         = 0;
 
 private:
 